@@ -0,0 +1,732 @@
+/**
+ * @file CityBench.cpp
+ * @author timan
+ *
+ * Command line benchmarks for the city library.
+ *
+ * Usage: CityBench dispatch|landvalue|simulation|traffic [tiles] [agents]
+ *        CityBench coldstart [resources-directory] [city-file]
+ *        CityBench render [resources-directory] [city-file]
+ *        CityBench cull [resources-directory] [city-file...]
+ *        CityBench allocations [resources-directory] [city-file]
+ */
+
+#include "pch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "CityVisit.h"
+#include "BuildingCounter.h"
+#include "DrawList.h"
+#include "Compositor.h"
+#include "WorkerPool.h"
+#include "ReportView.h"
+#include "TextCache.h"
+#include "AllocationCounter.h"
+#include "CityOverlays.h"
+#include "DrawTimeReport.h"
+
+/// Default number of tiles in a synthetic city
+const int DefaultTiles = 1000000;
+
+/// Default number of tiles in the traffic benchmark city
+const int DefaultTrafficTiles = 500000;
+
+/// Default number of agents in the traffic benchmark
+const int DefaultAgents = 50000;
+
+/// Number of frames of traffic simulated
+const int TrafficFrames = 300;
+
+/// Time for each frame at 30 frames per second
+const double FrameTime = 1.0 / 30;
+
+/// Number of times each timed traversal is repeated
+const int Repetitions = 10;
+
+/// Width of the frame in the render benchmark
+const int RenderWidth = 3840;
+
+/// Height of the frame in the render benchmark
+const int RenderHeight = 2160;
+
+/// Number of tiles in the synthetic city the render benchmark draws
+const int RenderTiles = 8000;
+
+/// Number of tiles in the synthetic city the culling benchmark draws
+const int CullTiles = 4000;
+
+/// Frames run before allocations are counted, a minute of
+/// simulated time for the traffic route caches to fill
+const int AllocationWarmupFrames = 1800;
+
+/// Frames in which no allocations are allowed
+const int AllocationFrames = 300;
+
+/// Zoom level far enough out that tiles are drawn flat
+const int AllocationFlatZoom = 4;
+
+/// Building images used in synthetic cities
+const wchar_t *BuildingImages[] = {L"house.png", L"yellowhouse.png", L"condos.png", L"market.png",
+                                   L"firestation.png", L"hospital.png", L"blacksmith.png", L"farm0.png"};
+
+/**
+ * Fill a city with a random mix of tiles on the isometric grid.
+ *
+ * Tiles are laid out in rows so that every tile has the four
+ * neighbors City::GetAdjacent looks for.
+ * @param city City to fill
+ * @param numTiles Number of tiles to add
+ * @param seed Random number seed
+ */
+void MakeSyntheticCity(City &city, int numTiles, unsigned seed = 335)
+{
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<int> building(0, sizeof(BuildingImages) / sizeof(BuildingImages[0]) - 1);
+
+    int columns = std::max((int)sqrt((double)numTiles), 1);
+    for (int i = 0; i < numTiles; i++)
+    {
+        int row = i / columns;
+        int col = i % columns;
+
+        std::shared_ptr<Tile> tile;
+        int kind = percent(random);
+        if (kind < 60)
+        {
+            tile = std::make_shared<TileLandscape>(&city);
+            tile->SetImage(L"grass.png");
+        }
+        else if (kind < 80)
+        {
+            tile = std::make_shared<TileBuilding>(&city);
+            tile->SetImage(BuildingImages[building(random)]);
+        }
+        else if (kind < 90)
+        {
+            tile = std::make_shared<TileGarden>(&city);
+        }
+        else
+        {
+            tile = std::make_shared<TileWater>(&city);
+        }
+
+        tile->SetLocation((col * 4 + row % 2 * 2) * City::GridSpacing, row * City::GridSpacing);
+        city.Add(tile);
+    }
+
+    city.SortTiles();
+}
+
+/**
+ * Time a function, returning the best of several runs
+ * @param function Function to time
+ * @return Best time in milliseconds
+ */
+template <class Function>
+double TimeBest(Function function)
+{
+    double best = 0;
+    for (int rep = 0; rep < Repetitions; rep++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (rep == 0 || elapsed.count() < best)
+        {
+            best = elapsed.count();
+        }
+    }
+
+    return best;
+}
+
+/**
+ * Print one benchmark result
+ * @param name Name of what was timed
+ * @param ms Time in milliseconds
+ * @param numTiles Number of tiles processed
+ */
+void PrintResult(const char *name, double ms, int numTiles)
+{
+    std::cout << name << ": " << ms << " ms, " << ms * 1.0e6 / numTiles << " ns/tile" << std::endl;
+}
+
+/**
+ * Compare the cost of virtual visitor dispatch with
+ * statically dispatched City::Visit on a large city.
+ * @param numTiles Number of tiles in the city
+ * @return 0 if the traversals agree
+ */
+int BenchDispatch(int numTiles)
+{
+    City city;
+    city.SetImagesEnabled(false);
+    MakeSyntheticCity(city, numTiles);
+
+    std::cout << "Dispatch benchmark, " << numTiles << " tiles" << std::endl;
+
+    int virtualCount = 0;
+    double virtualMs = TimeBest([&city, &virtualCount]() {
+        BuildingCounter counter;
+        city.Accept(&counter);
+        virtualCount = counter.GetNumBuildings();
+    });
+    PrintResult("TileVisitor (City::Accept)", virtualMs, numTiles);
+
+    int staticCount = 0;
+    double staticMs = TimeBest([&city, &staticCount]() {
+        int count = 0;
+        city.Visit(Overloaded{
+            [&count](TileBuilding *building) { count++; },
+            [](Tile *other) {}
+        });
+        staticCount = count;
+    });
+    PrintResult("Static dispatch (City::Visit)", staticMs, numTiles);
+
+    int parallelCount = 0;
+    double parallelMs = TimeBest([&city, &parallelCount]() {
+        BuildingCounter counter;
+        city.ParallelAccept(&counter);
+        parallelCount = counter.GetNumBuildings();
+    });
+    PrintResult("TileVisitor (City::ParallelAccept)", parallelMs, numTiles);
+
+    if (virtualCount != staticCount || virtualCount != parallelCount)
+    {
+        std::cerr << "Building counts disagree: " << virtualCount << ", "
+                  << staticCount << ", " << parallelCount << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Time the land value tick on a large city
+ * @param numTiles Number of tiles in the city
+ * @return 0 if successful
+ */
+int BenchLandValue(int numTiles)
+{
+    City city;
+    city.SetImagesEnabled(false);
+    MakeSyntheticCity(city, numTiles);
+
+    auto &landValue = city.GetLandValue();
+    auto locations = landValue.GetNumLocations();
+    std::cout << "Land value benchmark, " << numTiles << " tiles, "
+              << locations << " grid locations" << std::endl;
+
+    double ms = TimeBest([&landValue]() { landValue.Tick(); });
+    std::cout << "LandValue::Tick: " << ms << " ms, "
+              << ms * 1.0e6 / locations << " ns/location" << std::endl;
+
+    return 0;
+}
+
+/**
+ * Time a tick of the building simulation on a large city
+ * @param numTiles Number of tiles in the city
+ * @return 0 if successful
+ */
+int BenchSimulation(int numTiles)
+{
+    City city;
+    city.SetImagesEnabled(false);
+    MakeSyntheticCity(city, numTiles);
+
+    auto &simulation = city.GetSimulation();
+    int buildings = simulation.GetNumBuildings();
+    std::cout << "Simulation benchmark, " << numTiles << " tiles, "
+              << buildings << " buildings" << std::endl;
+
+    double ms = TimeBest([&simulation]() { simulation.Tick(0.5f); });
+    std::cout << "BuildingSimulation::Tick: " << ms << " ms, "
+              << ms * 1.0e6 / buildings << " ns/building" << std::endl;
+
+    auto &totals = simulation.GetTotals();
+    std::cout << "Population " << totals.mPopulation << ", jobs " << totals.mJobs
+              << ", employed " << totals.mEmployed << std::endl;
+
+    return 0;
+}
+
+/**
+ * Time traffic updates at 30 frames per second on a large city
+ * @param numTiles Number of tiles in the city
+ * @param numAgents Number of agents travelling
+ * @return 0 if successful
+ */
+int BenchTraffic(int numTiles, int numAgents)
+{
+    City city;
+    city.SetImagesEnabled(false);
+    MakeSyntheticCity(city, numTiles);
+
+    auto &traffic = city.GetTraffic();
+    traffic.SetNumAgents(numAgents);
+    std::cout << "Traffic benchmark, " << numTiles << " tiles, "
+              << traffic.GetNumHomes() << " houses, " << numAgents << " agents" << std::endl;
+
+    double total = 0;
+    double worst = 0;
+    for (int frame = 0; frame < TrafficFrames; frame++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        traffic.Update(FrameTime);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        total += elapsed.count();
+        worst = std::max(worst, elapsed.count());
+    }
+
+    std::cout << "TrafficSimulation::Update: " << total / TrafficFrames << " ms average, "
+              << worst << " ms worst, " << FrameTime * 1000 << " ms frame budget" << std::endl;
+    std::cout << traffic.GetNumAgents() << " agents, "
+              << traffic.GetNumRoutes() << " cached routes" << std::endl;
+
+    return 0;
+}
+
+/**
+ * Time starting up with a city: loading the tile sprites
+ * and then a city file, decoding the images from their
+ * files and then copying them from the asset pack.
+ * @param resources Directory containing the images directory
+ * @param filename City file to load
+ * @return 0 if successful
+ */
+int BenchColdStart(const std::wstring &resources, const std::wstring &filename)
+{
+    wxInitAllImageHandlers();
+
+    int sprites = 0;
+    auto startUp = [&resources, &filename, &sprites](bool useAssets) {
+        City city;
+        city.SetImagesDirectory(resources);
+        city.LoadSprites(useAssets);
+        city.Load(filename);
+        sprites = city.GetAtlas().GetNumSprites();
+    };
+
+    double decoded = TimeBest([&startUp]() { startUp(false); });
+    std::cout << "Start up decoding images: " << decoded << " ms, " << sprites << " sprites" << std::endl;
+
+    double packed = TimeBest([&startUp]() { startUp(true); });
+    std::cout << "Start up from asset pack: " << packed << " ms, " << sprites << " sprites" << std::endl;
+
+    return 0;
+}
+
+/**
+ * Time drawing a city into a frame in memory with each
+ * blend kernel the processor supports, on one thread and
+ * on all of the workers, and check that every way of
+ * drawing produces exactly the same pixels.
+ * @param city City to draw
+ * @param name Name of the city for the report
+ * @return 0 if the kernels agree
+ */
+int BenchRenderCity(City &city, const std::string &name)
+{
+    DrawList list;
+    const wxRect frame(0, 0, RenderWidth, RenderHeight);
+    double build = TimeBest([&city, &list, &frame]() { city.BuildDrawList(&list, frame); });
+    std::cout << "Render " << name << ", " << list.GetSize() << " sprites, "
+              << RenderWidth << "x" << RenderHeight << " frame" << std::endl;
+    std::cout << "City::BuildDrawList: " << build << " ms" << std::endl;
+
+    Compositor compositor(&city.GetAtlas());
+    compositor.Resize(RenderWidth, RenderHeight);
+    compositor.SetThreaded(false);
+    double clear = TimeBest([&compositor]() { compositor.Clear(*wxBLACK); });
+    compositor.SetThreaded(true);
+    double clearThreaded = TimeBest([&compositor]() { compositor.Clear(*wxBLACK); });
+    std::cout << "Compositor::Clear: " << clear << " ms, "
+              << clearThreaded << " ms on " << WorkerPool::Get().GetNumWorkers() << " workers" << std::endl;
+
+    std::vector<uint32_t> expected;
+    int result = 0;
+    for (auto kernel : {BlendKernels::Kernel::Scalar, BlendKernels::Kernel::SSE2, BlendKernels::Kernel::AVX2})
+    {
+        std::string kernelName = wxString(BlendKernels::GetKernelName(kernel)).ToStdString();
+        if (!BlendKernels::IsSupported(kernel))
+        {
+            std::cout << kernelName << ": not supported" << std::endl;
+            continue;
+        }
+
+        compositor.SetKernel(kernel);
+        for (bool threaded : {false, true})
+        {
+            // The first draw makes the premultiplied pages, so it is not timed
+            compositor.SetThreaded(threaded);
+            compositor.Clear(*wxBLACK);
+            compositor.Draw(list);
+
+            bool same = true;
+            if (expected.empty())
+            {
+                expected = compositor.GetPixels();
+            }
+            else if (compositor.GetPixels() != expected)
+            {
+                same = false;
+                result = 1;
+            }
+
+            double ms = TimeBest([&compositor, &list]() { compositor.Draw(list); });
+            std::cout << kernelName << (threaded ? " banded" : " single thread") << " Compositor::Draw: " << ms << " ms"
+                      << (same ? "" : ", pixels differ from Scalar single thread") << std::endl;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Time the software renderer on a city file and
+ * on a synthetic city that covers the whole frame
+ * @param resources Directory containing the images directory
+ * @param filename City file to draw
+ * @return 0 if the blend kernels agree
+ */
+int BenchRender(const std::wstring &resources, const std::wstring &filename)
+{
+    wxInitAllImageHandlers();
+
+    City city;
+    city.SetImagesDirectory(resources);
+    city.LoadSprites();
+    if (!city.Load(filename))
+    {
+        std::cerr << "Unable to load " << wxString(filename).ToStdString() << std::endl;
+        return 1;
+    }
+    int result = BenchRenderCity(city, wxString(filename).ToStdString());
+
+    City synthetic;
+    synthetic.SetImagesDirectory(resources);
+    synthetic.LoadSprites();
+    MakeSyntheticCity(synthetic, RenderTiles);
+    result |= BenchRenderCity(synthetic, "synthetic city");
+
+    return result;
+}
+
+/**
+ * Report how many sprites occlusion culling removes
+ * when the whole of a city is drawn and how long the
+ * frame takes with and without it, and check that
+ * the culled list draws exactly the same frame
+ * @param city City to draw
+ * @param name Name of the city for the report
+ * @return 0 if the frames match
+ */
+int BenchCullCity(City &city, const std::string &name)
+{
+    // The view is everything the city draws
+    wxRect view;
+    for (auto tile : city)
+    {
+        view = view.IsEmpty() ? tile->GetBounds() : view.Union(tile->GetBounds());
+    }
+
+    auto &culler = city.GetCuller();
+    culler.SetEnabled(false);
+    DrawList all;
+    city.BuildDrawList(&all, view);
+    culler.SetEnabled(true);
+
+    DrawList culled;
+    city.BuildDrawList(&culled, view);
+    int hidden = culler.GetNumOccluded();
+    std::cout << name << ": " << hidden << " of " << all.GetSize() << " sprites hidden, "
+              << (all.GetSize() > 0 ? 100.0 * hidden / all.GetSize() : 0.0) << "% culled" << std::endl;
+
+    Compositor compositor(&city.GetAtlas());
+    compositor.Resize(view.GetWidth(), view.GetHeight());
+    auto draw = [&compositor, &view](const DrawList &list) {
+        compositor.Clear(*wxBLACK);
+        for (auto &item : list)
+        {
+            compositor.Draw(item.mSprite, item.mX - view.x, item.mY - view.y);
+        }
+    };
+
+    // Culling only pays if building and drawing the list gets faster
+    for (bool enabled : {false, true})
+    {
+        culler.SetEnabled(enabled);
+        DrawList list;
+        double ms = TimeBest([&city, &list, &view, &draw]() {
+            city.BuildDrawList(&list, view);
+            draw(list);
+        });
+        std::cout << name << ": culling " << (enabled ? "on " : "off") << ", build and draw " << ms << " ms"
+                  << std::endl;
+    }
+
+    culler.SetEnabled(false);
+
+    // Both lists must draw the same frame
+    draw(all);
+    auto allPixels = compositor.GetPixels();
+    draw(culled);
+    if (allPixels != compositor.GetPixels())
+    {
+        std::cout << name << ": culled frame differs" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Report how many sprites occlusion culling removes from
+ * city files and from a dense synthetic city
+ * @param resources Directory containing the images directory
+ * @param filenames City files to draw
+ * @return 0 if culling never changes the frame
+ */
+int BenchCull(const std::wstring &resources, const std::vector<std::wstring> &filenames)
+{
+    wxInitAllImageHandlers();
+
+    int result = 0;
+    for (auto &filename : filenames)
+    {
+        City city;
+        city.SetImagesDirectory(resources);
+        city.LoadSprites();
+        if (!city.Load(filename))
+        {
+            std::cerr << "Unable to load " << wxString(filename).ToStdString() << std::endl;
+            return 1;
+        }
+
+        result |= BenchCullCity(city, wxString(filename).ToStdString());
+    }
+
+    City synthetic;
+    synthetic.SetImagesDirectory(resources);
+    synthetic.LoadSprites();
+    MakeSyntheticCity(synthetic, CullTiles);
+    result |= BenchCullCity(synthetic, "synthetic city");
+
+    return result;
+}
+
+/**
+ * Check that drawing and updating a city makes no heap
+ * allocations once it is running, reporting any by phase.
+ *
+ * Each frame does the library work CityView::OnPaint does:
+ * update, draw at full size and zoomed out, draw in software,
+ * draw the traffic and every overlay, draw the report and
+ * make the status bar report. Only allocations made by the
+ * city library are seen, as the device context here does not
+ * draw anywhere and the status text is not shown.
+ *
+ * @param resources Directory containing the images directory
+ * @param filename City file to run
+ * @return 0 if no frame allocates
+ */
+int BenchAllocations(const std::wstring &resources, const std::wstring &filename)
+{
+    if (!AllocationCounter::IsEnabled())
+    {
+        std::cerr << "Allocation counting is not compiled in, run CityAllocations instead" << std::endl;
+        return 1;
+    }
+
+    wxInitAllImageHandlers();
+
+    City city;
+    city.SetImagesDirectory(resources);
+    city.LoadSprites();
+    if (!city.Load(filename))
+    {
+        std::cerr << "Unable to load " << wxString(filename).ToStdString() << std::endl;
+        return 1;
+    }
+
+    auto &traffic = city.GetTraffic();
+    traffic.SetAgentsPerHome(8, DefaultAgents);
+
+    TextCache text;
+    text.SetFont(wxFont(wxSize(0, 14), wxFONTFAMILY_SWISS, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL), *wxCYAN);
+    ReportView report;
+    report.SetStatistics(&city.GetStatistics());
+    report.SetCoverage(&city.GetServiceCoverage());
+    report.SetLandValue(&city.GetLandValue());
+    report.SetSimulation(&city.GetSimulation());
+    report.SetTextCache(&text);
+    CityOverlays overlays(&city);
+    DrawTimeReport drawTime;
+
+    // The culler's counts are part of the status bar report when it is enabled
+    auto &culler = city.GetCuller();
+    culler.SetEnabled(true);
+
+    const wxRect view(0, 0, RenderWidth, RenderHeight);
+    wxBitmap bitmap(RenderWidth, RenderHeight);
+    wxMemoryDC dc(bitmap);
+    Compositor compositor(&city.GetAtlas());
+    compositor.Resize(RenderWidth, RenderHeight);
+    DrawList list;
+
+    AllocationCounter counter;
+    auto frame = [&]() {
+        counter.BeginFrame();
+        city.Update(FrameTime);
+        counter.EndPhase("update");
+        auto start = std::chrono::steady_clock::now();
+        city.OnDraw(&dc);
+        auto micro = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        counter.EndPhase("draw");
+        city.OnDraw(&dc, 1);
+        city.OnDraw(&dc, AllocationFlatZoom);
+        counter.EndPhase("zoomed");
+        city.BuildDrawList(&list, view);
+        compositor.Clear(*wxBLACK);
+        compositor.Draw(list);
+        counter.EndPhase("software");
+        traffic.Draw(&dc, view);
+        overlays.DrawOutlines(&dc, view);
+        overlays.DrawLandValue(&dc, view);
+        for (int service = 0; service < ServiceCoverage::NumServices; service++)
+        {
+            overlays.DrawCoverage(&dc, ServiceCoverage::Service(service), view);
+        }
+
+        counter.EndPhase("overlays");
+        report.SetReport(city.GenerateCityReport());
+        report.Draw(&dc, 10, 10, RenderHeight - 20);
+        counter.EndPhase("report");
+
+        // The count of the frame before, as CityView reports after each frame
+        drawTime.AddFrame((long)micro.count(), counter.GetFrameCount(), L"wxDC", &culler);
+        counter.EndPhase("status");
+        counter.EndFrame();
+    };
+
+    for (int i = 0; i < AllocationWarmupFrames; i++)
+    {
+        frame();
+    }
+
+    long long total = 0;
+    std::vector<long long> phases(AllocationCounter::MaxPhases, 0);
+    for (int i = 0; i < AllocationFrames; i++)
+    {
+        frame();
+        total += counter.GetFrameCount();
+        for (int phase = 0; phase < counter.GetNumPhases(); phase++)
+        {
+            phases[phase] += counter.GetPhaseCount(phase);
+        }
+    }
+
+    std::cout << "Allocations in " << AllocationFrames << " frames: " << total << std::endl;
+    for (int phase = 0; phase < counter.GetNumPhases(); phase++)
+    {
+        std::cout << "  " << counter.GetPhaseName(phase) << ": " << phases[phase] << std::endl;
+    }
+
+    return total == 0 ? 0 : 1;
+}
+
+/**
+ * Main entry point for the benchmarks
+ * @param argc Number of command line arguments
+ * @param argv Command line arguments
+ * @return 0 if successful
+ */
+int main(int argc, char *argv[])
+{
+    wxInitializer initializer;
+    if (!initializer.IsOk())
+    {
+        std::cerr << "Unable to initialize wxWidgets" << std::endl;
+        return 1;
+    }
+
+    std::string benchmark = argc > 1 ? argv[1] : "dispatch";
+    if (benchmark == "dispatch")
+    {
+        int numTiles = argc > 2 ? std::stoi(argv[2]) : DefaultTiles;
+        return BenchDispatch(numTiles);
+    }
+
+    if (benchmark == "landvalue")
+    {
+        int numTiles = argc > 2 ? std::stoi(argv[2]) : DefaultTiles;
+        return BenchLandValue(numTiles);
+    }
+
+    if (benchmark == "simulation")
+    {
+        int numTiles = argc > 2 ? std::stoi(argv[2]) : DefaultTiles;
+        return BenchSimulation(numTiles);
+    }
+
+    if (benchmark == "traffic")
+    {
+        int numTiles = argc > 2 ? std::stoi(argv[2]) : DefaultTrafficTiles;
+        int numAgents = argc > 3 ? std::stoi(argv[3]) : DefaultAgents;
+        return BenchTraffic(numTiles, numAgents);
+    }
+
+    if (benchmark == "coldstart")
+    {
+        std::wstring resources = argc > 2 ? wxString(argv[2]).ToStdWstring() : L".";
+        std::wstring filename = argc > 3 ? wxString(argv[3]).ToStdWstring() : resources + L"/nice.city";
+        return BenchColdStart(resources, filename);
+    }
+
+    if (benchmark == "render")
+    {
+        std::wstring resources = argc > 2 ? wxString(argv[2]).ToStdWstring() : L".";
+        std::wstring filename = argc > 3 ? wxString(argv[3]).ToStdWstring() : resources + L"/nice.city";
+        return BenchRender(resources, filename);
+    }
+
+    if (benchmark == "cull")
+    {
+        std::wstring resources = argc > 2 ? wxString(argv[2]).ToStdWstring() : L".";
+        std::vector<std::wstring> filenames;
+        for (int arg = 3; arg < argc; arg++)
+        {
+            filenames.push_back(wxString(argv[arg]).ToStdWstring());
+        }
+
+        if (filenames.empty())
+        {
+            filenames = {resources + L"/nice.city", resources + L"/large.city"};
+        }
+
+        return BenchCull(resources, filenames);
+    }
+
+    if (benchmark == "allocations")
+    {
+        std::wstring resources = argc > 2 ? wxString(argv[2]).ToStdWstring() : L".";
+        std::wstring filename = argc > 3 ? wxString(argv[3]).ToStdWstring() : resources + L"/nice.city";
+        return BenchAllocations(resources, filename);
+    }
+
+    std::cerr << "Usage: CityBench dispatch|landvalue|simulation|traffic [tiles] [agents]" << std::endl;
+    std::cerr << "       CityBench coldstart [resources-directory] [city-file]" << std::endl;
+    std::cerr << "       CityBench render [resources-directory] [city-file]" << std::endl;
+    std::cerr << "       CityBench cull [resources-directory] [city-file...]" << std::endl;
+    std::cerr << "       CityBench allocations [resources-directory] [city-file]" << std::endl;
+    return 1;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file CityExport.cpp
+ * @author timan
+ *
+ * Command line tool that exports the report for a
+ * city file to CSV or JSON without opening a window.
+ *
+ * Usage: CityExport input.city output.csv|output.json
+ */
+
+#include "pch.h"
+
+#include <iostream>
+
+#include "City.h"
+#include "ReportExporter.h"
+
+/**
+ * Main entry point for the export tool
+ * @param argc Number of command line arguments
+ * @param argv Command line arguments
+ * @return 0 if successful
+ */
+int main(int argc, char *argv[])
+{
+    wxInitializer initializer;
+    if (!initializer.IsOk())
+    {
+        std::cerr << "Unable to initialize wxWidgets" << std::endl;
+        return 1;
+    }
+
+    if (argc != 3)
+    {
+        std::cerr << "Usage: CityExport input.city output.csv|output.json" << std::endl;
+        return 1;
+    }
+
+    // Nothing is drawn, so tile images are never loaded
+    City city;
+    city.SetImagesEnabled(false);
+    if (!city.Load(wxString(argv[1])))
+    {
+        std::cerr << "Unable to load " << argv[1] << std::endl;
+        return 1;
+    }
+
+    ReportExporter exporter(&city);
+    if (!exporter.Export(wxString(argv[2]).ToStdWstring()))
+    {
+        std::cerr << "Unable to write " << argv[2] << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
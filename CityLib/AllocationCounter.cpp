@@ -0,0 +1,186 @@
+/**
+ * @file AllocationCounter.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+#include "AllocationCounter.h"
+
+#ifdef CITY_COUNT_ALLOCATIONS
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+/// Allocations made through operator new since the program started
+static std::atomic<long long> Allocations(0);
+
+/**
+ * Allocate memory and count the allocation
+ * @param size Number of bytes
+ * @return Memory, or nullptr if there is none
+ */
+static void *CountedAlloc(size_t size)
+{
+    Allocations.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size > 0 ? size : 1);
+}
+
+/**
+ * Allocate aligned memory and count the allocation
+ * @param size Number of bytes
+ * @param alignment Alignment in bytes
+ * @return Memory, or nullptr if there is none
+ */
+static void *CountedAlignedAlloc(size_t size, std::align_val_t alignment)
+{
+    Allocations.fetch_add(1, std::memory_order_relaxed);
+    size_t align = static_cast<size_t>(alignment);
+#ifdef _MSC_VER
+    return _aligned_malloc(size > 0 ? size : 1, align);
+#else
+    // aligned_alloc needs a size that is a multiple of the alignment
+    size_t rounded = (std::max(size, (size_t)1) + align - 1) / align * align;
+    return aligned_alloc(align, rounded);
+#endif
+}
+
+/**
+ * Free memory from CountedAlignedAlloc
+ * @param memory Memory to free
+ */
+static void AlignedFree(void *memory)
+{
+#ifdef _MSC_VER
+    _aligned_free(memory);
+#else
+    free(memory);
+#endif
+}
+
+void *operator new(size_t size)
+{
+    void *memory = CountedAlloc(size);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return memory;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    return CountedAlloc(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return CountedAlloc(size);
+}
+
+void *operator new(size_t size, std::align_val_t alignment)
+{
+    void *memory = CountedAlignedAlloc(size, alignment);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return memory;
+}
+
+void *operator new[](size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void operator delete(void *memory) noexcept { free(memory); }
+void operator delete[](void *memory) noexcept { free(memory); }
+void operator delete(void *memory, size_t) noexcept { free(memory); }
+void operator delete[](void *memory, size_t) noexcept { free(memory); }
+void operator delete(void *memory, const std::nothrow_t &) noexcept { free(memory); }
+void operator delete[](void *memory, const std::nothrow_t &) noexcept { free(memory); }
+void operator delete(void *memory, std::align_val_t) noexcept { AlignedFree(memory); }
+void operator delete[](void *memory, std::align_val_t) noexcept { AlignedFree(memory); }
+void operator delete(void *memory, size_t, std::align_val_t) noexcept { AlignedFree(memory); }
+void operator delete[](void *memory, size_t, std::align_val_t) noexcept { AlignedFree(memory); }
+
+/**
+ * Is allocation counting compiled in?
+ * @return true if allocations are counted
+ */
+bool AllocationCounter::IsEnabled()
+{
+    return true;
+}
+
+/**
+ * Get the number of allocations made since the program started
+ * @return Number of allocations
+ */
+long long AllocationCounter::GetTotal()
+{
+    return Allocations.load(std::memory_order_relaxed);
+}
+
+#else
+
+/**
+ * Is allocation counting compiled in?
+ * @return true if allocations are counted
+ */
+bool AllocationCounter::IsEnabled()
+{
+    return false;
+}
+
+/**
+ * Get the number of allocations made since the program started
+ * @return Always 0, since allocations are not counted
+ */
+long long AllocationCounter::GetTotal()
+{
+    return 0;
+}
+
+#endif
+
+/**
+ * Start counting a frame
+ */
+void AllocationCounter::BeginFrame()
+{
+    mNumPhases = 0;
+    mFrameStart = mPhaseStart = GetTotal();
+}
+
+/**
+ * Record the allocations since the end of the last phase
+ * @param name Name of the phase that just ended, which must
+ * stay valid; it is not copied
+ */
+void AllocationCounter::EndPhase(const char *name)
+{
+    long long total = GetTotal();
+    if (mNumPhases < MaxPhases)
+    {
+        mPhases[mNumPhases++] = {name, total - mPhaseStart};
+    }
+
+    mPhaseStart = total;
+}
+
+/**
+ * Finish counting a frame
+ */
+void AllocationCounter::EndFrame()
+{
+    mFrameCount = GetTotal() - mFrameStart;
+}
@@ -0,0 +1,89 @@
+/**
+ * @file AllocationCounter.h
+ * @author timan
+ *
+ * Counts heap allocations per frame and per phase of a frame
+ */
+
+#ifndef CITY_CITYLIB_ALLOCATIONCOUNTER_H
+#define CITY_CITYLIB_ALLOCATIONCOUNTER_H
+
+/**
+ * Counts heap allocations per frame and per phase of a frame.
+ *
+ * Counting is compiled in only when CITY_COUNT_ALLOCATIONS is
+ * defined (the CMake option of the same name, and always in the
+ * CityLibCounted library the allocation tests use), which replaces
+ * the global operator new with one that counts every allocation on
+ * every thread. Otherwise nothing is counted and every count is 0.
+ *
+ * A frame is split into named phases: BeginFrame starts the frame,
+ * each EndPhase records the allocations since the end of the
+ * previous phase, and EndFrame finishes the frame. None of these
+ * allocate, so measuring does not disturb the counts.
+ */
+class AllocationCounter
+{
+public:
+    /// Most phases a frame can be split into
+    static const int MaxPhases = 8;
+
+private:
+    /// Allocations in one phase of a frame
+    struct Phase
+    {
+        const char *mName;      ///< Name of the phase
+        long long mCount;       ///< Allocations in the phase
+    };
+
+    /// Phases of the current or last frame
+    Phase mPhases[MaxPhases];
+
+    /// Number of phases in mPhases
+    int mNumPhases = 0;
+
+    /// Total when the frame started
+    long long mFrameStart = 0;
+
+    /// Total when the last phase ended
+    long long mPhaseStart = 0;
+
+    /// Allocations in the last whole frame
+    long long mFrameCount = 0;
+
+public:
+    static bool IsEnabled();
+    static long long GetTotal();
+
+    void BeginFrame();
+    void EndPhase(const char *name);
+    void EndFrame();
+
+    /**
+     * Get the number of allocations in the last frame
+     * @return Number of allocations
+     */
+    long long GetFrameCount() const { return mFrameCount; }
+
+    /**
+     * Get the number of phases the last frame was split into
+     * @return Number of phases
+     */
+    int GetNumPhases() const { return mNumPhases; }
+
+    /**
+     * Get the name of a phase of the last frame
+     * @param phase Phase index
+     * @return Name of the phase
+     */
+    const char *GetPhaseName(int phase) const { return mPhases[phase].mName; }
+
+    /**
+     * Get the number of allocations in a phase of the last frame
+     * @param phase Phase index
+     * @return Number of allocations
+     */
+    long long GetPhaseCount(int phase) const { return mPhases[phase].mCount; }
+};
+
+#endif //CITY_CITYLIB_ALLOCATIONCOUNTER_H
@@ -0,0 +1,354 @@
+/**
+ * @file AssetPack.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+
+#include <climits>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "AssetPack.h"
+#include "BufferedWriter.h"
+
+const std::wstring AssetPack::PackFile = L"assets.pack";
+
+/// Identifies a pack file
+const char PackMagic[8] = {'C', 'I', 'T', 'Y', 'P', 'A', 'C', 'K'};
+
+/// Version of the pack file layout
+const unsigned PackVersion = 1;
+
+/// Size of the header: magic, version and number of images
+const size_t HeaderSize = 16;
+
+/// Size of each image in the table: name offset and length,
+/// width, height, and offset of the pixels
+const size_t EntrySize = 24;
+
+/// Pixels of each image start on a multiple of this
+const size_t PixelAlignment = 16;
+
+/**
+ * Read a little endian number from the pack
+ * @param data Where the number is
+ * @param bytes Size of the number in bytes
+ * @return The number
+ */
+static unsigned long long ReadNumber(const unsigned char *data, int bytes)
+{
+    unsigned long long value = 0;
+    for (int i = bytes - 1; i >= 0; i--)
+    {
+        value = (value << 8) | data[i];
+    }
+
+    return value;
+}
+
+/**
+ * Write a little endian number
+ * @param writer Where to write it
+ * @param value The number
+ * @param bytes Size of the number in bytes
+ */
+static void WriteNumber(BufferedWriter &writer, unsigned long long value, int bytes)
+{
+    char data[8];
+    for (int i = 0; i < bytes; i++)
+    {
+        data[i] = (char)(value >> (i * 8));
+    }
+
+    writer.Write(data, bytes);
+}
+
+/**
+ * Constructor
+ */
+AssetPack::AssetPack()
+{
+}
+
+/**
+ * Destructor
+ */
+AssetPack::~AssetPack()
+{
+    Close();
+}
+
+/**
+ * Open and memory map a pack file
+ * @param filename Pack file to open
+ * @return true if the pack was opened and is valid
+ */
+bool AssetPack::Open(const std::wstring &filename)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+    {
+        mMapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mMapping != nullptr)
+        {
+            mData = (const unsigned char *)MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+            mSize = (size_t)size.QuadPart;
+        }
+    }
+
+    CloseHandle(file);
+#else
+    int file = open(wxString(filename).fn_str(), O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(file, &status) == 0 && status.st_size > 0)
+    {
+        void *data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (data != MAP_FAILED)
+        {
+            mData = (const unsigned char *)data;
+            mSize = (size_t)status.st_size;
+        }
+    }
+
+    // The mapping stays valid after the file is closed
+    close(file);
+#endif
+
+    if (mData == nullptr || !ReadIndex())
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Unmap the pack file, if one is open
+ */
+void AssetPack::Close()
+{
+    mAssets.clear();
+
+#ifdef _WIN32
+    if (mData != nullptr)
+    {
+        UnmapViewOfFile(mData);
+    }
+
+    if (mMapping != nullptr)
+    {
+        CloseHandle(mMapping);
+        mMapping = nullptr;
+    }
+#else
+    if (mData != nullptr)
+    {
+        munmap((void *)mData, mSize);
+    }
+#endif
+
+    mData = nullptr;
+    mSize = 0;
+}
+
+/**
+ * Read the table of images, checking it lies within the file
+ * @return true if the table is valid
+ */
+bool AssetPack::ReadIndex()
+{
+    if (mSize < HeaderSize || memcmp(mData, PackMagic, sizeof(PackMagic)) != 0 ||
+        ReadNumber(mData + 8, 4) != PackVersion)
+    {
+        return false;
+    }
+
+    size_t count = ReadNumber(mData + 12, 4);
+    if (count > (mSize - HeaderSize) / EntrySize)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const unsigned char *entry = mData + HeaderSize + i * EntrySize;
+        size_t nameOffset = ReadNumber(entry, 4);
+        size_t nameLength = ReadNumber(entry + 4, 4);
+        size_t width = ReadNumber(entry + 8, 4);
+        size_t height = ReadNumber(entry + 12, 4);
+        size_t pixels = ReadNumber(entry + 16, 8);
+
+        if (nameOffset > mSize || nameLength > mSize - nameOffset || pixels > mSize)
+        {
+            return false;
+        }
+
+        // The sizes come from the file, so the pixels are checked
+        // to fit without ever multiplying them out
+        if (width == 0 || height == 0 || width > INT_MAX || height > INT_MAX ||
+            width > (mSize - pixels) / 4 / height)
+        {
+            return false;
+        }
+
+        Asset asset;
+        asset.mWidth = (int)width;
+        asset.mHeight = (int)height;
+        asset.mRGB = mData + pixels;
+        asset.mAlpha = mData + pixels + width * height * 3;
+
+        auto name = wxString::FromUTF8((const char *)mData + nameOffset, nameLength);
+        mAssets[name.ToStdWstring()] = asset;
+    }
+
+    return true;
+}
+
+/**
+ * Find an image in the pack
+ * @param file File name the image was packed from
+ * @return The image or nullptr if it is not in the pack
+ */
+const AssetPack::Asset *AssetPack::Find(const std::wstring &file) const
+{
+    auto found = mAssets.find(file);
+    return found != mAssets.end() ? &found->second : nullptr;
+}
+
+/**
+ * Copy an image in the pack into a wxImage
+ * @param file File name the image was packed from
+ * @param image Image to set
+ * @return true if the image is in the pack
+ */
+bool AssetPack::GetImage(const std::wstring &file, wxImage &image) const
+{
+    auto asset = Find(file);
+    if (asset == nullptr)
+    {
+        return false;
+    }
+
+    size_t pixels = (size_t)asset->mWidth * asset->mHeight;
+
+    // wxImage takes ownership of memory from malloc
+    auto rgb = (unsigned char *)malloc(pixels * 3);
+    auto alpha = (unsigned char *)malloc(pixels);
+    memcpy(rgb, asset->mRGB, pixels * 3);
+    memcpy(alpha, asset->mAlpha, pixels);
+
+    image = wxImage(asset->mWidth, asset->mHeight, rgb, alpha);
+    return true;
+}
+
+/**
+ * Decode images and write them to a pack file
+ * @param directory Directory containing the images
+ * @param files Names of the image files in the directory
+ * @param filename Pack file to write
+ * @return true if every image was decoded and the pack was written
+ */
+bool AssetPack::Build(const std::wstring &directory, const std::vector<std::wstring> &files,
+                      const std::wstring &filename)
+{
+    std::vector<wxImage> images;
+    std::vector<std::string> names;
+    for (auto &file : files)
+    {
+        wxImage image(directory + L"/" + file, wxBITMAP_TYPE_ANY);
+        if (!image.IsOk())
+        {
+            return false;
+        }
+
+        // Transparency is always kept as alpha
+        if (!image.HasAlpha())
+        {
+            image.InitAlpha();
+        }
+
+        images.push_back(image);
+        names.push_back(wxString(file).ToStdString(wxConvUTF8));
+    }
+
+    // Lay out the names after the table, then the pixels
+    size_t offset = HeaderSize + images.size() * EntrySize;
+    std::vector<size_t> nameOffsets;
+    for (auto &name : names)
+    {
+        nameOffsets.push_back(offset);
+        offset += name.size();
+    }
+
+    std::vector<size_t> pixelOffsets;
+    for (auto &image : images)
+    {
+        offset = (offset + PixelAlignment - 1) / PixelAlignment * PixelAlignment;
+        pixelOffsets.push_back(offset);
+        offset += (size_t)image.GetWidth() * image.GetHeight() * 4;
+    }
+
+    BufferedWriter writer;
+    if (!writer.Open(filename))
+    {
+        return false;
+    }
+
+    writer.Write(PackMagic, sizeof(PackMagic));
+    WriteNumber(writer, PackVersion, 4);
+    WriteNumber(writer, images.size(), 4);
+
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        WriteNumber(writer, nameOffsets[i], 4);
+        WriteNumber(writer, names[i].size(), 4);
+        WriteNumber(writer, images[i].GetWidth(), 4);
+        WriteNumber(writer, images[i].GetHeight(), 4);
+        WriteNumber(writer, pixelOffsets[i], 8);
+    }
+
+    size_t written = HeaderSize + images.size() * EntrySize;
+    for (auto &name : names)
+    {
+        writer.Write(name.data(), name.size());
+        written += name.size();
+    }
+
+    const char padding[PixelAlignment] = {};
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        writer.Write(padding, pixelOffsets[i] - written);
+
+        size_t pixels = (size_t)images[i].GetWidth() * images[i].GetHeight();
+        writer.Write((const char *)images[i].GetData(), pixels * 3);
+        writer.Write((const char *)images[i].GetAlpha(), pixels);
+        written = pixelOffsets[i] + pixels * 4;
+    }
+
+    return writer.Close();
+}
@@ -0,0 +1,93 @@
+/**
+ * @file AssetPack.h
+ * @author timan
+ *
+ * A file of images decoded ahead of time
+ */
+
+#ifndef CITY_CITYLIB_ASSETPACK_H
+#define CITY_CITYLIB_ASSETPACK_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * A file of images decoded ahead of time.
+ *
+ * Decoding PNG files is most of the cost of starting up. The
+ * CityPack tool decodes every image in the images directory once,
+ * at build time, into a single pack file. At startup the pack is
+ * memory mapped, and images are copied straight out of it with
+ * no decoding.
+ *
+ * The pixels of each image are stored the way wxImage keeps them:
+ * rows of RGB, followed by rows of alpha. The file starts with a
+ * header and a table of the images, then the names, then the
+ * pixels. All numbers are little endian.
+ */
+class AssetPack
+{
+public:
+    /// Name of the pack file in the images directory
+    static const std::wstring PackFile;
+
+    /// An image in the pack
+    struct Asset
+    {
+        int mWidth = 0;                         ///< Width in pixels
+        int mHeight = 0;                        ///< Height in pixels
+        const unsigned char *mRGB = nullptr;    ///< Rows of RGB
+        const unsigned char *mAlpha = nullptr;  ///< Rows of alpha
+    };
+
+private:
+    /// The mapped file, or nullptr if none is open
+    const unsigned char *mData = nullptr;
+
+    /// Size of the mapped file in bytes
+    size_t mSize = 0;
+
+#ifdef _WIN32
+    /// File mapping handle
+    void *mMapping = nullptr;
+#endif
+
+    /// The images in the pack, by file name
+    std::map<std::wstring, Asset> mAssets;
+
+    bool ReadIndex();
+
+public:
+    AssetPack();
+    virtual ~AssetPack();
+
+    /// Copy constructor (disabled)
+    AssetPack(const AssetPack &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const AssetPack &) = delete;
+
+    bool Open(const std::wstring &filename);
+    void Close();
+
+    /**
+     * Is a pack open?
+     * @return true if open
+     */
+    bool IsOpen() const { return mData != nullptr; }
+
+    /**
+     * Get the number of images in the pack
+     * @return Number of images
+     */
+    int GetNumAssets() const { return (int)mAssets.size(); }
+
+    const Asset *Find(const std::wstring &file) const;
+    bool GetImage(const std::wstring &file, wxImage &image) const;
+
+    static bool Build(const std::wstring &directory, const std::vector<std::wstring> &files,
+                      const std::wstring &filename);
+};
+
+#endif //CITY_CITYLIB_ASSETPACK_H
@@ -0,0 +1,307 @@
+/**
+ * @file BlendKernels.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+#include "BlendKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CITY_BLEND_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+/// MSVC compiles AVX2 intrinsics without being asked
+#define CITY_TARGET_AVX2
+#else
+/// Compile one function for AVX2 without requiring it everywhere
+#define CITY_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+/**
+ * Blend one premultiplied channel over another
+ *
+ * The division by 255 is rounded exactly the way the SIMD
+ * kernels do it, so every kernel produces the same pixels.
+ *
+ * @param dst Destination channel
+ * @param src Source channel
+ * @param inv 255 minus the source alpha
+ * @return Blended channel
+ */
+static inline uint32_t BlendChannel(uint32_t dst, uint32_t src, uint32_t inv)
+{
+    uint32_t t = dst * inv + 128;
+    uint32_t c = src + ((t + (t >> 8)) >> 8);
+    return c > 255 ? 255 : c;
+}
+
+/**
+ * Blend a row of pixels one at a time
+ * @param dst Destination pixels
+ * @param src Source pixels
+ * @param count Number of pixels
+ */
+void BlendKernels::BlendRowScalar(uint32_t *dst, const uint32_t *src, int count)
+{
+    auto d = reinterpret_cast<uint8_t *>(dst);
+    auto s = reinterpret_cast<const uint8_t *>(src);
+    for (int i = 0; i < count; i++, d += 4, s += 4)
+    {
+        uint32_t alpha = s[3];
+        if (alpha == 0)
+        {
+            continue;
+        }
+
+        if (alpha == 255)
+        {
+            dst[i] = src[i];
+            continue;
+        }
+
+        uint32_t inv = 255 - alpha;
+        d[0] = (uint8_t)BlendChannel(d[0], s[0], inv);
+        d[1] = (uint8_t)BlendChannel(d[1], s[1], inv);
+        d[2] = (uint8_t)BlendChannel(d[2], s[2], inv);
+        d[3] = (uint8_t)BlendChannel(d[3], s[3], inv);
+    }
+}
+
+#ifdef CITY_BLEND_X86
+
+/**
+ * Blend a row of pixels four at a time with SSE2
+ * @param dst Destination pixels
+ * @param src Source pixels
+ * @param count Number of pixels
+ */
+static void BlendRowSSE2(uint32_t *dst, const uint32_t *src, int count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i max = _mm_set1_epi16(255);
+    const __m128i half = _mm_set1_epi16(128);
+    const __m128i alphaMask = _mm_set1_epi32((int)0xff000000);
+
+    int i = 0;
+    for ( ; i + 4 <= count; i += 4)
+    {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i a = _mm_and_si128(s, alphaMask);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, zero)) == 0xffff)
+        {
+            // All four are transparent
+            continue;
+        }
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, alphaMask)) == 0xffff)
+        {
+            // All four are opaque
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), s);
+            continue;
+        }
+
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        __m128i dLo = _mm_unpacklo_epi8(d, zero);
+        __m128i dHi = _mm_unpackhi_epi8(d, zero);
+        __m128i sLo = _mm_unpacklo_epi8(s, zero);
+        __m128i sHi = _mm_unpackhi_epi8(s, zero);
+
+        __m128i aLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sLo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i aHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sHi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+        __m128i tLo = _mm_add_epi16(_mm_mullo_epi16(dLo, _mm_sub_epi16(max, aLo)), half);
+        __m128i tHi = _mm_add_epi16(_mm_mullo_epi16(dHi, _mm_sub_epi16(max, aHi)), half);
+        tLo = _mm_srli_epi16(_mm_add_epi16(tLo, _mm_srli_epi16(tLo, 8)), 8);
+        tHi = _mm_srli_epi16(_mm_add_epi16(tHi, _mm_srli_epi16(tHi, 8)), 8);
+
+        __m128i result = _mm_adds_epu8(_mm_packus_epi16(tLo, tHi), s);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), result);
+    }
+
+    BlendKernels::BlendRowScalar(dst + i, src + i, count - i);
+}
+
+/**
+ * Blend a row of pixels eight at a time with AVX2
+ * @param dst Destination pixels
+ * @param src Source pixels
+ * @param count Number of pixels
+ */
+CITY_TARGET_AVX2 static void BlendRowAVX2(uint32_t *dst, const uint32_t *src, int count)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max = _mm256_set1_epi16(255);
+    const __m256i half = _mm256_set1_epi16(128);
+    const __m256i alphaMask = _mm256_set1_epi32((int)0xff000000);
+
+    int i = 0;
+    for ( ; i + 8 <= count; i += 8)
+    {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        __m256i a = _mm256_and_si256(s, alphaMask);
+        if ((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, zero)) == 0xffffffffu)
+        {
+            // All eight are transparent
+            continue;
+        }
+
+        if ((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, alphaMask)) == 0xffffffffu)
+        {
+            // All eight are opaque
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), s);
+            continue;
+        }
+
+        // Unpacking and packing both work within each 128 bit lane,
+        // so the pixels come back out in the order they went in
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+        __m256i dLo = _mm256_unpacklo_epi8(d, zero);
+        __m256i dHi = _mm256_unpackhi_epi8(d, zero);
+        __m256i sLo = _mm256_unpacklo_epi8(s, zero);
+        __m256i sHi = _mm256_unpackhi_epi8(s, zero);
+
+        __m256i aLo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sLo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m256i aHi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sHi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+        __m256i tLo = _mm256_add_epi16(_mm256_mullo_epi16(dLo, _mm256_sub_epi16(max, aLo)), half);
+        __m256i tHi = _mm256_add_epi16(_mm256_mullo_epi16(dHi, _mm256_sub_epi16(max, aHi)), half);
+        tLo = _mm256_srli_epi16(_mm256_add_epi16(tLo, _mm256_srli_epi16(tLo, 8)), 8);
+        tHi = _mm256_srli_epi16(_mm256_add_epi16(tHi, _mm256_srli_epi16(tHi, 8)), 8);
+
+        __m256i result = _mm256_adds_epu8(_mm256_packus_epi16(tLo, tHi), s);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), result);
+    }
+
+    BlendKernels::BlendRowScalar(dst + i, src + i, count - i);
+}
+
+/**
+ * Determine if the processor and operating system support AVX2
+ * @return true if AVX2 instructions can be used
+ */
+static bool HasAVX2()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+    {
+        return false;
+    }
+
+    // The operating system must save the AVX registers
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 6) != 6)
+    {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+/**
+ * Determine if a kernel can be used on this processor
+ * @param kernel Kernel to test
+ * @return true if it can be used
+ */
+bool BlendKernels::IsSupported(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case Kernel::Scalar:
+        return true;
+
+#ifdef CITY_BLEND_X86
+    case Kernel::SSE2:
+        return true;
+
+    case Kernel::AVX2:
+    {
+        static const bool avx2 = HasAVX2();
+        return avx2;
+    }
+#endif
+
+    default:
+        return false;
+    }
+}
+
+/**
+ * Get the function for a kernel
+ *
+ * A kernel the processor does not support gets the
+ * scalar kernel instead.
+ *
+ * @param kernel Kernel to get
+ * @return Function that blends a row of pixels
+ */
+BlendKernels::BlendRow BlendKernels::GetBlendRow(Kernel kernel)
+{
+    if (!IsSupported(kernel))
+    {
+        return BlendRowScalar;
+    }
+
+    switch (kernel)
+    {
+#ifdef CITY_BLEND_X86
+    case Kernel::SSE2:
+        return BlendRowSSE2;
+
+    case Kernel::AVX2:
+        return BlendRowAVX2;
+#endif
+
+    default:
+        return BlendRowScalar;
+    }
+}
+
+/**
+ * Get the fastest kernel the processor supports
+ * @return Kernel
+ */
+BlendKernels::Kernel BlendKernels::GetBestKernel()
+{
+    if (IsSupported(Kernel::AVX2))
+    {
+        return Kernel::AVX2;
+    }
+
+    if (IsSupported(Kernel::SSE2))
+    {
+        return Kernel::SSE2;
+    }
+
+    return Kernel::Scalar;
+}
+
+/**
+ * Get the name of a kernel for reports
+ * @param kernel Kernel
+ * @return Name
+ */
+const wchar_t *BlendKernels::GetKernelName(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case Kernel::SSE2:
+        return L"SSE2";
+
+    case Kernel::AVX2:
+        return L"AVX2";
+
+    default:
+        return L"Scalar";
+    }
+}
@@ -0,0 +1,42 @@
+/**
+ * @file BlendKernels.h
+ * @author timan
+ *
+ * Rows of premultiplied RGBA pixels blended over others
+ */
+
+#ifndef CITY_CITYLIB_BLENDKERNELS_H
+#define CITY_CITYLIB_BLENDKERNELS_H
+
+#include <cstdint>
+
+/**
+ * Rows of premultiplied RGBA pixels blended over others.
+ *
+ * Pixels are four bytes, red, green, blue and alpha, in that
+ * order in memory, with the colors already multiplied by alpha.
+ * Each destination channel becomes
+ *
+ *     src + dst * (255 - srcAlpha) / 255
+ *
+ * with the division rounded the same way by every kernel, so
+ * they all produce identical pixels. The SSE2 and AVX2 kernels
+ * are only used if the processor supports them.
+ */
+namespace BlendKernels
+{
+    /// A function that blends a row of pixels
+    typedef void (*BlendRow)(uint32_t *dst, const uint32_t *src, int count);
+
+    /// The kernels there are
+    enum class Kernel { Scalar, SSE2, AVX2 };
+
+    void BlendRowScalar(uint32_t *dst, const uint32_t *src, int count);
+
+    bool IsSupported(Kernel kernel);
+    BlendRow GetBlendRow(Kernel kernel);
+    Kernel GetBestKernel();
+    const wchar_t *GetKernelName(Kernel kernel);
+}
+
+#endif //CITY_CITYLIB_BLENDKERNELS_H
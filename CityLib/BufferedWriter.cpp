@@ -0,0 +1,162 @@
+/**
+ * @file BufferedWriter.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "BufferedWriter.h"
+
+/**
+ * Constructor
+ * @param bufferSize Size of the output buffer in bytes
+ */
+BufferedWriter::BufferedWriter(size_t bufferSize) : mBuffer(bufferSize)
+{
+}
+
+/**
+ * Destructor. Any buffered output is written.
+ */
+BufferedWriter::~BufferedWriter()
+{
+    Close();
+}
+
+/**
+ * Open a file for writing, replacing any existing file
+ * @param filename File to write
+ * @return true if the file was opened
+ */
+bool BufferedWriter::Open(const std::wstring &filename)
+{
+    Close();
+
+    mFile = wxFopen(filename, L"wb");
+    mFailed = mFile == nullptr;
+    return mFile != nullptr;
+}
+
+/**
+ * Write any buffered output and close the file
+ * @return true if everything was written successfully
+ */
+bool BufferedWriter::Close()
+{
+    if (mFile != nullptr)
+    {
+        Flush();
+        if (fclose(mFile) != 0)
+        {
+            mFailed = true;
+        }
+
+        mFile = nullptr;
+    }
+
+    return !mFailed;
+}
+
+/**
+ * Write the buffered output to the file
+ */
+void BufferedWriter::Flush()
+{
+    if (mFile != nullptr && mUsed > 0)
+    {
+        if (fwrite(mBuffer.data(), 1, mUsed, mFile) != mUsed)
+        {
+            mFailed = true;
+        }
+    }
+
+    mUsed = 0;
+}
+
+/**
+ * Write a block of bytes
+ * @param data Bytes to write
+ * @param size Number of bytes
+ */
+void BufferedWriter::Write(const char *data, size_t size)
+{
+    while (size > 0)
+    {
+        if (mUsed == mBuffer.size())
+        {
+            Flush();
+        }
+
+        size_t n = std::min(size, mBuffer.size() - mUsed);
+        memcpy(mBuffer.data() + mUsed, data, n);
+        mUsed += n;
+        data += n;
+        size -= n;
+    }
+}
+
+/**
+ * Write a null-terminated string
+ * @param str String to write
+ */
+void BufferedWriter::Write(const char *str)
+{
+    Write(str, strlen(str));
+}
+
+/**
+ * Write a wide string as UTF-8
+ * @param str String to write
+ */
+void BufferedWriter::Write(const std::wstring &str)
+{
+    for (wchar_t c : str)
+    {
+        Write(c);
+    }
+}
+
+/**
+ * Write a wide character as UTF-8
+ * @param wc Character to write
+ */
+void BufferedWriter::Write(wchar_t wc)
+{
+    auto c = (unsigned long)wc;
+    if (c < 0x80)
+    {
+        Write((char)c);
+    }
+    else if (c < 0x800)
+    {
+        Write((char)(0xc0 | (c >> 6)));
+        Write((char)(0x80 | (c & 0x3f)));
+    }
+    else if (c < 0x10000)
+    {
+        Write((char)(0xe0 | (c >> 12)));
+        Write((char)(0x80 | ((c >> 6) & 0x3f)));
+        Write((char)(0x80 | (c & 0x3f)));
+    }
+    else
+    {
+        Write((char)(0xf0 | (c >> 18)));
+        Write((char)(0x80 | ((c >> 12) & 0x3f)));
+        Write((char)(0x80 | ((c >> 6) & 0x3f)));
+        Write((char)(0x80 | (c & 0x3f)));
+    }
+}
+
+/**
+ * Write an integer in decimal
+ * @param value Value to write
+ */
+void BufferedWriter::Write(int value)
+{
+    char digits[16];
+    int len = snprintf(digits, sizeof(digits), "%d", value);
+    Write(digits, (size_t)len);
+}
@@ -0,0 +1,74 @@
+/**
+ * @file BufferedWriter.h
+ * @author timan
+ *
+ * A simple buffered file writer
+ */
+
+#ifndef CITY_CITYLIB_BUFFEREDWRITER_H
+#define CITY_CITYLIB_BUFFEREDWRITER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * A simple buffered file writer.
+ *
+ * Output is collected in a fixed size buffer and written
+ * to the file whenever the buffer fills, so the memory used
+ * does not depend on how much is written. Wide strings are
+ * written as UTF-8.
+ */
+class BufferedWriter
+{
+private:
+    /// The file we are writing to
+    FILE *mFile = nullptr;
+
+    /// The output buffer
+    std::vector<char> mBuffer;
+
+    /// Number of bytes of the buffer in use
+    size_t mUsed = 0;
+
+    /// Set if any write to the file failed
+    bool mFailed = false;
+
+public:
+    explicit BufferedWriter(size_t bufferSize = 64 * 1024);
+
+    /// Copy constructor (disabled)
+    BufferedWriter(const BufferedWriter &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const BufferedWriter &) = delete;
+
+    virtual ~BufferedWriter();
+
+    bool Open(const std::wstring &filename);
+    bool Close();
+    void Flush();
+
+    void Write(const char *data, size_t size);
+    void Write(const char *str);
+    void Write(const std::wstring &str);
+    void Write(wchar_t c);
+    void Write(int value);
+
+    /**
+     * Write a single character
+     * @param c Character to write
+     */
+    void Write(char c)
+    {
+        if (mUsed == mBuffer.size())
+        {
+            Flush();
+        }
+
+        mBuffer[mUsed++] = c;
+    }
+};
+
+#endif //CITY_CITYLIB_BUFFEREDWRITER_H
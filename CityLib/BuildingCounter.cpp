@@ -5,3 +5,21 @@
 
 #include "pch.h"
 #include "BuildingCounter.h"
+#include "City.h"
+
+/**
+ * Count the buildings with locations in a rectangle of the city.
+ *
+ * This uses the summed-area table kept by the city, so it
+ * takes the same time for any rectangle, and does not
+ * visit the tiles.
+ * @param city City to count the buildings of
+ * @param left Left side of the rectangle in pixels
+ * @param top Top of the rectangle in pixels
+ * @param right Right side of the rectangle in pixels, inclusive
+ * @param bottom Bottom of the rectangle in pixels, inclusive
+ */
+void BuildingCounter::CountRegion(City* city, int left, int top, int right, int bottom)
+{
+	mNumBuildings = city->GetSummedAreaTable().CountPixels(TileType::Building, left, top, right, bottom);
+}
@@ -11,6 +11,8 @@
 
 #include "TileVisitor.h"
 
+class City;
+
 /**
  * A class that gets the count for the number of buildings
  * subclass of TileVisitor
@@ -28,6 +30,8 @@ public:
 	 */
 	int GetNumBuildings() const { return mNumBuildings; }
 
+	void CountRegion(City* city, int left, int top, int right, int bottom);
+
 	/**
  	* Visit a TileBuilding object
  	* @param building Building we are visiting
@@ -37,6 +41,23 @@ public:
 		mNumBuildings++;
 	}
 
+	/**
+	 * Create a counter for a worker of a parallel traversal
+	 * @return New building counter
+	 */
+	std::unique_ptr<TileVisitor> Clone() const override
+	{
+		return std::make_unique<BuildingCounter>();
+	}
+
+	/**
+	 * Add the count from a worker counter to this one
+	 * @param other Worker counter
+	 */
+	void Reduce(TileVisitor* other) override
+	{
+		mNumBuildings += static_cast<BuildingCounter*>(other)->mNumBuildings;
+	}
 
 };
 
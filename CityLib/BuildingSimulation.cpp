@@ -0,0 +1,326 @@
+/**
+ * @file BuildingSimulation.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+
+#include <algorithm>
+
+#include "BuildingSimulation.h"
+#include "City.h"
+#include "WorkerPool.h"
+
+/// Time between ticks in seconds
+const double TickInterval = 0.5;
+
+/// People arriving per second in an empty home
+const float Immigration = 0.2f;
+
+/// Growth of the population of a home per person per second
+const float GrowthRate = 0.05f;
+
+/// Fraction of the population that works
+const float LaborShare = 0.6f;
+
+/// Taxes paid per worker per second
+const float TaxPerWorker = 0.1f;
+
+/// What each kind of building provides
+struct BuildingKind
+{
+    const wchar_t *mFile;   ///< Building image file
+    float mHousing;         ///< Number of people who can live there
+    float mJobs;            ///< Number of jobs
+    float mUpkeep;          ///< Upkeep per second
+};
+
+/// The kinds of building
+const BuildingKind BuildingKinds[] = {
+    {L"house.png", 4, 0, 0.1f},
+    {L"yellowhouse.png", 6, 0, 0.15f},
+    {L"condos.png", 24, 0, 0.5f},
+    {L"farm0.png", 2, 6, 0.2f},
+    {L"blacksmith.png", 0, 4, 0.2f},
+    {L"market.png", 0, 10, 0.4f},
+    {L"firestation.png", 0, 8, 1.5f},
+    {L"hospital.png", 0, 12, 2.0f},
+};
+
+/// Upkeep of a building of a kind not listed
+const float DefaultUpkeep = 0.1f;
+
+/**
+ * Sum a value over a range of items on the worker pool
+ * @param count Number of items
+ * @param sums Sum of each worker, kept by the caller so it is not allocated each time
+ * @param function Function returning the value for an item
+ * @return Sum
+ */
+template <typename Function>
+static float ParallelSum(int count, std::vector<double> &sums, Function function)
+{
+    auto &pool = WorkerPool::Get();
+    sums.assign(pool.GetNumWorkers(), 0);
+    pool.ParallelFor(count, [&sums, &function](int begin, int end, int worker) {
+        double sum = 0;
+        for (int i = begin; i < end; i++)
+        {
+            sum += function(i);
+        }
+
+        sums[worker] = sum;
+    });
+
+    double total = 0;
+    for (auto sum : sums)
+    {
+        total += sum;
+    }
+
+    return (float)total;
+}
+
+/**
+ * Constructor
+ * @param city The city we are simulating
+ */
+BuildingSimulation::BuildingSimulation(City *city) : mCity(city)
+{
+}
+
+/**
+ * Create the entity and components for a building
+ * @param tile Building tile
+ */
+void BuildingSimulation::AddBuilding(Tile *tile)
+{
+    Entity entity;
+    if (!mFreeEntities.empty())
+    {
+        entity = mFreeEntities.back();
+        mFreeEntities.pop_back();
+    }
+    else
+    {
+        entity = (Entity)mLocations.size();
+        mLocations.emplace_back();
+    }
+
+    mEntities[tile] = entity;
+    mLocations[entity] = std::make_pair(tile->GetX(), tile->GetY());
+
+    float upkeep = DefaultUpkeep;
+    for (auto &kind : BuildingKinds)
+    {
+        if (tile->GetFile() == kind.mFile)
+        {
+            if (kind.mHousing > 0)
+            {
+                mHousing.Add(entity, {kind.mHousing, 0, 0});
+            }
+
+            if (kind.mJobs > 0)
+            {
+                mJobs.Add(entity, {kind.mJobs, 0});
+            }
+
+            upkeep = kind.mUpkeep;
+            break;
+        }
+    }
+
+    mUpkeep.Add(entity, {upkeep});
+}
+
+/**
+ * Destroy the entity and components for a building
+ * @param tile Building tile
+ */
+void BuildingSimulation::RemoveBuilding(Tile *tile)
+{
+    auto found = mEntities.find(tile);
+    if (found == mEntities.end())
+    {
+        return;
+    }
+
+    Entity entity = found->second;
+    mEntities.erase(found);
+
+    mHousing.Remove(entity);
+    mJobs.Remove(entity);
+    mUpkeep.Remove(entity);
+    mFreeEntities.push_back(entity);
+}
+
+/**
+ * Create the entities for every building in the city
+ */
+void BuildingSimulation::Rebuild()
+{
+    CityCleared();
+    for (auto tile : *mCity)
+    {
+        if (tile->GetType() == TileType::Building)
+        {
+            AddBuilding(tile.get());
+        }
+    }
+}
+
+/**
+ * Handle updates for animation, running a tick
+ * each time enough time has passed
+ * @param elapsed The time since the last update in seconds
+ */
+void BuildingSimulation::Update(double elapsed)
+{
+    mTime += elapsed;
+    if (mTime >= TickInterval)
+    {
+        // A long pause is a single long tick
+        Tick((float)mTime);
+        mTime = 0;
+    }
+}
+
+/**
+ * Run every system once
+ * @param elapsed Time the tick covers in seconds
+ */
+void BuildingSimulation::Tick(float elapsed)
+{
+    LandValueSystem();
+    PopulationSystem(elapsed);
+    EmploymentSystem();
+    UpkeepSystem(elapsed);
+}
+
+/**
+ * Sample the land value at each home
+ */
+void BuildingSimulation::LandValueSystem()
+{
+    auto &landValue = mCity->GetLandValue();
+    Housing *housing = mHousing.Data();
+    const Entity *entities = mHousing.Entities();
+    const std::pair<int, int> *locations = mLocations.data();
+
+    WorkerPool::Get().ParallelFor(mHousing.Size(),
+            [&landValue, housing, entities, locations](int begin, int end, int worker) {
+        for (int i = begin; i < end; i++)
+        {
+            auto &location = locations[entities[i]];
+            housing[i].mLandValue = landValue.GetValue(location.first, location.second);
+        }
+    });
+}
+
+/**
+ * Grow the population of each home toward its capacity.
+ *
+ * People move in faster where land value is high and
+ * not at all where it is very low.
+ * @param elapsed Time the tick covers in seconds
+ */
+void BuildingSimulation::PopulationSystem(float elapsed)
+{
+    Housing *housing = mHousing.Data();
+    mTotals.mPopulation = ParallelSum(mHousing.Size(), mSums, [housing, elapsed](int i) {
+        Housing &home = housing[i];
+        float room = 1 - home.mPopulation / home.mCapacity;
+        float appeal = std::max(1 + home.mLandValue, 0.0f);
+        float growth = (Immigration + GrowthRate * home.mPopulation) * room * appeal * elapsed;
+        home.mPopulation = std::min(std::max(home.mPopulation + growth, 0.0f), home.mCapacity);
+        return home.mPopulation;
+    });
+}
+
+/**
+ * Fill the jobs from the working population.
+ *
+ * When there are more jobs than workers, every
+ * workplace fills the same fraction of its jobs.
+ */
+void BuildingSimulation::EmploymentSystem()
+{
+    Jobs *jobs = mJobs.Data();
+    mTotals.mJobs = ParallelSum(mJobs.Size(), mSums, [jobs](int i) { return jobs[i].mSlots; });
+
+    float workers = mTotals.mPopulation * LaborShare;
+    float fill = mTotals.mJobs > 0 ? std::min(workers / mTotals.mJobs, 1.0f) : 0;
+    mTotals.mEmployed = ParallelSum(mJobs.Size(), mSums, [jobs, fill](int i) {
+        jobs[i].mWorkers = jobs[i].mSlots * fill;
+        return jobs[i].mWorkers;
+    });
+}
+
+/**
+ * Charge the upkeep of every building and collect taxes from the workers
+ * @param elapsed Time the tick covers in seconds
+ */
+void BuildingSimulation::UpkeepSystem(float elapsed)
+{
+    Upkeep *upkeep = mUpkeep.Data();
+    mTotals.mUpkeep = ParallelSum(mUpkeep.Size(), mSums, [upkeep](int i) { return upkeep[i].mCost; });
+    mTotals.mFunds += (mTotals.mEmployed * TaxPerWorker - mTotals.mUpkeep) * elapsed;
+}
+
+/**
+ * A tile has been added to the city
+ * @param tile Tile that was added
+ */
+void BuildingSimulation::TileAdded(std::shared_ptr<Tile> tile)
+{
+    if (tile->GetType() == TileType::Building)
+    {
+        AddBuilding(tile.get());
+    }
+}
+
+/**
+ * A tile is being removed from the city
+ * @param tile Tile that is being removed
+ */
+void BuildingSimulation::TileRemoved(std::shared_ptr<Tile> tile)
+{
+    RemoveBuilding(tile.get());
+}
+
+/**
+ * A tile has moved
+ * @param tile Tile that moved
+ * @param oldX Previous X location of the tile
+ * @param oldY Previous Y location of the tile
+ */
+void BuildingSimulation::TileMoved(Tile *tile, int oldX, int oldY)
+{
+    auto found = mEntities.find(tile);
+    if (found != mEntities.end())
+    {
+        mLocations[found->second] = std::make_pair(tile->GetX(), tile->GetY());
+    }
+}
+
+/**
+ * The city has been cleared
+ */
+void BuildingSimulation::CityCleared()
+{
+    mEntities.clear();
+    mLocations.clear();
+    mFreeEntities.clear();
+    mHousing.Clear();
+    mJobs.Clear();
+    mUpkeep.Clear();
+    mTotals = Totals();
+}
+
+/**
+ * The city has been loaded
+ */
+void BuildingSimulation::CityLoaded()
+{
+    Rebuild();
+}
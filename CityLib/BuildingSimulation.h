@@ -0,0 +1,246 @@
+/**
+ * @file BuildingSimulation.h
+ * @author timan
+ *
+ * Simulation of the people, jobs and upkeep of the buildings in the city
+ */
+
+#ifndef CITY_CITYLIB_BUILDINGSIMULATION_H
+#define CITY_CITYLIB_BUILDINGSIMULATION_H
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "CityObserver.h"
+
+class City;
+
+/**
+ * Simulation of the people, jobs and upkeep of the buildings in the city.
+ *
+ * This is an entity-component-system layer under the tiles.
+ * Each building in the city is an entity. What a building
+ * does is given by the components it has: housing for the
+ * people who live there, jobs for the people who work there,
+ * and upkeep for what it costs to run. Each kind of component
+ * is kept in its own contiguous array, and each system is a
+ * pass over one or two of those arrays, split across the
+ * worker pool.
+ *
+ * The tiles remain how the city is edited. This layer follows
+ * the city as an observer and never touches the tiles while
+ * it runs.
+ */
+class BuildingSimulation : public CityObserver
+{
+public:
+    /// An entity identifier
+    typedef int Entity;
+
+    /// Housing component
+    struct Housing
+    {
+        float mCapacity;        ///< Most people who can live here
+        float mPopulation;      ///< People living here
+        float mLandValue;       ///< Land value at the building
+    };
+
+    /// Jobs component
+    struct Jobs
+    {
+        float mSlots;           ///< Number of jobs
+        float mWorkers;         ///< Number of jobs filled
+    };
+
+    /// Upkeep component
+    struct Upkeep
+    {
+        float mCost;            ///< Cost to run per second
+    };
+
+    /// Totals across the city
+    struct Totals
+    {
+        float mPopulation = 0;  ///< People living in the city
+        float mJobs = 0;        ///< Jobs in the city
+        float mEmployed = 0;    ///< Jobs filled
+        float mUpkeep = 0;      ///< Upkeep per second
+        float mFunds = 0;       ///< City funds
+    };
+
+    /**
+     * Dense storage for one kind of component.
+     *
+     * Components are packed at the front of an array with the
+     * entity that owns each one alongside, so systems walk
+     * memory in order. Removing a component moves the last
+     * one into its place.
+     */
+    template <typename T>
+    class Components
+    {
+    private:
+        /// The components, packed
+        std::vector<T> mData;
+
+        /// Entity owning each component
+        std::vector<Entity> mEntities;
+
+        /// Index of the component for each entity or -1
+        std::vector<int> mIndex;
+
+    public:
+        /**
+         * Give an entity a component
+         * @param entity Entity
+         * @param component Component to add
+         */
+        void Add(Entity entity, const T &component)
+        {
+            if ((int)mIndex.size() <= entity)
+            {
+                mIndex.resize(entity + 1, -1);
+            }
+
+            mIndex[entity] = (int)mData.size();
+            mData.push_back(component);
+            mEntities.push_back(entity);
+        }
+
+        /**
+         * Take a component away from an entity, if it has one
+         * @param entity Entity
+         */
+        void Remove(Entity entity)
+        {
+            if (entity >= (int)mIndex.size() || mIndex[entity] < 0)
+            {
+                return;
+            }
+
+            int index = mIndex[entity];
+            mData[index] = mData.back();
+            mEntities[index] = mEntities.back();
+            mIndex[mEntities[index]] = index;
+            mData.pop_back();
+            mEntities.pop_back();
+            mIndex[entity] = -1;
+        }
+
+        /**
+         * Get the component of an entity
+         * @param entity Entity
+         * @return Pointer to the component or nullptr if none
+         */
+        T *Get(Entity entity)
+        {
+            if (entity >= (int)mIndex.size() || mIndex[entity] < 0)
+            {
+                return nullptr;
+            }
+
+            return &mData[mIndex[entity]];
+        }
+
+        /**
+         * Remove every component
+         */
+        void Clear()
+        {
+            mData.clear();
+            mEntities.clear();
+            mIndex.clear();
+        }
+
+        /**
+         * Get the number of components
+         * @return Number of components
+         */
+        int Size() const { return (int)mData.size(); }
+
+        /**
+         * Get the packed components
+         * @return Pointer to the first component
+         */
+        T *Data() { return mData.data(); }
+
+        /**
+         * Get the entity owning each packed component
+         * @return Pointer to the first entity
+         */
+        const Entity *Entities() const { return mEntities.data(); }
+    };
+
+private:
+    void AddBuilding(Tile *tile);
+    void RemoveBuilding(Tile *tile);
+    void Rebuild();
+
+    void LandValueSystem();
+    void PopulationSystem(float elapsed);
+    void EmploymentSystem();
+    void UpkeepSystem(float elapsed);
+
+    /// The city we are simulating
+    City *mCity;
+
+    /// Entity for each building in the city
+    std::unordered_map<Tile *, Entity> mEntities;
+
+    /// Location of each entity in pixels, indexed by entity
+    std::vector<std::pair<int, int>> mLocations;
+
+    /// Entities no longer in use
+    std::vector<Entity> mFreeEntities;
+
+    /// Sum of each worker in the systems, kept between ticks
+    std::vector<double> mSums;
+
+    /// Housing components
+    Components<Housing> mHousing;
+
+    /// Jobs components
+    Components<Jobs> mJobs;
+
+    /// Upkeep components
+    Components<Upkeep> mUpkeep;
+
+    /// Totals from the last tick
+    Totals mTotals;
+
+    /// Time not yet used for ticks in seconds
+    double mTime = 0;
+
+public:
+    explicit BuildingSimulation(City *city);
+
+    /// Copy constructor (disabled)
+    BuildingSimulation(const BuildingSimulation &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const BuildingSimulation &) = delete;
+
+    void Update(double elapsed);
+    void Tick(float elapsed);
+
+    /**
+     * Get the totals across the city from the last tick
+     * @return Totals
+     */
+    const Totals &GetTotals() const { return mTotals; }
+
+    /**
+     * Get the number of buildings being simulated
+     * @return Number of buildings
+     */
+    int GetNumBuildings() const { return (int)mEntities.size(); }
+
+    void TileAdded(std::shared_ptr<Tile> tile) override;
+    void TileRemoved(std::shared_ptr<Tile> tile) override;
+    void TileMoved(Tile *tile, int oldX, int oldY) override;
+    void CityCleared() override;
+    void CityLoaded() override;
+};
+
+#endif //CITY_CITYLIB_BUILDINGSIMULATION_H
@@ -17,19 +17,62 @@
 
 #include "CityReport.h"
 #include "MemberReport.h"
+#include "CityObserver.h"
+#include "WorkerPool.h"
 
 
+/// Cities with fewer tiles than this are not worth
+/// splitting across worker threads
+const int ParallelAcceptMinimum = 4096;
+
 /// Directory containing the project images
 /// relative to the resources directory.
 const std::wstring ImagesDirectory = L"/images";
 
+/// Zoom level at and beyond which tiles are drawn as flat diamonds
+const int FlatZoomLevel = 3;
+
+/// Color of the flat diamond for each type of tile
+const unsigned char FlatColors[NumTileTypes][3] = {
+    {86, 150, 60},      // Landscape
+    {170, 120, 90},     // Building
+    {120, 190, 80},     // Garden
+    {60, 110, 200},     // Water
+    {150, 150, 150}};   // Starship pad
+
+/// Images of the tiles, packed into the sprite atlas at startup
+const std::vector<std::wstring> SpriteImages = {
+    L"grass.png", L"tallgrass.png", L"sparty.png", L"tree.png", L"tree2.png", L"tree3.png",
+    L"reshihi.png", L"farm0.png", L"blacksmith.png", L"house.png", L"yellowhouse.png",
+    L"firestation.png", L"hospital.png", L"market.png", L"condos.png",
+    L"garden.png", L"garden1.png", L"garden2.png", L"garden3.png", L"garden4.png",
+    L"water.png", L"pad.png", L"sparty-starship.png"};
+
 /**
  * Constructor
 */
-City::City()
+City::City() : mStatistics(this), mSpatialIndex(this), mSummedAreaTable(this),
+    mWaterBodies(this), mServiceCoverage(this), mLandValue(this),
+    mSimulation(this), mTraffic(this), mMips(&mAtlas), mWaterEdges(this)
 {
     // Default is the current directory (for testing)
     SetImagesDirectory(L".");
+
+    AddObserver(&mStatistics);
+    AddObserver(&mSpatialIndex);
+    AddObserver(&mSummedAreaTable);
+    AddObserver(&mWaterBodies);
+    AddObserver(&mServiceCoverage);
+    AddObserver(&mLandValue);
+    AddObserver(&mSimulation);
+    AddObserver(&mTraffic);
+    AddObserver(&mWaterEdges);
+
+    for (int type = 0; type < NumTileTypes; type++)
+    {
+        auto color = FlatColors[type];
+        mFlatBrushes[type] = wxBrush(wxColour(color[0], color[1], color[2]));
+    }
 }
 
 
@@ -43,16 +86,114 @@ void City::SetImagesDirectory(const std::wstring &dir) {
     mImagesDirectory = dir + ImagesDirectory;
 }
 
+/**
+ * Pack the images of all of the tiles into the sprite atlas.
+ *
+ * Tiles load their images into the atlas as needed anyway, but
+ * loading them all together up front packs them more tightly.
+ * Images are taken from the asset pack in the images directory
+ * when there is one, and only decoded from their files if not.
+ * @param useAssets Use the asset pack if there is one
+ */
+void City::LoadSprites(bool useAssets)
+{
+    if (mImagesEnabled)
+    {
+        mAssets.Close();
+        if (useAssets)
+        {
+            mAssets.Open(mImagesDirectory + L"/" + AssetPack::PackFile);
+        }
+
+        mAtlas.SetAssets(mAssets.IsOpen() ? &mAssets : nullptr, mImagesDirectory);
+        mAtlas.Preload(mImagesDirectory, SpriteImages);
+    }
+}
+
 
 /**
  * Draw the city
+ *
+ * Zoomed out, tiles are drawn with reduced copies of their
+ * sprites, and once those would be too small to make out,
+ * as diamonds colored by the type of tile.
  * @param graphics The GDI+ graphics context to draw on
+ * @param zoomLevel Zoom level, drawing at 1/2^zoomLevel of full size
  */
-void City::OnDraw(wxDC* graphics)
+void City::OnDraw(wxDC* graphics, int zoomLevel)
 {
-    for (auto item : mTiles)
+    if (zoomLevel >= FlatZoomLevel)
+    {
+        DrawFlat(graphics, zoomLevel);
+    }
+    else if (zoomLevel > 0)
+    {
+        for (auto &item : mTiles)
+        {
+            item->DrawZoomed(graphics, zoomLevel);
+        }
+    }
+    else
+    {
+        // Only what is on the device and not hidden behind later tiles
+        BuildDrawList(&mDrawList, wxRect(wxPoint(0, 0), graphics->GetSize()));
+        for (auto &item : mDrawList)
+        {
+            mAtlas.Draw(graphics, item.mSprite, item.mX, item.mY);
+        }
+    }
+}
+
+/**
+ * Collect the sprites the city draws at full size, back to
+ * front, in the order OnDraw draws them
+ *
+ * Sprites outside of the view or hidden behind sprites
+ * drawn after them are left out.
+ *
+ * @param list Draw list to fill
+ * @param view Area of the city being drawn
+ */
+void City::BuildDrawList(DrawList *list, const wxRect &view)
+{
+    list->Clear();
+    for (auto &item : mTiles)
+    {
+        item->AddToDrawList(list);
+    }
+
+    mCuller.Cull(list, mAtlas, view);
+}
+
+/**
+ * Draw every tile as a diamond colored by its type.
+ *
+ * The diamonds of each type are drawn together, so the
+ * brush is only changed once per type.
+ * @param graphics The graphics context to draw on
+ * @param zoomLevel Zoom level, drawing at 1/2^zoomLevel of full size
+ */
+void City::DrawFlat(wxDC *graphics, int zoomLevel)
+{
+    const int left = Tile::OffsetLeft >> zoomLevel;
+    const int down = Tile::OffsetDown >> zoomLevel;
+
+    graphics->SetPen(*wxTRANSPARENT_PEN);
+    for (int type = 0; type < NumTileTypes; type++)
     {
-        item->Draw(graphics);
+        graphics->SetBrush(mFlatBrushes[type]);
+
+        for (auto &item : mTiles)
+        {
+            if ((int)item->GetType() == type)
+            {
+                // Shifting rounds down, even for negative locations
+                int x = item->GetX() >> zoomLevel;
+                int y = item->GetY() >> zoomLevel;
+                wxPoint points[] = {{x - left, y}, {x, y - down}, {x + left, y}, {x, y + down}};
+                graphics->DrawPolygon(4, points);
+            }
+        }
     }
 }
 
@@ -64,27 +205,46 @@ void City::OnDraw(wxDC* graphics)
 void City::Add(std::shared_ptr<Tile> tile)
 {
     mTiles.push_back(tile);
+    tile->SetInCity(true);
+    tile->SetDrawOrder((int)mTiles.size() - 1);
+
+    if (!mLoading)
+    {
+        for (auto observer : mObservers)
+        {
+            observer->TileAdded(tile);
+        }
+    }
 }
 
 
 
 /**  Test an x,y click location to see if it clicked
 * on some item in the city.
+*
+* Only the tiles whose sprites cover the location are
+* tested, and the one drawn last wins, so the tile
+* clicked on is the one that is seen there.
+*
 * @param x X location
 * @param y Y location
 * @return Pointer to item we clicked on or nullptr if none.
 */
 std::shared_ptr<Tile> City::HitTest(int x, int y)
 {
-    for (auto i = mTiles.rbegin(); i != mTiles.rend(); i++)
+    mHitCandidates.clear();
+    mSpatialIndex.QuerySprites(x, y, x, y, mHitCandidates);
+
+    Tile *hit = nullptr;
+    for (auto tile : mHitCandidates)
     {
-        if ((*i)->HitTest(x, y))
+        if ((hit == nullptr || tile->GetDrawOrder() > hit->GetDrawOrder()) && tile->HitTest(x, y))
         {
-            return *i;
+            hit = tile;
         }
     }
 
-    return  nullptr;
+    return hit != nullptr ? mTiles[hit->GetDrawOrder()] : nullptr;
 }
 
 
@@ -97,12 +257,14 @@ std::shared_ptr<Tile> City::HitTest(int x, int y)
 void City::MoveToFront(std::shared_ptr<Tile> item)
 {
     auto loc = find(std::begin(mTiles), std::end(mTiles), item);
+    size_t first = loc - std::begin(mTiles);
     if (loc != std::end(mTiles))
     {
         mTiles.erase(loc);
     }
 
     mTiles.push_back(item);
+    NumberTiles(first);
 }
 
 
@@ -120,7 +282,16 @@ void City::DeleteItem(std::shared_ptr<Tile> item)
     auto loc = find(std::begin(mTiles), std::end(mTiles), item);
     if (loc != std::end(mTiles))
     {
+        for (auto observer : mObservers)
+        {
+            observer->TileRemoved(item);
+        }
+
+        size_t first = loc - std::begin(mTiles);
         mTiles.erase(loc);
+        item->SetInCity(false);
+        item->SetDrawOrder(-1);
+        NumberTiles(first);
     }
 }
 
@@ -130,6 +301,13 @@ void City::DeleteItem(std::shared_ptr<Tile> item)
 */
 void City::Update(double elapsed)
 {
+    // Edits since the last update are counted from here on
+    mSummedAreaTable.Flush();
+
+    mLandValue.Update(elapsed);
+    mSimulation.Update(elapsed);
+    mTraffic.Update(elapsed);
+
     for (auto item : mTiles)
     {
         item->Update(elapsed);
@@ -169,21 +347,26 @@ void City::Save(const wxString &filename)
 /**  Load the city from a .city XML file.
 *
 * Opens the XML file and reads the nodes, creating items as appropriate.
+* Nothing is shown to the user, so the caller reports any failure.
 *
 * @param filename The filename of the file to load the city from.
+* @return false if the file could not be loaded, leaving the city unchanged
 */
-void City::Load(const wxString &filename)
+bool City::Load(const wxString &filename)
 {
     wxXmlDocument xmlDoc;
     if(!xmlDoc.Load(filename))
     {
-        wxMessageBox(L"Unable to load City file");
-        return;
+        return false;
     }
 
     // Once we know it is open, clear the existing data
     Clear();
 
+    // Observers rebuild once when the load is complete
+    // rather than being told about every tile.
+    mLoading = true;
+
     // Get the XML document root node
     auto root = xmlDoc.GetRoot();
 
@@ -204,6 +387,14 @@ void City::Load(const wxString &filename)
     // All loaded, ensure all sorted
     //
     SortTiles();
+
+    mLoading = false;
+    for (auto observer : mObservers)
+    {
+        observer->CityLoaded();
+    }
+
+    return true;
 }
 
 
@@ -256,7 +447,18 @@ void City::XmlTile(wxXmlNode* node)
 */
 void City::Clear()
 {
+    for (auto &tile : mTiles)
+    {
+        tile->SetInCity(false);
+        tile->SetDrawOrder(-1);
+    }
+
     mTiles.clear();
+
+    for (auto observer : mObservers)
+    {
+        observer->CityCleared();
+    }
 }
 
 
@@ -283,9 +485,23 @@ void City::SortTiles()
         return a->GetX() > b->GetX();
     });
 
+    NumberTiles(0);
     BuildAdjacencies();
 }
 
+/**
+ * Record the draw order of tiles after they have been
+ * reordered or some have been removed
+ * @param first Index of the first tile whose position may have changed
+ */
+void City::NumberTiles(size_t first)
+{
+    for (size_t i = first; i < mTiles.size(); i++)
+    {
+        mTiles[i]->SetDrawOrder((int)i);
+    }
+}
+
 
 /**
  *  Build support for fast adjacency testing.
@@ -360,20 +576,63 @@ std::shared_ptr<Tile> City::GetAdjacent(Tile *tile, int dx, int dy)
 
 /**
 *  Generate a report for the city.
+*
+*  The report is created the first time it is requested and is then
+*  kept up to date as tiles are added, removed or moved, so asking
+*  for it again when nothing has changed costs nothing.
 *  @return Generated report of type CityReport
 */
 std::shared_ptr<CityReport> City::GenerateCityReport()
 {
-    auto report = std::make_shared<CityReport>(this);
+    if (mReport == nullptr)
+    {
+        mReport = std::make_shared<CityReport>(this);
+        mReport->Rebuild();
+        AddObserver(mReport.get());
+    }
 
-    for (auto item : mTiles)
+    return mReport;
+}
+
+/**
+ * Add an observer that is told about changes to the city
+ * @param observer Observer to add
+ */
+void City::AddObserver(CityObserver *observer)
+{
+    mObservers.push_back(observer);
+}
+
+/**
+ * Remove a previously added observer
+ * @param observer Observer to remove
+ */
+void City::RemoveObserver(CityObserver *observer)
+{
+    auto loc = find(std::begin(mObservers), std::end(mObservers), observer);
+    if (loc != std::end(mObservers))
     {
-        auto memberReport = std::make_shared<MemberReport>(item);
-        item->Report(memberReport);
-        report->Add(memberReport);
+        mObservers.erase(loc);
     }
+}
 
-    return report;
+/**
+ * Called by a tile in the city when it changes location.
+ * @param tile Tile that moved
+ * @param oldX Previous X location of the tile
+ * @param oldY Previous Y location of the tile
+ */
+void City::TileMoved(Tile *tile, int oldX, int oldY)
+{
+    if (mLoading)
+    {
+        return;
+    }
+
+    for (auto observer : mObservers)
+    {
+        observer->TileMoved(tile, oldX, oldY);
+    }
 }
 
 /**
@@ -387,3 +646,44 @@ void City::Accept(TileVisitor* visitor)
 		tile->Accept(visitor);
 	}
 }
+
+/**
+ * Accept a visitor for the collection, splitting the tiles
+ * across the worker pool.
+ *
+ * Each worker visits a contiguous range of tiles with its own
+ * clone of the visitor, and the clones are then reduced into
+ * the visitor in tile order. Visitors that cannot be cloned,
+ * and small cities, are visited on the calling thread.
+ * @param visitor The visitor for the collection
+ */
+void City::ParallelAccept(TileVisitor* visitor)
+{
+	auto &pool = WorkerPool::Get();
+	auto first = visitor->Clone();
+	if (first == nullptr || pool.GetNumWorkers() <= 1 || (int)mTiles.size() < ParallelAcceptMinimum)
+	{
+		Accept(visitor);
+		return;
+	}
+
+	std::vector<std::unique_ptr<TileVisitor>> workers;
+	workers.push_back(std::move(first));
+	for (int i = 1; i < pool.GetNumWorkers(); i++)
+	{
+		workers.push_back(visitor->Clone());
+	}
+
+	pool.ParallelFor((int)mTiles.size(), [this, &workers](int begin, int end, int worker) {
+		auto workerVisitor = workers[worker].get();
+		for (int i = begin; i < end; i++)
+		{
+			mTiles[i]->Accept(workerVisitor);
+		}
+	});
+
+	for (auto &workerVisitor : workers)
+	{
+		visitor->Reduce(workerVisitor.get());
+	}
+}
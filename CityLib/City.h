@@ -15,8 +15,24 @@
 #include <string>
 
 #include "Tile.h"
+#include "GridCell.h"
+#include "CityStatistics.h"
+#include "SpatialIndex.h"
+#include "SummedAreaTable.h"
+#include "WaterBodies.h"
+#include "ServiceCoverage.h"
+#include "LandValue.h"
+#include "BuildingSimulation.h"
+#include "TrafficSimulation.h"
+#include "WaterEdges.h"
+#include "SpriteAtlas.h"
+#include "AssetPack.h"
+#include "SpriteMips.h"
+#include "DrawList.h"
+#include "OcclusionCuller.h"
 
 class CityReport;
+class CityObserver;
 class TileVisitor;
 
 /**
@@ -27,6 +43,8 @@ class City
 private:
     void XmlTile(wxXmlNode *node);
     void BuildAdjacencies();
+    void NumberTiles(size_t first);
+    void DrawFlat(wxDC *graphics, int zoomLevel);
 
     /// All of the tiles that make up our city
     std::vector<std::shared_ptr<Tile> > mTiles;
@@ -37,6 +55,66 @@ private:
     /// Directory containing the system images
     std::wstring mImagesDirectory;
 
+    /// Are tile images loaded? Disabled for headless tools.
+    bool mImagesEnabled = true;
+
+    /// Objects that are told when tiles are added, removed or moved
+    std::vector<CityObserver *> mObservers;
+
+    /// True while loading, when per-tile notifications are suppressed
+    bool mLoading = false;
+
+    /// The city report, created on first use and kept up to date
+    std::shared_ptr<CityReport> mReport;
+
+    /// Live counts of the tiles in the city
+    CityStatistics mStatistics;
+
+    /// Index of the tile locations
+    SpatialIndex mSpatialIndex;
+
+    /// Per-type tile counts over grid regions
+    SummedAreaTable mSummedAreaTable;
+
+    /// Connected bodies of water
+    WaterBodies mWaterBodies;
+
+    /// Distances to the nearest fire station and hospital
+    ServiceCoverage mServiceCoverage;
+
+    /// Land value across the city
+    LandValue mLandValue;
+
+    /// Simulation of the people, jobs and upkeep of the buildings
+    BuildingSimulation mSimulation;
+
+    /// People travelling between the buildings
+    TrafficSimulation mTraffic;
+
+    /// Images decoded ahead of time
+    AssetPack mAssets;
+
+    /// Sprites of all of the tiles, packed together
+    SpriteAtlas mAtlas;
+
+    /// Reduced copies of the sprites for zoomed out drawing
+    SpriteMips mMips;
+
+    /// Shoreline sprites for the water tiles
+    WaterEdges mWaterEdges;
+
+    /// Tiles found under the mouse, kept from test to test
+    std::vector<Tile *> mHitCandidates;
+
+    /// Sprites drawn at full size, kept from frame to frame
+    DrawList mDrawList;
+
+    /// Removes the sprites that are hidden from the draw list
+    OcclusionCuller mCuller;
+
+    /// Brush for the flat diamonds of each type of tile
+    wxBrush mFlatBrushes[NumTileTypes];
+
 public:
     City();
 
@@ -48,6 +126,20 @@ public:
     /// The spacing between grid locations
     static const int GridSpacing = 32;
 
+    /**
+     * Get the grid location of a tile location as a key.
+     *
+     * This divides the same way GetAdjacent does, so the
+     * GridCell neighbors are the ones it would return.
+     * @param x X location in pixels
+     * @param y Y location in pixels
+     * @return Grid location key
+     */
+    static GridCell::Key GetGridCell(int x, int y)
+    {
+        return GridCell::Make(x / GridSpacing, y / GridSpacing);
+    }
+
     /**
      * Get the directory the images are stored in
      * @return Images directory path
@@ -56,15 +148,30 @@ public:
 
     void SetImagesDirectory(const std::wstring &dir);
 
+    /**
+     * Are tile images loaded when tiles set their image?
+     * @return true if images are loaded
+     */
+    bool AreImagesEnabled() const { return mImagesEnabled; }
+
+    /**
+     * Set whether tile images are loaded. When disabled, tiles
+     * still record their image file names but nothing is decoded,
+     * which lets tools work on cities without a display.
+     * @param enabled true to load images
+     */
+    void SetImagesEnabled(bool enabled) { mImagesEnabled = enabled; }
+
     void Add(std::shared_ptr<Tile> item);
     std::shared_ptr<Tile> HitTest(int x, int y);
     void MoveToFront(std::shared_ptr<Tile> item);
     void DeleteItem(std::shared_ptr<Tile> item);
 
-    void OnDraw(wxDC *graphics);
+    void OnDraw(wxDC *graphics, int zoomLevel = 0);
+    void BuildDrawList(DrawList *list, const wxRect &view);
 
     void Save(const wxString &filename);
-    void Load(const wxString &filename);
+    bool Load(const wxString &filename);
     void Clear();
 
     void Update(double elapsed);
@@ -75,7 +182,101 @@ public:
 
     std::shared_ptr<CityReport> GenerateCityReport();
 
+    /**
+     * Get the live counts of the tiles in the city
+     * @return City statistics
+     */
+    const CityStatistics &GetStatistics() const { return mStatistics; }
+
+    /**
+     * Get the index of the tile locations, for region queries
+     * @return Spatial index
+     */
+    const SpatialIndex &GetSpatialIndex() const { return mSpatialIndex; }
+
+    /**
+     * Get the per-type tile counts over grid regions
+     * @return Summed-area table
+     */
+    const SummedAreaTable &GetSummedAreaTable() const { return mSummedAreaTable; }
+
+    /**
+     * Get the connected bodies of water in the city
+     * @return Water bodies
+     */
+    const WaterBodies &GetWaterBodies() const { return mWaterBodies; }
+
+    /**
+     * Get the distances to the nearest fire station and hospital
+     * @return Service coverage
+     */
+    ServiceCoverage &GetServiceCoverage() { return mServiceCoverage; }
+
+    /**
+     * Get the land value across the city
+     * @return Land value
+     */
+    LandValue &GetLandValue() { return mLandValue; }
+
+    /**
+     * Get the simulation of the people, jobs and upkeep of the buildings
+     * @return Building simulation
+     */
+    BuildingSimulation &GetSimulation() { return mSimulation; }
+
+    /**
+     * Get the people travelling between the buildings
+     * @return Traffic simulation
+     */
+    TrafficSimulation &GetTraffic() { return mTraffic; }
+
+    /**
+     * Get the shoreline sprites for the water tiles
+     * @return Water edges
+     */
+    WaterEdges &GetWaterEdges() { return mWaterEdges; }
+
+    /**
+     * Get the atlas the sprites of the tiles are drawn from
+     * @return Sprite atlas
+     */
+    SpriteAtlas &GetAtlas() { return mAtlas; }
+
+    /**
+     * Get the images decoded ahead of time
+     * @return Asset pack, which may not be open
+     */
+    const AssetPack &GetAssets() const { return mAssets; }
+
+    void LoadSprites(bool useAssets = true);
+
+    /**
+     * Get the reduced copies of the sprites for zoomed out drawing
+     * @return Sprite mips
+     */
+    SpriteMips &GetMips() { return mMips; }
+
+    /**
+     * Get the culler that removes hidden sprites when drawing at full size
+     * @return Occlusion culler
+     */
+    OcclusionCuller &GetCuller() { return mCuller; }
+
+    void AddObserver(CityObserver *observer);
+    void RemoveObserver(CityObserver *observer);
+    void TileMoved(Tile *tile, int oldX, int oldY);
+
 	void Accept(TileVisitor* visitor);
+	void ParallelAccept(TileVisitor* visitor);
+
+	/**
+	 * Visit every tile with a callable, dispatched on the
+	 * tile type tag without virtual calls.
+	 * Defined in CityVisit.h, which must be included to use it.
+	 * @param callable Callable overloaded for each tile class
+	 */
+	template <class Callable>
+	void Visit(Callable &&callable);
 
 
 	/** Iterator that iterates over the city tiles */
@@ -102,7 +303,7 @@ public:
 		 * Get value at current position
 		 * @return Value at mPos in the collection
 		 */
-		std::shared_ptr<Tile> operator *() const { return mCity->mTiles[mPos]; }
+		const std::shared_ptr<Tile> &operator *() const { return mCity->mTiles[mPos]; }
 
 		/**
 		 * Increment the iterator
@@ -0,0 +1,8 @@
+/**
+ * @file CityObserver.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+
+#include "CityObserver.h"
@@ -0,0 +1,68 @@
+/**
+ * @file CityObserver.h
+ * @author timan
+ *
+ * Base class for objects that track changes to the city
+ */
+
+#ifndef CITY_CITYLIB_CITYOBSERVER_H
+#define CITY_CITYLIB_CITYOBSERVER_H
+
+#include <memory>
+
+class Tile;
+
+/**
+ * Base class for objects that track changes to the city.
+ *
+ * Observers are registered with City::AddObserver and are told
+ * about every tile that joins, leaves or moves within the city,
+ * so they can keep derived data up to date incrementally instead
+ * of walking the whole city.
+ */
+class CityObserver
+{
+protected:
+	/**
+	 * Constructor
+	 * Ensures this is an abstract class
+	 */
+	CityObserver() {}
+
+public:
+	virtual ~CityObserver() {}
+
+	/**
+	 * A tile has been added to the city
+	 * @param tile Tile that was added
+	 */
+	virtual void TileAdded(std::shared_ptr<Tile> tile) {}
+
+	/**
+	 * A tile is being removed from the city
+	 * @param tile Tile that is being removed
+	 */
+	virtual void TileRemoved(std::shared_ptr<Tile> tile) {}
+
+	/**
+	 * A tile in the city has changed location
+	 * @param tile Tile that moved (already at its new location)
+	 * @param oldX Previous X location of the tile
+	 * @param oldY Previous Y location of the tile
+	 */
+	virtual void TileMoved(Tile* tile, int oldX, int oldY) {}
+
+	/**
+	 * All tiles have been removed from the city
+	 */
+	virtual void CityCleared() {}
+
+	/**
+	 * The city has been loaded from a file. Tiles added during
+	 * a load are not reported one at a time, so observers should
+	 * rebuild from the city contents here.
+	 */
+	virtual void CityLoaded() {}
+};
+
+#endif //CITY_CITYLIB_CITYOBSERVER_H
@@ -0,0 +1,150 @@
+/**
+ * @file CityOverlays.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "CityOverlays.h"
+#include "City.h"
+
+/// Distance at which the coverage overlay is fully red
+const int CoverageRange = 12;
+
+/// Land value at which the land value overlay is fully saturated
+const float LandValueRange = 1.0f;
+
+/**
+ * Constructor
+ * @param city The city we are drawing over
+ */
+CityOverlays::CityOverlays(City *city) : mCity(city)
+{
+    // The overlay brushes are made once, not for each tile of each frame
+    for (int distance = 0; distance <= CoverageRange; distance++)
+    {
+        int red = 255 * distance / CoverageRange;
+        mCoverageBrushes.emplace_back(wxColour(red, 255 - red, 0));
+    }
+
+    for (int level = 0; level <= 255; level++)
+    {
+        mHighValueBrushes.emplace_back(wxColour(255 - level, 255, 255 - level));
+        mLowValueBrushes.emplace_back(wxColour(255, 255 - level, 255));
+    }
+}
+
+/**
+ * Find the tiles that are at least partly in the window
+ * @param visible Area of the city in the window
+ */
+void CityOverlays::FindVisibleTiles(const wxRect &visible)
+{
+    mVisibleTiles.clear();
+    mCity->GetSpatialIndex().QueryRect(visible.GetLeft() - Tile::OffsetLeft, visible.GetTop() - Tile::OffsetDown,
+                                       visible.GetRight() + Tile::OffsetLeft, visible.GetBottom() + Tile::OffsetDown,
+                                       mVisibleTiles);
+}
+
+/**
+ * Draw outlines around each of the on-screen tiles
+ *
+ * The outlines are drawn as one set of polygons
+ * with one pen, rather than tile by tile.
+ *
+ * @param dc Device context to draw on
+ * @param visible Area of the city in the window
+ */
+void CityOverlays::DrawOutlines(wxDC *dc, const wxRect &visible)
+{
+    FindVisibleTiles(visible);
+    if (mVisibleTiles.empty())
+    {
+        return;
+    }
+
+    mOutlinePoints.clear();
+    for (auto tile : mVisibleTiles)
+    {
+        int x = tile->GetX();
+        int y = tile->GetY();
+        mOutlinePoints.emplace_back(x - Tile::OffsetLeft, y);
+        mOutlinePoints.emplace_back(x, y - Tile::OffsetDown);
+        mOutlinePoints.emplace_back(x + Tile::OffsetLeft, y);
+        mOutlinePoints.emplace_back(x, y + Tile::OffsetDown);
+    }
+
+    mOutlineCounts.assign(mVisibleTiles.size(), 4);
+
+    dc->SetPen(mOutlinePen);
+    dc->SetBrush(*wxTRANSPARENT_BRUSH);
+    dc->DrawPolyPolygon((int)mOutlineCounts.size(), mOutlineCounts.data(), mOutlinePoints.data());
+}
+
+/**
+ * Draw the land value overlay.
+ *
+ * Each tile gets a diamond shaded toward green where
+ * land value is high and toward purple where it is low.
+ * @param dc Device context to draw on
+ * @param visible Area of the city in the window
+ */
+void CityOverlays::DrawLandValue(wxDC *dc, const wxRect &visible)
+{
+    auto &landValue = mCity->GetLandValue();
+
+    FindVisibleTiles(visible);
+    dc->SetPen(*wxTRANSPARENT_PEN);
+    for (auto tile : mVisibleTiles)
+    {
+        float value = landValue.GetValue(tile->GetX(), tile->GetY());
+        int level = (int)(255 * std::min(std::abs(value) / LandValueRange, 1.0f));
+        dc->SetBrush(value >= 0 ? mHighValueBrushes[level] : mLowValueBrushes[level]);
+
+        int x = tile->GetX();
+        int y = tile->GetY();
+        wxPoint points[] = {{x - Tile::OffsetLeft / 2, y}, {x, y - Tile::OffsetDown / 2},
+                            {x + Tile::OffsetLeft / 2, y}, {x, y + Tile::OffsetDown / 2}};
+        dc->DrawPolygon(4, points);
+    }
+}
+
+/**
+ * Draw the service coverage overlay.
+ *
+ * Each tile gets a diamond colored from green next to the
+ * service to red at CoverageRange steps or more. Tiles the
+ * service cannot reach are left uncolored.
+ * @param dc Device context to draw on
+ * @param service Service to show
+ * @param visible Area of the city in the window
+ */
+void CityOverlays::DrawCoverage(wxDC *dc, ServiceCoverage::Service service, const wxRect &visible)
+{
+    // One snapshot for the whole frame, so the coverage
+    // thread is not held up once for every tile
+    auto coverage = mCity->GetServiceCoverage().GetSnapshot();
+
+    FindVisibleTiles(visible);
+    dc->SetPen(*wxTRANSPARENT_PEN);
+    for (auto tile : mVisibleTiles)
+    {
+        int distance = coverage->GetDistance(service, tile->GetX(), tile->GetY());
+        if (distance == ServiceCoverage::Unreachable)
+        {
+            continue;
+        }
+
+        dc->SetBrush(mCoverageBrushes[std::min(distance, CoverageRange)]);
+
+        // Half the size of the tile, so the tile still shows
+        int x = tile->GetX();
+        int y = tile->GetY();
+        wxPoint points[] = {{x - Tile::OffsetLeft / 2, y}, {x, y - Tile::OffsetDown / 2},
+                            {x + Tile::OffsetLeft / 2, y}, {x, y + Tile::OffsetDown / 2}};
+        dc->DrawPolygon(4, points);
+    }
+}
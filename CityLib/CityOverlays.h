@@ -0,0 +1,59 @@
+/**
+ * @file CityOverlays.h
+ * @author timan
+ *
+ * Overlays drawn over the city: tile outlines,
+ * land value and service coverage
+ */
+
+#ifndef CITY_CITYLIB_CITYOVERLAYS_H
+#define CITY_CITYLIB_CITYOVERLAYS_H
+
+#include <vector>
+
+#include "ServiceCoverage.h"
+
+class City;
+class Tile;
+
+/**
+ * Overlays drawn over the city: tile outlines,
+ * land value and service coverage.
+ *
+ * The overlays are drawn in city coordinates. The pens and
+ * brushes are made once and the outline arrays keep their
+ * memory from frame to frame, so drawing an overlay makes
+ * no heap allocations of its own.
+ */
+class CityOverlays
+{
+private:
+    /// The city we are drawing over
+    City *mCity;
+
+    wxPen mOutlinePen{wxColour(0, 255, 0), 2};  ///< Pen the outlines are drawn with
+    std::vector<Tile *> mVisibleTiles;          ///< Tiles in the window in the last overlay drawn
+    std::vector<wxPoint> mOutlinePoints;        ///< Corners of the outlines, four per tile
+    std::vector<int> mOutlineCounts;            ///< Number of corners of each outline
+    std::vector<wxBrush> mCoverageBrushes;      ///< Coverage overlay brush for each distance
+    std::vector<wxBrush> mHighValueBrushes;     ///< Land value overlay brush for each level above zero
+    std::vector<wxBrush> mLowValueBrushes;      ///< Land value overlay brush for each level below zero
+
+public:
+    explicit CityOverlays(City *city);
+
+    /// Copy constructor (disabled)
+    CityOverlays(const CityOverlays &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const CityOverlays &) = delete;
+
+    void DrawOutlines(wxDC *dc, const wxRect &visible);
+    void DrawLandValue(wxDC *dc, const wxRect &visible);
+    void DrawCoverage(wxDC *dc, ServiceCoverage::Service service, const wxRect &visible);
+
+private:
+    void FindVisibleTiles(const wxRect &visible);
+};
+
+#endif //CITY_CITYLIB_CITYOVERLAYS_H
@@ -6,6 +6,8 @@
 
 #include "pch.h"
 #include "CityReport.h"
+#include "MemberReport.h"
+#include "City.h"
 
 /**
  * Constructor
@@ -31,6 +33,107 @@ void CityReport::Add(std::shared_ptr<MemberReport> report)
 
     // Add the report to the last bin
     mReportBins.back()->Add(report);
+    mRevision++;
+}
+
+/**
+ * Remove a report from the city report
+ *
+ * Any bin left empty is removed from the list so the
+ * iterator never lands on an empty bin.
+ * @param report Report to remove
+ */
+void CityReport::Remove(std::shared_ptr<MemberReport> report)
+{
+    for (auto bin = mReportBins.begin(); bin != mReportBins.end(); bin++)
+    {
+        if ((*bin)->Remove(report))
+        {
+            mRevision++;
+
+            if ((*bin)->mReports[0] == nullptr)
+            {
+                mReportBins.erase(bin);
+            }
+
+            return;
+        }
+    }
+}
+
+/**
+ * Rebuild the report from the current contents of the city.
+ */
+void CityReport::Rebuild()
+{
+    mReportBins.clear();
+    mMembers.clear();
+    mRevision++;
+
+    for (auto tile : *mCity)
+    {
+        TileAdded(tile);
+    }
+}
+
+/**
+ * A tile has been added to the city, so add a report for it
+ * @param tile Tile that was added
+ */
+void CityReport::TileAdded(std::shared_ptr<Tile> tile)
+{
+    auto memberReport = std::make_shared<MemberReport>(tile);
+    tile->Report(memberReport);
+    mMembers[tile.get()] = memberReport;
+    Add(memberReport);
+}
+
+/**
+ * A tile is leaving the city, so remove its report
+ * @param tile Tile that is being removed
+ */
+void CityReport::TileRemoved(std::shared_ptr<Tile> tile)
+{
+    auto member = mMembers.find(tile.get());
+    if (member != mMembers.end())
+    {
+        Remove(member->second);
+        mMembers.erase(member);
+    }
+}
+
+/**
+ * A tile has moved, so its report line is out of date
+ * @param tile Tile that moved
+ * @param oldX Previous X location of the tile
+ * @param oldY Previous Y location of the tile
+ */
+void CityReport::TileMoved(Tile* tile, int oldX, int oldY)
+{
+    auto member = mMembers.find(tile);
+    if (member != mMembers.end())
+    {
+        member->second->Invalidate();
+        mRevision++;
+    }
+}
+
+/**
+ * The city has been cleared, so clear the report
+ */
+void CityReport::CityCleared()
+{
+    mReportBins.clear();
+    mMembers.clear();
+    mRevision++;
+}
+
+/**
+ * The city has been loaded, so build the report from scratch
+ */
+void CityReport::CityLoaded()
+{
+    Rebuild();
 }
 
 /**
@@ -74,3 +177,33 @@ void CityReport::ReportsBin::Add(std::shared_ptr<MemberReport> report)
         }
     }
 }
+
+/**
+ * Remove a report from this bin, moving the reports after
+ * it down so the array remains null-terminated.
+ * @param report Report to remove
+ * @return true if the report was in this bin
+ */
+bool CityReport::ReportsBin::Remove(std::shared_ptr<MemberReport> report)
+{
+    for(int i=0; i<BinSize; i++)
+    {
+        if(mReports[i] == nullptr)
+        {
+            return false;
+        }
+
+        if(mReports[i] == report)
+        {
+            for(int j=i; j<BinSize; j++)
+            {
+                mReports[j] = mReports[j+1];
+            }
+
+            mReports[BinSize] = nullptr;
+            return true;
+        }
+    }
+
+    return false;
+}
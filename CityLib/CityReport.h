@@ -13,7 +13,9 @@
 #include <vector>
 #include <random>
 #include <list>
+#include <unordered_map>
 #include "Tile.h"
+#include "CityObserver.h"
 
 class City;
 class MemberReport;
@@ -21,13 +23,22 @@ class MemberReport;
 /**
  * The city report is generated by the members of the city.
  * It is a collection of objects of type MemberReport.
+ *
+ * The report observes the city, so once built it is patched
+ * as tiles are added, removed or moved rather than regenerated.
 */
-class CityReport
+class CityReport : public CityObserver
 {
 private:
     /// The city this report is for
     City* mCity;
 
+    /// The member report for each tile in the report
+    std::unordered_map<Tile*, std::shared_ptr<MemberReport>> mMembers;
+
+    /// Incremented whenever the report changes
+    int mRevision = 0;
+
 protected:
     /// Size of the bins in the linked list
     static const int BinSize = 7;
@@ -43,6 +54,7 @@ protected:
 
         bool IsFull();
         void Add(std::shared_ptr<MemberReport> report);
+        bool Remove(std::shared_ptr<MemberReport> report);
     };
 
     /// The collection of reports
@@ -52,6 +64,28 @@ public:
     explicit CityReport(City* city);
 
     void Add(std::shared_ptr<MemberReport> report);
+    void Remove(std::shared_ptr<MemberReport> report);
+    void Rebuild();
+
+    /**
+     * Get the report revision. This changes whenever a report
+     * is added, removed or changed, so views of the report
+     * can tell when they are out of date.
+     * @return Revision number
+     */
+    int GetRevision() const { return mRevision; }
+
+    /**
+     * Get the number of member reports in the report
+     * @return Number of member reports
+     */
+    int GetNumReports() const { return (int)mMembers.size(); }
+
+    void TileAdded(std::shared_ptr<Tile> tile) override;
+    void TileRemoved(std::shared_ptr<Tile> tile) override;
+    void TileMoved(Tile* tile, int oldX, int oldY) override;
+    void CityCleared() override;
+    void CityLoaded() override;
 
 	/** Iterator that iterates over the city report */
 	class Iter
@@ -0,0 +1,179 @@
+/**
+ * @file CityStatistics.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+
+#include "CityStatistics.h"
+#include "City.h"
+#include "Tile.h"
+
+/**
+ * Constructor
+ * @param city The city we are counting
+ */
+CityStatistics::CityStatistics(City *city) : mCity(city)
+{
+}
+
+/**
+ * Determine the region a location is in
+ * @param x X location in pixels
+ * @param y Y location in pixels
+ * @return Region as a (column, row) pair
+ */
+CityStatistics::Region CityStatistics::GetRegion(int x, int y)
+{
+    const int size = City::GridSpacing * RegionSize;
+
+    // Round toward negative infinity so regions
+    // are the same size on both sides of zero
+    int col = x >= 0 ? x / size : (x - size + 1) / size;
+    int row = y >= 0 ? y / size : (y - size + 1) / size;
+    return Region(col, row);
+}
+
+/**
+ * Add a tile to the counts
+ * @param tile Tile to count
+ */
+void CityStatistics::Count(Tile *tile)
+{
+    Counted counted;
+    counted.mType = tile->GetType();
+    counted.mRegion = GetRegion(tile->GetX(), tile->GetY());
+
+    mTypeCounts[(int)counted.mType]++;
+    auto region = mRegionCounts.try_emplace(counted.mRegion);
+    region.first->second[(int)counted.mType]++;
+    if (region.second)
+    {
+        mGroupsRevision++;
+    }
+
+    if (counted.mType == TileType::Building)
+    {
+        counted.mFile = tile->GetFile();
+        auto building = mBuildingCounts.try_emplace(counted.mFile, 0);
+        building.first->second++;
+        if (building.second)
+        {
+            mGroupsRevision++;
+        }
+    }
+
+    mCounted[tile] = counted;
+}
+
+/**
+ * Remove a tile from the counts, using what was
+ * recorded when the tile was counted.
+ * @param tile Tile to remove
+ */
+void CityStatistics::Uncount(Tile *tile)
+{
+    auto loc = mCounted.find(tile);
+    if (loc == mCounted.end())
+    {
+        return;
+    }
+
+    const Counted &counted = loc->second;
+    mTypeCounts[(int)counted.mType]--;
+
+    auto region = mRegionCounts.find(counted.mRegion);
+    if (--region->second[(int)counted.mType] == 0)
+    {
+        // Drop the region when the last tile leaves it
+        bool empty = true;
+        for (auto count : region->second)
+        {
+            empty = empty && count == 0;
+        }
+
+        if (empty)
+        {
+            mRegionCounts.erase(region);
+            mGroupsRevision++;
+        }
+    }
+
+    if (counted.mType == TileType::Building)
+    {
+        auto building = mBuildingCounts.find(counted.mFile);
+        if (--building->second == 0)
+        {
+            mBuildingCounts.erase(building);
+            mGroupsRevision++;
+        }
+    }
+
+    mCounted.erase(loc);
+}
+
+/**
+ * Count everything in the city from scratch
+ */
+void CityStatistics::Rebuild()
+{
+    CityCleared();
+    for (auto tile : *mCity)
+    {
+        Count(tile.get());
+    }
+}
+
+/**
+ * A tile has been added to the city
+ * @param tile Tile that was added
+ */
+void CityStatistics::TileAdded(std::shared_ptr<Tile> tile)
+{
+    Count(tile.get());
+}
+
+/**
+ * A tile is being removed from the city
+ * @param tile Tile that is being removed
+ */
+void CityStatistics::TileRemoved(std::shared_ptr<Tile> tile)
+{
+    Uncount(tile.get());
+}
+
+/**
+ * A tile has moved, which may move it to another region
+ * @param tile Tile that moved
+ * @param oldX Previous X location of the tile
+ * @param oldY Previous Y location of the tile
+ */
+void CityStatistics::TileMoved(Tile *tile, int oldX, int oldY)
+{
+    auto loc = mCounted.find(tile);
+    if (loc != mCounted.end() && loc->second.mRegion != GetRegion(tile->GetX(), tile->GetY()))
+    {
+        Uncount(tile);
+        Count(tile);
+    }
+}
+
+/**
+ * The city has been cleared
+ */
+void CityStatistics::CityCleared()
+{
+    mCounted.clear();
+    mTypeCounts.fill(0);
+    mBuildingCounts.clear();
+    mRegionCounts.clear();
+    mGroupsRevision++;
+}
+
+/**
+ * The city has been loaded
+ */
+void CityStatistics::CityLoaded()
+{
+    Rebuild();
+}
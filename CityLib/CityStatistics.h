@@ -0,0 +1,126 @@
+/**
+ * @file CityStatistics.h
+ * @author timan
+ *
+ * Live counts of the tiles in the city
+ */
+
+#ifndef CITY_CITYLIB_CITYSTATISTICS_H
+#define CITY_CITYLIB_CITYSTATISTICS_H
+
+#include <array>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "CityObserver.h"
+#include "TileType.h"
+
+class City;
+
+/**
+ * Live counts of the tiles in the city.
+ *
+ * The counts are grouped by tile type, by building image
+ * file and by region. They are updated as the city changes,
+ * so reading them never requires a walk over the city.
+ */
+class CityStatistics : public CityObserver
+{
+public:
+    /// Size of a region in grid locations in each direction
+    static const int RegionSize = 16;
+
+    /// Number of tiles of each type, indexed by TileType
+    typedef std::array<int, NumTileTypes> TypeCounts;
+
+    /// A region as a (column, row) pair
+    typedef std::pair<int, int> Region;
+
+private:
+    /// What we counted for a tile, so it can be uncounted exactly
+    struct Counted
+    {
+        TileType mType;         ///< Type of the tile
+        std::wstring mFile;     ///< Building image file, if a building
+        Region mRegion;         ///< Region the tile was in
+    };
+
+    void Count(Tile *tile);
+    void Uncount(Tile *tile);
+    void Rebuild();
+
+    /// The city we are counting
+    City *mCity;
+
+    /// What was counted for each tile in the city
+    std::unordered_map<Tile *, Counted> mCounted;
+
+    /// Number of tiles of each type
+    TypeCounts mTypeCounts = {};
+
+    /// Number of buildings using each image file
+    std::map<std::wstring, int> mBuildingCounts;
+
+    /// Number of tiles of each type in each region
+    std::map<Region, TypeCounts> mRegionCounts;
+
+    /// Incremented whenever an entry is added to or removed
+    /// from mBuildingCounts or mRegionCounts
+    int mGroupsRevision = 0;
+
+public:
+    explicit CityStatistics(City *city);
+
+    /// Copy constructor (disabled)
+    CityStatistics(const CityStatistics &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const CityStatistics &) = delete;
+
+    static Region GetRegion(int x, int y);
+
+    /**
+     * Get the total number of tiles in the city
+     * @return Number of tiles
+     */
+    int GetTotal() const { return (int)mCounted.size(); }
+
+    /**
+     * Get the number of tiles of some type
+     * @param type Tile type
+     * @return Number of tiles of that type
+     */
+    int GetCount(TileType type) const { return mTypeCounts[(int)type]; }
+
+    /**
+     * Get the number of buildings using each image file
+     * @return Map from image file to count
+     */
+    const std::map<std::wstring, int> &GetBuildingCounts() const { return mBuildingCounts; }
+
+    /**
+     * Get the number of tiles of each type in each region.
+     * Regions with no tiles are not included.
+     * @return Map from region to counts
+     */
+    const std::map<Region, TypeCounts> &GetRegionCounts() const { return mRegionCounts; }
+
+    /**
+     * Get the revision of the building and region groups. This only
+     * changes when a building image or a region is added or removed,
+     * not when the counts of an existing one change, so iterators into
+     * the maps saved at one revision stay valid until it changes.
+     * @return Revision number
+     */
+    int GetGroupsRevision() const { return mGroupsRevision; }
+
+    void TileAdded(std::shared_ptr<Tile> tile) override;
+    void TileRemoved(std::shared_ptr<Tile> tile) override;
+    void TileMoved(Tile *tile, int oldX, int oldY) override;
+    void CityCleared() override;
+    void CityLoaded() override;
+};
+
+#endif //CITY_CITYLIB_CITYSTATISTICS_H
@@ -21,6 +21,7 @@
 #include "BuildingCounter.h"
 #include "StarshipCheck.h"
 #include "HasStarship.h"
+#include "ReportExporter.h"
 
 
 /// Initial tile X location
@@ -35,6 +36,21 @@ const int FrameDuration = 30;
 /// Margin of trashcan from side and bottom in pixels
 const int TrashcanMargin = 10;
 
+/// Margin around the city report in pixels
+const int ReportMargin = 10;
+
+/// Number of report rows scrolled by one mouse wheel step
+const int ReportScrollRows = 3;
+
+/// Number of traffic agents for each house
+const int AgentsPerHome = 8;
+
+/// Most traffic agents in the city
+const int MaxAgents = 50000;
+
+/// Farthest the view can zoom out
+const int MaxZoomLevel = 6;
+
 /**
  * Constructor
  * @param mainFrame Pointer to wxFrame object, the main frame for the application
@@ -48,8 +64,29 @@ void CityView::Initialize(wxFrame* mainFrame)
     wxStandardPaths& standardPaths = wxStandardPaths::Get();
     std::wstring resourcesDir = standardPaths.GetResourcesDir().ToStdWstring();
     mCity.SetImagesDirectory(resourcesDir);
+    mCity.LoadSprites();
+
+    mReportView.SetStatistics(&mCity.GetStatistics());
+    mReportView.SetCoverage(&mCity.GetServiceCoverage());
+    mReportView.SetLandValue(&mCity.GetLandValue());
+    mReportView.SetSimulation(&mCity.GetSimulation());
+
+    // The report font is made once, and its lines are only rendered when they change
+    wxFont reportFont(wxSize(0, 14), wxFONTFAMILY_SWISS, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL);
+    mReportText.SetFont(reportFont, *wxCYAN);
+    mReportView.SetTextCache(&mReportText);
 
-    mTrashcan = std::make_unique<wxBitmap>(mCity.GetImagesDirectory() + L"/trashcan.png", wxBITMAP_TYPE_ANY);
+    wxImage trashcan;
+    if (mCity.GetAssets().GetImage(L"trashcan.png", trashcan))
+    {
+        mTrashcan = std::make_unique<wxBitmap>(trashcan);
+    }
+    else
+    {
+        mTrashcan = std::make_unique<wxBitmap>(mCity.GetImagesDirectory() + L"/trashcan.png", wxBITMAP_TYPE_ANY);
+    }
+
+    mTrashcanSprite = mCity.GetAtlas().Load(mCity.GetImagesDirectory(), L"trashcan.png");
 
     SetBackgroundStyle(wxBG_STYLE_PAINT);
 
@@ -58,6 +95,7 @@ void CityView::Initialize(wxFrame* mainFrame)
     Bind(wxEVT_LEFT_UP, &CityView::OnLeftUp, this);
     Bind(wxEVT_LEFT_DCLICK, &CityView::OnLeftDoubleClick, this);
     Bind(wxEVT_MOTION, &CityView::OnMouseMove, this);
+    Bind(wxEVT_MOUSEWHEEL, &CityView::OnMouseWheel, this);
     Bind(wxEVT_TIMER, &CityView::OnTimer, this);
 
 
@@ -80,14 +118,89 @@ void CityView::AddMenus(wxFrame* mainFrame, wxMenuBar *menuBar, wxMenu* fileMenu
     auto buildingsMenu = new wxMenu();
     auto businessesMenu = new wxMenu();
 
+    // Options added to the file menu, ahead of Exit
+    fileMenu->Insert(2, IDM_FILE_EXPORTREPORT, L"&Export Report...", L"Export the city report to CSV or JSON");
+    mainFrame->Bind(wxEVT_COMMAND_MENU_SELECTED, &CityView::OnExportReport, this, IDM_FILE_EXPORTREPORT);
+
     // Options added to the view menu
     viewMenu->Append(IDM_VIEW_OUTLINES, L"&Outlines", L"Enable to disable drawing outlines", wxITEM_CHECK);
     viewMenu->Append(IDM_VIEW_CITYREPORT, L"&City Report", L"Enable or disable city report", wxITEM_CHECK);
     mainFrame->Bind(wxEVT_COMMAND_MENU_SELECTED, &CityView::OnViewOutlines, this, IDM_VIEW_OUTLINES);
     mainFrame->Bind(wxEVT_UPDATE_UI, &CityView::OnUpdateViewOutlines, this, IDM_VIEW_OUTLINES);
+    viewMenu->Append(IDM_VIEW_LANDVALUE, L"&Land Value", L"Enable or disable the land value overlay", wxITEM_CHECK);
+    mainFrame->Bind(wxEVT_COMMAND_MENU_SELECTED, &CityView::OnViewLandValue, this, IDM_VIEW_LANDVALUE);
+    mainFrame->Bind(wxEVT_UPDATE_UI, &CityView::OnUpdateViewLandValue, this, IDM_VIEW_LANDVALUE);
+    viewMenu->Append(IDM_VIEW_TRAFFIC, L"&Traffic", L"Enable or disable people travelling between buildings", wxITEM_CHECK);
+    mainFrame->Bind(wxEVT_COMMAND_MENU_SELECTED, &CityView::OnViewTraffic, this, IDM_VIEW_TRAFFIC);
+    mainFrame->Bind(wxEVT_UPDATE_UI, &CityView::OnUpdateViewTraffic, this, IDM_VIEW_TRAFFIC);
+    viewMenu->Append(IDM_VIEW_ZOOMIN, L"Zoom &In", L"Zoom in on the city");
+    viewMenu->Append(IDM_VIEW_ZOOMOUT, L"Zoom O&ut", L"Zoom out from the city");
+    mainFrame->Bind(wxEVT_COMMAND_MENU_SELECTED, &CityView::OnViewZoom, this, IDM_VIEW_ZOOMIN, IDM_VIEW_ZOOMOUT);
+    mainFrame->Bind(wxEVT_UPDATE_UI, &CityView::OnUpdateViewZoom, this, IDM_VIEW_ZOOMIN, IDM_VIEW_ZOOMOUT);
+
+    auto rendererMenu = new wxMenu();
+    rendererMenu->AppendRadioItem(IDM_VIEW_RENDERER_DC, L"&wxDC", L"Draw each sprite with the device context");
+    rendererMenu->AppendRadioItem(IDM_VIEW_RENDERER_SCALAR, L"Software &Scalar", L"Blend sprites in memory one pixel at a time");
+    rendererMenu->AppendRadioItem(IDM_VIEW_RENDERER_SSE2, L"Software SSE&2", L"Blend sprites in memory with SSE2");
+    rendererMenu->AppendRadioItem(IDM_VIEW_RENDERER_AVX2, L"Software &AVX2", L"Blend sprites in memory with AVX2");
+    viewMenu->AppendSubMenu(rendererMenu, L"&Renderer", L"How the city is drawn at full size");
+    mainFrame->Bind(wxEVT_COMMAND_MENU_SELECTED, &CityView::OnViewRenderer, this,
+                    IDM_VIEW_RENDERER_DC, IDM_VIEW_RENDERER_AVX2);
+    mainFrame->Bind(wxEVT_UPDATE_UI, &CityView::OnUpdateViewRenderer, this,
+                    IDM_VIEW_RENDERER_DC, IDM_VIEW_RENDERER_AVX2);
+    viewMenu->Append(IDM_VIEW_CULLING, L"&Hide Covered Sprites", L"Skip drawing sprites other sprites cover completely", wxITEM_CHECK);
+    mainFrame->Bind(wxEVT_COMMAND_MENU_SELECTED, &CityView::OnViewCulling, this, IDM_VIEW_CULLING);
+    mainFrame->Bind(wxEVT_UPDATE_UI, &CityView::OnUpdateViewCulling, this, IDM_VIEW_CULLING);
     mainFrame->Bind(wxEVT_COMMAND_MENU_SELECTED, &CityView::OnViewCityReport, this, IDM_VIEW_CITYREPORT);
     mainFrame->Bind(wxEVT_UPDATE_UI, &CityView::OnUpdateViewCityReport, this, IDM_VIEW_CITYREPORT);
 
+    auto reportOrderMenu = new wxMenu();
+    reportOrderMenu->AppendRadioItem(IDM_VIEW_REPORT_ORDER_ADDED, L"&As Added", L"List tiles in the order they were added");
+    reportOrderMenu->AppendRadioItem(IDM_VIEW_REPORT_ORDER_POSITION, L"&Position", L"List tiles from top to bottom");
+    reportOrderMenu->AppendRadioItem(IDM_VIEW_REPORT_ORDER_TYPE, L"&Type", L"List tiles grouped by type");
+    viewMenu->AppendSubMenu(reportOrderMenu, L"Report &Order", L"Order of the city report");
+    mainFrame->Bind(wxEVT_COMMAND_MENU_SELECTED, &CityView::OnReportOrder, this,
+                    IDM_VIEW_REPORT_ORDER_ADDED, IDM_VIEW_REPORT_ORDER_TYPE);
+    mainFrame->Bind(wxEVT_UPDATE_UI, &CityView::OnUpdateReportOrder, this,
+                    IDM_VIEW_REPORT_ORDER_ADDED, IDM_VIEW_REPORT_ORDER_TYPE);
+
+    auto reportFilterMenu = new wxMenu();
+    reportFilterMenu->AppendRadioItem(IDM_VIEW_REPORT_FILTER_ALL, L"&All", L"Report all tiles");
+    reportFilterMenu->AppendRadioItem(IDM_VIEW_REPORT_FILTER_LANDSCAPE, L"&Landscape", L"Report only landscape tiles");
+    reportFilterMenu->AppendRadioItem(IDM_VIEW_REPORT_FILTER_BUILDING, L"&Buildings", L"Report only buildings");
+    reportFilterMenu->AppendRadioItem(IDM_VIEW_REPORT_FILTER_GARDEN, L"&Gardens", L"Report only gardens");
+    reportFilterMenu->AppendRadioItem(IDM_VIEW_REPORT_FILTER_WATER, L"&Water", L"Report only water tiles");
+    reportFilterMenu->AppendRadioItem(IDM_VIEW_REPORT_FILTER_STARSHIPPAD, L"&Starship Pads", L"Report only starship pads");
+    viewMenu->AppendSubMenu(reportFilterMenu, L"Report &Filter", L"Types of tile in the city report");
+    mainFrame->Bind(wxEVT_COMMAND_MENU_SELECTED, &CityView::OnReportFilter, this,
+                    IDM_VIEW_REPORT_FILTER_ALL, IDM_VIEW_REPORT_FILTER_STARSHIPPAD);
+    mainFrame->Bind(wxEVT_UPDATE_UI, &CityView::OnUpdateReportFilter, this,
+                    IDM_VIEW_REPORT_FILTER_ALL, IDM_VIEW_REPORT_FILTER_STARSHIPPAD);
+
+    auto reportGroupingMenu = new wxMenu();
+    reportGroupingMenu->AppendRadioItem(IDM_VIEW_REPORT_GROUP_TILES, L"&Tiles", L"Report every tile");
+    reportGroupingMenu->AppendRadioItem(IDM_VIEW_REPORT_GROUP_TYPE, L"By T&ype", L"Report counts for each type of tile");
+    reportGroupingMenu->AppendRadioItem(IDM_VIEW_REPORT_GROUP_BUILDING, L"By &Building", L"Report counts for each building");
+    reportGroupingMenu->AppendRadioItem(IDM_VIEW_REPORT_GROUP_REGION, L"By &Region", L"Report counts for each region");
+    reportGroupingMenu->AppendRadioItem(IDM_VIEW_REPORT_GROUP_COVERAGE, L"Service &Coverage", L"Report distances to fire stations and hospitals");
+    reportGroupingMenu->AppendRadioItem(IDM_VIEW_REPORT_GROUP_LANDVALUE, L"&Land Value", L"Report the average land value for each type of tile");
+    reportGroupingMenu->AppendRadioItem(IDM_VIEW_REPORT_GROUP_ECONOMY, L"&Economy", L"Report the population, jobs and funds of the city");
+    viewMenu->AppendSubMenu(reportGroupingMenu, L"Report &Grouping", L"Grouping of the city report");
+    mainFrame->Bind(wxEVT_COMMAND_MENU_SELECTED, &CityView::OnReportGrouping, this,
+                    IDM_VIEW_REPORT_GROUP_TILES, IDM_VIEW_REPORT_GROUP_ECONOMY);
+    mainFrame->Bind(wxEVT_UPDATE_UI, &CityView::OnUpdateReportGrouping, this,
+                    IDM_VIEW_REPORT_GROUP_TILES, IDM_VIEW_REPORT_GROUP_ECONOMY);
+
+    auto coverageMenu = new wxMenu();
+    coverageMenu->AppendRadioItem(IDM_VIEW_COVERAGE_NONE, L"&None", L"Do not show service coverage");
+    coverageMenu->AppendRadioItem(IDM_VIEW_COVERAGE_FIRESTATION, L"&Fire Stations", L"Show the distance to the nearest fire station");
+    coverageMenu->AppendRadioItem(IDM_VIEW_COVERAGE_HOSPITAL, L"&Hospitals", L"Show the distance to the nearest hospital");
+    viewMenu->AppendSubMenu(coverageMenu, L"Co&verage", L"Service coverage overlay");
+    mainFrame->Bind(wxEVT_COMMAND_MENU_SELECTED, &CityView::OnViewCoverage, this,
+                    IDM_VIEW_COVERAGE_NONE, IDM_VIEW_COVERAGE_HOSPITAL);
+    mainFrame->Bind(wxEVT_UPDATE_UI, &CityView::OnUpdateViewCoverage, this,
+                    IDM_VIEW_COVERAGE_NONE, IDM_VIEW_COVERAGE_HOSPITAL);
+
     //
     // Landscaping menu options
     //
@@ -145,7 +258,12 @@ void CityView::Save(const wxString& filename)
  */
 void CityView::Load(const wxString& filename)
 {
-    mCity.Load(filename);
+    if (!mCity.Load(filename))
+    {
+        wxMessageBox(L"Unable to load City file");
+        return;
+    }
+
     Refresh();
 }
 
@@ -177,8 +295,8 @@ void CityView::OnPaint(wxPaintEvent& event)
 {
     wxAutoBufferedPaintDC dc(this);
 
-    wxBrush background(*wxBLACK);
-    dc.SetBackground(background);
+    mAllocations.BeginFrame();
+    dc.SetBackground(mBackground);
     dc.Clear();
 
     // Compute the time that has elapsed
@@ -187,64 +305,80 @@ void CityView::OnPaint(wxPaintEvent& event)
     auto elapsed = (double)(newTime - mTime) * 0.001;
     mTime = newTime;
 
-    /*
-     * Draw the trash can
-     */
-
     auto rect = GetClientRect();
 
     // Bottom minus image size minus margin is top of the image
     mTrashcanTop = rect.GetHeight() - mTrashcan->GetHeight() - TrashcanMargin;
     mTrashcanRight = TrashcanMargin + mTrashcan->GetWidth();
 
-    dc.DrawBitmap(*mTrashcan, TrashcanMargin, mTrashcanTop);
-
     mCity.Update(elapsed);
-    mCity.OnDraw(&dc);
+    mAllocations.EndPhase("update");
+
+    /*
+     * Draw the trash can and the city
+     */
+
+    wxStopWatch drawTime;
+    if (mRenderer >= 0 && mZoomLevel == 0)
+    {
+        // The same sprites in the same order, blended in memory
+        mCompositor.Resize(rect.GetWidth(), rect.GetHeight());
+        mCompositor.Clear(*wxBLACK);
+        mCompositor.Draw(mTrashcanSprite, TrashcanMargin, mTrashcanTop);
+        mCity.BuildDrawList(&mDrawList, rect);
+        mCompositor.Draw(mDrawList);
+        mCompositor.Present(&dc, 0, 0);
+    }
+    else
+    {
+        dc.DrawBitmap(*mTrashcan, TrashcanMargin, mTrashcanTop);
+        mCity.OnDraw(&dc, mZoomLevel);
+    }
+
+    long drawMicro = drawTime.TimeInMicro().ToLong();
+    mAllocations.EndPhase("draw");
 
+    // Overlays are drawn in city coordinates
+    double zoom = 1.0 / (1 << mZoomLevel);
+    dc.SetUserScale(zoom, zoom);
+
+    wxRect visible(0, 0, ToCity(rect.GetWidth()), ToCity(rect.GetHeight()));
     if(mOutlines)
     {
-        // Draw outlines around each of the on-screen tiles
-        for (auto tile : mCity)
-        {
-            wxPen pen(wxColour(0, 255, 0), 2);
-            dc.SetPen(pen);
-            tile->DrawBorder(&dc);
-        }
+        mOverlays.DrawOutlines(&dc, visible);
     }
 
-    if (mReport)
+    if (mTraffic)
     {
-        auto report = mCity.GenerateCityReport();
+        mCity.GetTraffic().Draw(&dc, visible);
+    }
 
-        float x = 10;
-        float y = 10;
-        const float dy = 15;
+    if (mLandValue)
+    {
+        mOverlays.DrawLandValue(&dc, visible);
+    }
 
-        // Creates a font
-        wxFont font(wxSize(0, 14),
-                    wxFONTFAMILY_SWISS,
-                    wxFONTSTYLE_NORMAL,
-                    wxFONTWEIGHT_NORMAL);
-        dc.SetFont(font);
-        dc.SetTextForeground(*wxCYAN);
+    if (mCoverage >= 0)
+    {
+        mOverlays.DrawCoverage(&dc, ServiceCoverage::Service(mCoverage), visible);
+    }
 
-        dc.DrawText(L"City Report",  // Text to draw
-                    (int)x,     // x coordinate for the left size of the text
-                    (int)y);    // y coordinate for the top of the text
+    dc.SetUserScale(1, 1);
+    mAllocations.EndPhase("overlays");
 
-        y += dy;
+    if (mReport)
+    {
+        mReportView.SetReport(mCity.GenerateCityReport());
 
-        for (auto memberReport : *report)
-        {
-            dc.DrawText(memberReport->Report().c_str(),
-                         (int)x,     // x coordinate for the left size of the text
-                         (int)y);    // y coordinate for the top of the text
+        // Only the rows that fit in the window are drawn
+        mReportView.Draw(&dc, ReportMargin, ReportMargin, rect.GetHeight() - ReportMargin * 2);
+    }
 
-            y += dy;
-        }
+    mAllocations.EndPhase("report");
+    mAllocations.EndFrame();
 
-    }
+    // After the frame, so updating the status bar is not counted
+    ReportDrawTime(drawMicro);
 }
 
 /**
@@ -253,7 +387,7 @@ void CityView::OnPaint(wxPaintEvent& event)
  */
 void CityView::OnLeftDown(wxMouseEvent &event)
 {
-    mGrabbedItem = mCity.HitTest(event.GetX(), event.GetY());
+    mGrabbedItem = mCity.HitTest(ToCity(event.GetX()), ToCity(event.GetY()));
     if (mGrabbedItem != nullptr)
     {
         // We grabbed something
@@ -286,7 +420,7 @@ void CityView::OnMouseMove(wxMouseEvent &event)
         // move it while the left button is down.
         if (event.LeftIsDown())
         {
-            mGrabbedItem->SetLocation(event.GetX(), event.GetY());
+            mGrabbedItem->SetLocation(ToCity(event.GetX()), ToCity(event.GetY()));
         }
         else
         {
@@ -323,7 +457,7 @@ void CityView::OnLeftDoubleClick(wxMouseEvent &event)
 	 * Must create either new visitors to handle this or use the already made visitors to
 	 * handle setting the new launch and landing tiles for the rocket
 	 */
-    auto tile = mCity.HitTest(event.GetX(), event.GetY());
+    auto tile = mCity.HitTest(ToCity(event.GetX()), ToCity(event.GetY()));
     if (tile != nullptr)
     {
         // instantiate starshipPad Visitor
@@ -516,10 +650,314 @@ void CityView::OnTimer(wxTimerEvent& event)
 void CityView::OnBuildingsCount(wxCommandEvent& event)
 {
 	BuildingCounter visitor;
-	mCity.Accept(&visitor);
+	mCity.ParallelAccept(&visitor);
 	int cnt = visitor.GetNumBuildings();
 
+	// The ones in the window come from the summed-area table
+	auto rect = GetClientRect();
+	BuildingCounter inView;
+	inView.CountRegion(&mCity, 0, 0, ToCity(rect.GetWidth()) - 1, ToCity(rect.GetHeight()) - 1);
+
 	std::wstringstream str;
-	str << L"There are " << cnt << L" buildings.";
+	str << L"There are " << cnt << L" buildings, " << inView.GetNumBuildings() << L" of them in view.";
 	wxMessageBox(str.str().c_str(), L"Building Counter");
 }
+
+/**
+ * Handle the mouse wheel, which scrolls the city report
+ * @param event Mouse event
+ */
+void CityView::OnMouseWheel(wxMouseEvent &event)
+{
+    if (event.ControlDown())
+    {
+        // Control and the wheel zooms
+        int steps = event.GetWheelRotation() / event.GetWheelDelta();
+        SetZoomLevel(mZoomLevel - steps);
+    }
+    else if (mReport)
+    {
+        int steps = event.GetWheelRotation() / event.GetWheelDelta();
+        mReportView.Scroll(-steps * ReportScrollRows);
+        Refresh();
+    }
+}
+
+/**
+ * Menu event handler for the View>Report Order menu options
+ * @param event Menu event
+ */
+void CityView::OnReportOrder(wxCommandEvent& event)
+{
+    switch (event.GetId())
+    {
+        case IDM_VIEW_REPORT_ORDER_POSITION:
+            mReportView.SetSortOrder(ReportView::SortOrder::Position);
+            break;
+
+        case IDM_VIEW_REPORT_ORDER_TYPE:
+            mReportView.SetSortOrder(ReportView::SortOrder::Type);
+            break;
+
+        default:
+            mReportView.SetSortOrder(ReportView::SortOrder::Report);
+            break;
+    }
+}
+
+/**
+ * Update handler for the View>Report Order menu options
+ * @param event Update event
+ */
+void CityView::OnUpdateReportOrder(wxUpdateUIEvent& event)
+{
+    auto order = mReportView.GetSortOrder();
+    switch (event.GetId())
+    {
+        case IDM_VIEW_REPORT_ORDER_POSITION:
+            event.Check(order == ReportView::SortOrder::Position);
+            break;
+
+        case IDM_VIEW_REPORT_ORDER_TYPE:
+            event.Check(order == ReportView::SortOrder::Type);
+            break;
+
+        default:
+            event.Check(order == ReportView::SortOrder::Report);
+            break;
+    }
+}
+
+/**
+ * Menu event handler for the View>Report Filter menu options
+ * @param event Menu event
+ */
+void CityView::OnReportFilter(wxCommandEvent& event)
+{
+    if (event.GetId() == IDM_VIEW_REPORT_FILTER_ALL)
+    {
+        mReportView.ClearFilter();
+    }
+    else
+    {
+        mReportView.SetFilter(TileType(event.GetId() - IDM_VIEW_REPORT_FILTER_LANDSCAPE));
+    }
+}
+
+/**
+ * Update handler for the View>Report Filter menu options
+ * @param event Update event
+ */
+void CityView::OnUpdateReportFilter(wxUpdateUIEvent& event)
+{
+    if (event.GetId() == IDM_VIEW_REPORT_FILTER_ALL)
+    {
+        event.Check(!mReportView.IsFiltered());
+    }
+    else
+    {
+        event.Check(mReportView.IsFiltered() &&
+            mReportView.GetFilterType() == TileType(event.GetId() - IDM_VIEW_REPORT_FILTER_LANDSCAPE));
+    }
+}
+
+/**
+ * Menu event handler for the View>Report Grouping menu options
+ * @param event Menu event
+ */
+void CityView::OnReportGrouping(wxCommandEvent& event)
+{
+    mReportView.SetGrouping(ReportView::Grouping(event.GetId() - IDM_VIEW_REPORT_GROUP_TILES));
+}
+
+/**
+ * Update handler for the View>Report Grouping menu options
+ * @param event Update event
+ */
+void CityView::OnUpdateReportGrouping(wxUpdateUIEvent& event)
+{
+    event.Check(mReportView.GetGrouping() == ReportView::Grouping(event.GetId() - IDM_VIEW_REPORT_GROUP_TILES));
+}
+
+/**
+ * Handle the File>Export Report menu option
+ * @param event Menu event
+ */
+void CityView::OnExportReport(wxCommandEvent& event)
+{
+    wxFileDialog exportFileDialog(this, _("Export City Report"), "", "",
+            "CSV Files (*.csv)|*.csv|JSON Files (*.json)|*.json", wxFD_SAVE|wxFD_OVERWRITE_PROMPT);
+    if (exportFileDialog.ShowModal() == wxID_CANCEL)
+    {
+        return;
+    }
+
+    ReportExporter exporter(&mCity);
+    if (!exporter.Export(exportFileDialog.GetPath().ToStdWstring()))
+    {
+        wxMessageBox(L"Export of the city report failed");
+    }
+}
+
+/**
+ * Handle the View>Coverage menu options
+ * @param event Menu event
+ */
+void CityView::OnViewCoverage(wxCommandEvent& event)
+{
+    mCoverage = event.GetId() - IDM_VIEW_COVERAGE_FIRESTATION;
+    Refresh();
+}
+
+/**
+ * Update handler for the View>Coverage menu options
+ * @param event Update event
+ */
+void CityView::OnUpdateViewCoverage(wxUpdateUIEvent& event)
+{
+    event.Check(mCoverage == event.GetId() - IDM_VIEW_COVERAGE_FIRESTATION);
+}
+
+/**
+ * Menu event handler View>Land Value menu option
+ * @param event Menu event
+ */
+void CityView::OnViewLandValue(wxCommandEvent& event)
+{
+    mLandValue = !mLandValue;
+}
+
+/**
+ * Update handler for View>Land Value menu option
+ * @param event Update event
+ */
+void CityView::OnUpdateViewLandValue(wxUpdateUIEvent& event)
+{
+    event.Check(mLandValue);
+}
+
+/**
+ * Menu event handler View>Traffic menu option
+ * @param event Menu event
+ */
+void CityView::OnViewTraffic(wxCommandEvent& event)
+{
+    mTraffic = !mTraffic;
+    if (mTraffic)
+    {
+        mCity.GetTraffic().SetAgentsPerHome(AgentsPerHome, MaxAgents);
+    }
+    else
+    {
+        mCity.GetTraffic().SetNumAgents(0);
+    }
+}
+
+/**
+ * Update handler for View>Traffic menu option
+ * @param event Update event
+ */
+void CityView::OnUpdateViewTraffic(wxUpdateUIEvent& event)
+{
+    event.Check(mTraffic);
+}
+
+/**
+ * Menu event handler for the View>Zoom In and Zoom Out menu options
+ * @param event Menu event
+ */
+void CityView::OnViewZoom(wxCommandEvent& event)
+{
+    SetZoomLevel(mZoomLevel + (event.GetId() == IDM_VIEW_ZOOMIN ? -1 : 1));
+}
+
+/**
+ * Update handler for the View>Zoom In and Zoom Out menu options
+ * @param event Update event
+ */
+void CityView::OnUpdateViewZoom(wxUpdateUIEvent& event)
+{
+    event.Enable(event.GetId() == IDM_VIEW_ZOOMIN ? mZoomLevel > 0 : mZoomLevel < MaxZoomLevel);
+}
+
+/**
+ * Menu event handler for the View>Renderer menu options
+ * @param event Menu event
+ */
+void CityView::OnViewRenderer(wxCommandEvent& event)
+{
+    mRenderer = event.GetId() - IDM_VIEW_RENDERER_SCALAR;
+    if (mRenderer >= 0)
+    {
+        mCompositor.SetKernel(BlendKernels::Kernel(mRenderer));
+    }
+
+    mDrawTime.Reset();
+    Refresh();
+}
+
+/**
+ * Update handler for the View>Renderer menu options
+ * @param event Update event
+ */
+void CityView::OnUpdateViewRenderer(wxUpdateUIEvent& event)
+{
+    int renderer = event.GetId() - IDM_VIEW_RENDERER_SCALAR;
+    event.Enable(renderer < 0 || BlendKernels::IsSupported(BlendKernels::Kernel(renderer)));
+    event.Check(renderer == mRenderer);
+}
+
+/**
+ * Menu event handler for the View>Hide Covered Sprites menu option
+ * @param event Menu event
+ */
+void CityView::OnViewCulling(wxCommandEvent& event)
+{
+    auto &culler = mCity.GetCuller();
+    culler.SetEnabled(!culler.IsEnabled());
+    mDrawTime.Reset();
+    Refresh();
+}
+
+/**
+ * Update handler for the View>Hide Covered Sprites menu option
+ * @param event Update event
+ */
+void CityView::OnUpdateViewCulling(wxUpdateUIEvent& event)
+{
+    event.Check(mCity.GetCuller().IsEnabled());
+}
+
+/**
+ * Show the average time taken to draw the city in the
+ * status bar, so the renderers can be compared, along with
+ * the heap allocations per frame when they are counted
+ * @param micro Time taken to draw this frame in microseconds
+ */
+void CityView::ReportDrawTime(long micro)
+{
+    bool software = mRenderer >= 0 && mZoomLevel == 0;
+    const wchar_t *renderer = software ? BlendKernels::GetKernelName(mCompositor.GetKernel()) : L"wxDC";
+    auto &culler = mCity.GetCuller();
+    bool culled = mZoomLevel == 0 && culler.IsEnabled();
+    if (!mDrawTime.AddFrame(micro, mAllocations.GetFrameCount(), renderer, culled ? &culler : nullptr))
+    {
+        return;
+    }
+
+    auto frame = wxDynamicCast(GetParent(), wxFrame);
+    if (frame != nullptr && frame->GetStatusBar() != nullptr)
+    {
+        frame->SetStatusText(mDrawTime.GetText());
+    }
+}
+
+/**
+ * Set how far the view is zoomed out
+ * @param level Zoom level, drawing at 1/2^level of full size
+ */
+void CityView::SetZoomLevel(int level)
+{
+    mZoomLevel = std::max(0, std::min(level, MaxZoomLevel));
+    Refresh();
+}
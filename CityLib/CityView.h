@@ -12,6 +12,13 @@
 #define CITY_EXAMPLEVIEW_H
 
 #include "City.h"
+#include "ReportView.h"
+#include "DrawList.h"
+#include "Compositor.h"
+#include "TextCache.h"
+#include "AllocationCounter.h"
+#include "CityOverlays.h"
+#include "DrawTimeReport.h"
 
 class Tile;
 
@@ -35,6 +42,35 @@ private:
     void OnBuildingsCount(wxCommandEvent &event);
     void OnViewOutlines(wxCommandEvent &event);
     void OnUpdateViewOutlines(wxUpdateUIEvent &event);
+    void OnReportOrder(wxCommandEvent &event);
+    void OnUpdateReportOrder(wxUpdateUIEvent &event);
+    void OnReportFilter(wxCommandEvent &event);
+    void OnUpdateReportFilter(wxUpdateUIEvent &event);
+    void OnReportGrouping(wxCommandEvent &event);
+    void OnUpdateReportGrouping(wxUpdateUIEvent &event);
+    void OnMouseWheel(wxMouseEvent &event);
+    void OnExportReport(wxCommandEvent &event);
+    void OnViewCoverage(wxCommandEvent &event);
+    void OnUpdateViewCoverage(wxUpdateUIEvent &event);
+    void OnViewLandValue(wxCommandEvent &event);
+    void OnUpdateViewLandValue(wxUpdateUIEvent &event);
+    void OnViewTraffic(wxCommandEvent &event);
+    void OnUpdateViewTraffic(wxUpdateUIEvent &event);
+    void OnViewZoom(wxCommandEvent &event);
+    void OnUpdateViewZoom(wxUpdateUIEvent &event);
+    void SetZoomLevel(int level);
+    void OnViewRenderer(wxCommandEvent &event);
+    void OnUpdateViewRenderer(wxUpdateUIEvent &event);
+    void OnViewCulling(wxCommandEvent &event);
+    void OnUpdateViewCulling(wxUpdateUIEvent &event);
+    void ReportDrawTime(long micro);
+
+    /**
+     * Convert a window coordinate to a city coordinate
+     * @param coordinate Coordinate in the window
+     * @return Coordinate in the city
+     */
+    int ToCity(int coordinate) const { return coordinate * (1 << mZoomLevel); }
 
     /// The city
     City   mCity;
@@ -51,12 +87,39 @@ private:
     /// The last stopwatch time
     long mTime = 0;
 
+    wxBrush mBackground{*wxBLACK};  ///< Brush the window is cleared with
+
     std::unique_ptr<wxBitmap> mTrashcan; ///< Trashcan image to use
     int mTrashcanTop = 0;           ///< Top line of the trashcan in pixels
     int mTrashcanRight = 0;         ///< Right side of the trashcan in pixels
+    SpriteAtlas::Sprite mTrashcanSprite;    ///< Trashcan in the atlas, for the software renderer
 
     bool mReport = false;           ///< Viewing the city report?
+    ReportView mReportView;         ///< Scrollable view of the city report
+    TextCache mReportText;          ///< Rendered lines of the city report
     bool mOutlines = false;         ///< Outline the tiles?
+    int mCoverage = -1;             ///< Service coverage overlay shown or -1 for none
+    bool mLandValue = false;        ///< Show the land value overlay?
+    bool mTraffic = false;          ///< Simulate and show traffic?
+    int mZoomLevel = 0;             ///< Drawing at 1/2^mZoomLevel of full size
+
+    /// Blend kernel of the software renderer, or -1 to draw with the wxDC
+    int mRenderer = -1;
+
+    /// Sprites the software renderer draws each frame
+    DrawList mDrawList;
+
+    /// Software renderer, used when drawing at full size
+    Compositor mCompositor{&mCity.GetAtlas()};
+
+    /// Outlines, land value and coverage drawn over the city
+    CityOverlays mOverlays{&mCity};
+
+    /// Average drawing time shown in the status bar
+    DrawTimeReport mDrawTime;
+
+    /// Heap allocations in each phase of the last frame
+    AllocationCounter mAllocations;
 
 public:
     void Initialize(wxFrame *mainFrame);
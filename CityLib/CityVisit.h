@@ -0,0 +1,83 @@
+/**
+ * @file CityVisit.h
+ * @author timan
+ *
+ * Statically dispatched traversal of the city tiles
+ */
+
+#ifndef CITY_CITYLIB_CITYVISIT_H
+#define CITY_CITYLIB_CITYVISIT_H
+
+#include "City.h"
+#include "TileLandscape.h"
+#include "TileBuilding.h"
+#include "TileGarden.h"
+#include "TileWater.h"
+#include "TileStarshipPad.h"
+
+/**
+ * Combine several lambdas into one callable with an
+ * overloaded function call operator, for use with City::Visit.
+ *
+ * @code
+ * int buildings = 0;
+ * city.Visit(Overloaded{
+ *     [&buildings](TileBuilding *building) { buildings++; },
+ *     [](Tile *other) {}
+ * });
+ * @endcode
+ */
+template <class... Callables>
+struct Overloaded : Callables...
+{
+    using Callables::operator()...;
+};
+
+/// Deduction guide for Overloaded
+template <class... Callables>
+Overloaded(Callables...) -> Overloaded<Callables...>;
+
+/**
+ * Visit every tile in the city with a callable.
+ *
+ * The tile type is found from the type tag stored in the
+ * tile, and the callable is called with a pointer to the
+ * derived tile class. There are no virtual calls, so the
+ * compiler can inline the callable into the loop. The
+ * callable must accept a pointer to every tile class;
+ * an overload taking Tile * catches any types not needed.
+ *
+ * @param callable Callable to call for each tile
+ */
+template <class Callable>
+void City::Visit(Callable &&callable)
+{
+    for (auto &item : mTiles)
+    {
+        Tile *tile = item.get();
+        switch (tile->GetType())
+        {
+            case TileType::Landscape:
+                callable(static_cast<TileLandscape *>(tile));
+                break;
+
+            case TileType::Building:
+                callable(static_cast<TileBuilding *>(tile));
+                break;
+
+            case TileType::Garden:
+                callable(static_cast<TileGarden *>(tile));
+                break;
+
+            case TileType::Water:
+                callable(static_cast<TileWater *>(tile));
+                break;
+
+            case TileType::StarshipPad:
+                callable(static_cast<TileStarshipPad *>(tile));
+                break;
+        }
+    }
+}
+
+#endif //CITY_CITYLIB_CITYVISIT_H
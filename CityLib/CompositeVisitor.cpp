@@ -0,0 +1,105 @@
+/**
+ * @file CompositeVisitor.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+
+#include "CompositeVisitor.h"
+
+/**
+ * Visit a TileBuilding object
+ * @param building Building we are visiting
+ */
+void CompositeVisitor::VisitBuilding(TileBuilding* building)
+{
+	for (auto visitor : mVisitors)
+	{
+		visitor->VisitBuilding(building);
+	}
+}
+
+/**
+ * Visit a TileLandscape object
+ * @param landscape Landscape tile we are visiting
+ */
+void CompositeVisitor::VisitLandscape(TileLandscape* landscape)
+{
+	for (auto visitor : mVisitors)
+	{
+		visitor->VisitLandscape(landscape);
+	}
+}
+
+/**
+ * Visit a TileGarden object
+ * @param garden Garden we are visiting
+ */
+void CompositeVisitor::VisitGarden(TileGarden* garden)
+{
+	for (auto visitor : mVisitors)
+	{
+		visitor->VisitGarden(garden);
+	}
+}
+
+/**
+ * Visit a TileWater object
+ * @param water Water tile we are visiting
+ */
+void CompositeVisitor::VisitWater(TileWater* water)
+{
+	for (auto visitor : mVisitors)
+	{
+		visitor->VisitWater(water);
+	}
+}
+
+/**
+ * Visit a TileStarshipPad object
+ * @param pad Starship pad we are visiting
+ */
+void CompositeVisitor::VisitStarshipPad(TileStarshipPad* pad)
+{
+	for (auto visitor : mVisitors)
+	{
+		visitor->VisitStarshipPad(pad);
+	}
+}
+
+/**
+ * Create a composite of clones of our visitors for a
+ * worker of a parallel traversal.
+ * @return New composite, or nullptr if any of our
+ * visitors cannot be run in parallel
+ */
+std::unique_ptr<TileVisitor> CompositeVisitor::Clone() const
+{
+	auto composite = std::make_unique<CompositeVisitor>();
+	for (auto visitor : mVisitors)
+	{
+		auto clone = visitor->Clone();
+		if (clone == nullptr)
+		{
+			return nullptr;
+		}
+
+		composite->Add(clone.get());
+		composite->mOwned.push_back(std::move(clone));
+	}
+
+	return composite;
+}
+
+/**
+ * Merge the results of a worker composite into our visitors
+ * @param other Composite created by Clone
+ */
+void CompositeVisitor::Reduce(TileVisitor* other)
+{
+	auto composite = static_cast<CompositeVisitor*>(other);
+	for (size_t i = 0; i < mVisitors.size(); i++)
+	{
+		mVisitors[i]->Reduce(composite->mVisitors[i]);
+	}
+}
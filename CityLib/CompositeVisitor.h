@@ -0,0 +1,59 @@
+/**
+ * @file CompositeVisitor.h
+ * @author timan
+ *
+ * A visitor that runs several visitors in one traversal
+ */
+
+#ifndef CITY_CITYLIB_COMPOSITEVISITOR_H
+#define CITY_CITYLIB_COMPOSITEVISITOR_H
+
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+#include "TileVisitor.h"
+
+/**
+ * A visitor that runs several visitors in one traversal.
+ *
+ * Each tile is dispatched once, to this visitor, which passes
+ * it on to every visitor it holds, in the order they were added.
+ * This lets several visitors share a single walk of the city.
+ */
+class CompositeVisitor : public TileVisitor
+{
+private:
+	/// The visitors we pass each tile to
+	std::vector<TileVisitor*> mVisitors;
+
+	/// Visitors owned by this one, created by Clone
+	std::vector<std::unique_ptr<TileVisitor>> mOwned;
+
+public:
+	/// Constructor
+	CompositeVisitor() {}
+
+	/**
+	 * Constructor
+	 * @param visitors Visitors to run, in order
+	 */
+	CompositeVisitor(std::initializer_list<TileVisitor*> visitors) : mVisitors(visitors) {}
+
+	/**
+	 * Add a visitor to run
+	 * @param visitor Visitor to add. It is not owned by this object.
+	 */
+	void Add(TileVisitor* visitor) { mVisitors.push_back(visitor); }
+
+	void VisitBuilding(TileBuilding* building) override;
+	void VisitLandscape(TileLandscape* landscape) override;
+	void VisitGarden(TileGarden* garden) override;
+	void VisitWater(TileWater* water) override;
+	void VisitStarshipPad(TileStarshipPad* pad) override;
+
+	std::unique_ptr<TileVisitor> Clone() const override;
+	void Reduce(TileVisitor* other) override;
+};
+
+#endif //CITY_CITYLIB_COMPOSITEVISITOR_H
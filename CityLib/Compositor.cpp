@@ -0,0 +1,269 @@
+/**
+ * @file Compositor.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+#include <algorithm>
+#include <wx/rawbmp.h>
+#include "Compositor.h"
+#include "DrawList.h"
+#include "WorkerPool.h"
+
+/**
+ * Constructor
+ * @param atlas Atlas the sprites are in
+ */
+Compositor::Compositor(SpriteAtlas *atlas) : mAtlas(atlas)
+{
+    SetKernel(BlendKernels::GetBestKernel());
+}
+
+/**
+ * Set the kernel used to blend
+ *
+ * A kernel the processor does not support blends
+ * with the scalar kernel instead.
+ *
+ * @param kernel Kernel to use
+ */
+void Compositor::SetKernel(BlendKernels::Kernel kernel)
+{
+    mKernel = BlendKernels::IsSupported(kernel) ? kernel : BlendKernels::Kernel::Scalar;
+    mBlendRow = BlendKernels::GetBlendRow(mKernel);
+}
+
+/**
+ * Set the size of the frame
+ * @param width Width in pixels
+ * @param height Height in pixels
+ */
+void Compositor::Resize(int width, int height)
+{
+    mWidth = std::max(0, width);
+    mHeight = std::max(0, height);
+    mPixels.resize((size_t)mWidth * mHeight);
+}
+
+/**
+ * Fill the frame with an opaque colour
+ * @param colour Colour to fill with
+ */
+void Compositor::Clear(const wxColour &colour)
+{
+    uint32_t pixel;
+    auto bytes = reinterpret_cast<uint8_t *>(&pixel);
+    bytes[0] = colour.Red();
+    bytes[1] = colour.Green();
+    bytes[2] = colour.Blue();
+    bytes[3] = 255;
+
+    if (!mThreaded)
+    {
+        std::fill(mPixels.begin(), mPixels.end(), pixel);
+        return;
+    }
+
+    WorkerPool::Get().ParallelFor(mHeight, [this, pixel](int begin, int end, int worker) {
+        std::fill(mPixels.begin() + (size_t)begin * mWidth, mPixels.begin() + (size_t)end * mWidth, pixel);
+    });
+}
+
+/**
+ * Get the premultiplied copy of an atlas page,
+ * making it if it is missing or out of date
+ * @param page Page index
+ * @return Copy of the page
+ */
+const Compositor::Page &Compositor::GetPage(int page)
+{
+    if (page >= (int)mPages.size())
+    {
+        mPages.resize(page + 1);
+    }
+
+    auto &copy = mPages[page];
+    int revision = mAtlas->GetPageRevision(page);
+    if (copy.mRevision != revision)
+    {
+        const wxImage &image = mAtlas->GetPageImage(page);
+        const int wid = image.GetWidth();
+        const int hit = image.GetHeight();
+        const unsigned char *rgb = image.GetData();
+        const unsigned char *alpha = image.GetAlpha();
+
+        copy.mWidth = wid;
+        copy.mPixels.resize((size_t)wid * hit);
+        auto bytes = reinterpret_cast<uint8_t *>(copy.mPixels.data());
+        for (size_t i = 0; i < copy.mPixels.size(); i++, bytes += 4)
+        {
+            uint32_t a = alpha != nullptr ? alpha[i] : 255;
+            bytes[0] = (uint8_t)((rgb[i * 3] * a + 127) / 255);
+            bytes[1] = (uint8_t)((rgb[i * 3 + 1] * a + 127) / 255);
+            bytes[2] = (uint8_t)((rgb[i * 3 + 2] * a + 127) / 255);
+            bytes[3] = (uint8_t)a;
+        }
+
+        copy.mRevision = revision;
+    }
+
+    return copy;
+}
+
+/**
+ * Blend a sprite into the frame
+ * @param sprite Sprite to draw
+ * @param x Left of where to draw the sprite
+ * @param y Top of where to draw the sprite
+ */
+void Compositor::Draw(const SpriteAtlas::Sprite &sprite, int x, int y)
+{
+    if (sprite.IsOk())
+    {
+        GetPage(sprite.mPage);
+        DrawRows(sprite, x, y, 0, mHeight);
+    }
+}
+
+/**
+ * Blend the part of a sprite that falls in some rows of the frame
+ *
+ * The copy of the sprite's page must already be up to date.
+ *
+ * @param sprite Sprite to draw
+ * @param x Left of where to draw the sprite
+ * @param y Top of where to draw the sprite
+ * @param top First row of the frame to draw in
+ * @param bottom One past the last row of the frame to draw in
+ */
+void Compositor::DrawRows(const SpriteAtlas::Sprite &sprite, int x, int y, int top, int bottom)
+{
+    // Clip to the rows and the frame
+    const wxRect &rect = sprite.mRect;
+    int left = std::max(x, 0);
+    int right = std::min(x + rect.width, mWidth);
+    top = std::max(y, top);
+    bottom = std::min(y + rect.height, bottom);
+    if (left >= right || top >= bottom)
+    {
+        return;
+    }
+
+    const Page &page = mPages[sprite.mPage];
+    const int count = right - left;
+    for (int row = top; row < bottom; row++)
+    {
+        const uint32_t *src = page.mPixels.data() +
+                (size_t)(rect.y + row - y) * page.mWidth + (rect.x + left - x);
+        mBlendRow(mPixels.data() + (size_t)row * mWidth + left, src, count);
+    }
+}
+
+/**
+ * Blend the sprites of a draw list into the frame, back to front
+ * @param list Draw list to draw
+ */
+void Compositor::Draw(const DrawList &list)
+{
+    auto &pool = WorkerPool::Get();
+    if (!mThreaded || pool.GetNumWorkers() == 1)
+    {
+        for (auto &item : list)
+        {
+            Draw(item.mSprite, item.mX, item.mY);
+        }
+
+        return;
+    }
+
+    // Put each sprite in the bands it covers, keeping the list order
+    const int numBands = (mHeight + BandHeight - 1) / BandHeight;
+    mBands.resize(numBands);
+    for (auto &band : mBands)
+    {
+        band.clear();
+    }
+
+    for (int i = 0; i < list.GetSize(); i++)
+    {
+        const auto &item = list[i];
+        const wxRect &rect = item.mSprite.mRect;
+        int top = std::max(item.mY, 0);
+        int bottom = std::min(item.mY + rect.height, mHeight);
+        if (top >= bottom || item.mX >= mWidth || item.mX + rect.width <= 0)
+        {
+            continue;
+        }
+
+        // Pages are brought up to date here, before the workers read them
+        GetPage(item.mSprite.mPage);
+        for (int band = top / BandHeight; band <= (bottom - 1) / BandHeight; band++)
+        {
+            mBands[band].push_back(i);
+        }
+    }
+
+    pool.ParallelFor(numBands, [this, &list](int begin, int end, int worker) {
+        for (int band = begin; band < end; band++)
+        {
+            const int top = band * BandHeight;
+            const int bottom = std::min(top + BandHeight, mHeight);
+            for (int i : mBands[band])
+            {
+                const auto &item = list[i];
+                DrawRows(item.mSprite, item.mX, item.mY, top, bottom);
+            }
+        }
+    });
+}
+
+/**
+ * Draw the frame to a device context as one bitmap
+ *
+ * The frame is opaque after Clear, so its colours
+ * are used without dividing by alpha. They are written
+ * straight into a bitmap kept for the next frame, so
+ * nothing is allocated unless the frame changes size.
+ *
+ * @param dc Device context to draw on
+ * @param x Left of where to draw the frame
+ * @param y Top of where to draw the frame
+ */
+void Compositor::Present(wxDC *dc, int x, int y)
+{
+    if (mWidth == 0 || mHeight == 0)
+    {
+        return;
+    }
+
+    if (!mBitmap.IsOk() || mBitmap.GetWidth() != mWidth || mBitmap.GetHeight() != mHeight)
+    {
+        mBitmap = wxBitmap(mWidth, mHeight, 24);
+    }
+
+    {
+        // The pixel data must be released before the bitmap is drawn
+        wxNativePixelData data(mBitmap);
+        if (!data)
+        {
+            return;
+        }
+
+        wxNativePixelData::Iterator row(data);
+        auto bytes = reinterpret_cast<const uint8_t *>(mPixels.data());
+        for (int r = 0; r < mHeight; r++)
+        {
+            wxNativePixelData::Iterator pixel = row;
+            for (int c = 0; c < mWidth; c++, bytes += 4, ++pixel)
+            {
+                pixel.Red() = bytes[0];
+                pixel.Green() = bytes[1];
+                pixel.Blue() = bytes[2];
+            }
+
+            row.OffsetY(data, 1);
+        }
+    }
+
+    dc->DrawBitmap(mBitmap, x, y);
+}
@@ -0,0 +1,141 @@
+/**
+ * @file Compositor.h
+ * @author timan
+ *
+ * Draws sprites into a frame in memory
+ */
+
+#ifndef CITY_CITYLIB_COMPOSITOR_H
+#define CITY_CITYLIB_COMPOSITOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include "SpriteAtlas.h"
+#include "BlendKernels.h"
+
+class DrawList;
+
+/**
+ * Draws sprites into a frame in memory.
+ *
+ * An alternative to drawing each sprite with a device context.
+ * The frame is an array of premultiplied RGBA pixels. Sprites in
+ * a draw list are blended into it back to front by one of the
+ * blend kernels, and the whole frame is then drawn to a device
+ * context as a single bitmap.
+ *
+ * A draw list is drawn on all of the worker threads. The frame
+ * is split into horizontal bands, each sprite is put in the bands
+ * its rows fall in, in list order, and each band then draws its
+ * sprites back to front on one worker. Bands share no pixels and
+ * every band keeps the order of the list, so the frame is exactly
+ * the frame a single thread would draw.
+ *
+ * The atlas keeps straight alpha pixels, so the compositor keeps
+ * a premultiplied copy of each atlas page, made when the page is
+ * first drawn from and again whenever sprites are added to it.
+ */
+class Compositor
+{
+public:
+    /// Height of a band of the frame drawn by one worker, in pixels
+    static const int BandHeight = 64;
+
+private:
+    /// A premultiplied copy of an atlas page
+    struct Page
+    {
+        int mRevision = -1;             ///< Revision of the page copied, -1 if none
+        int mWidth = 0;                 ///< Width of the page in pixels
+        std::vector<uint32_t> mPixels;  ///< The pixels, row by row
+    };
+
+    const Page &GetPage(int page);
+    void DrawRows(const SpriteAtlas::Sprite &sprite, int x, int y, int top, int bottom);
+
+    /// Atlas the sprites are in
+    SpriteAtlas *mAtlas;
+
+    /// Kernel used to blend
+    BlendKernels::Kernel mKernel;
+
+    /// Function that blends rows with that kernel
+    BlendKernels::BlendRow mBlendRow;
+
+    /// Copies of the atlas pages
+    std::vector<Page> mPages;
+
+    /// Width of the frame in pixels
+    int mWidth = 0;
+
+    /// Height of the frame in pixels
+    int mHeight = 0;
+
+    /// The frame, row by row
+    std::vector<uint32_t> mPixels;
+
+    /// Draw on all of the worker threads?
+    bool mThreaded = true;
+
+    /// Indices in the draw list of the sprites in each band
+    std::vector<std::vector<int>> mBands;
+
+    /// Bitmap the frame is copied into to draw it, kept from frame to frame
+    wxBitmap mBitmap;
+
+public:
+    Compositor(SpriteAtlas *atlas);
+
+    /// Copy constructor (disabled)
+    Compositor(const Compositor &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const Compositor &) = delete;
+
+    void SetKernel(BlendKernels::Kernel kernel);
+
+    /**
+     * Get the kernel used to blend
+     * @return Kernel
+     */
+    BlendKernels::Kernel GetKernel() const { return mKernel; }
+
+    /**
+     * Set whether to draw on all of the worker threads
+     * @param threaded true to draw in bands on the worker threads
+     */
+    void SetThreaded(bool threaded) { mThreaded = threaded; }
+
+    /**
+     * Is the compositor drawing on all of the worker threads?
+     * @return true if drawing in bands on the worker threads
+     */
+    bool IsThreaded() const { return mThreaded; }
+
+    void Resize(int width, int height);
+    void Clear(const wxColour &colour);
+    void Draw(const SpriteAtlas::Sprite &sprite, int x, int y);
+    void Draw(const DrawList &list);
+    void Present(wxDC *dc, int x, int y);
+
+    /**
+     * Get the width of the frame
+     * @return Width in pixels
+     */
+    int GetWidth() const { return mWidth; }
+
+    /**
+     * Get the height of the frame
+     * @return Height in pixels
+     */
+    int GetHeight() const { return mHeight; }
+
+    /**
+     * Get the pixels of the frame
+     * @return Premultiplied RGBA pixels, row by row
+     */
+    const std::vector<uint32_t> &GetPixels() const { return mPixels; }
+};
+
+#endif //CITY_CITYLIB_COMPOSITOR_H
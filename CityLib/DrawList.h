@@ -0,0 +1,102 @@
+/**
+ * @file DrawList.h
+ * @author timan
+ *
+ * The sprites to draw for a frame, in order
+ */
+
+#ifndef CITY_CITYLIB_DRAWLIST_H
+#define CITY_CITYLIB_DRAWLIST_H
+
+#include <vector>
+
+#include "SpriteAtlas.h"
+
+/**
+ * The sprites to draw for a frame, in order.
+ *
+ * Tiles add the sprites they would draw to the list, back to
+ * front, so a renderer other than a wxDC can draw the frame
+ * and get the same result. The list keeps its memory from
+ * frame to frame.
+ */
+class DrawList
+{
+public:
+    /// One sprite to draw
+    struct Item
+    {
+        SpriteAtlas::Sprite mSprite;    ///< Sprite to draw
+        int mX;                         ///< Left of where to draw it
+        int mY;                         ///< Top of where to draw it
+    };
+
+private:
+    /// The sprites, back to front
+    std::vector<Item> mItems;
+
+public:
+    /**
+     * Empty the list, keeping its memory
+     */
+    void Clear() { mItems.clear(); }
+
+    /**
+     * Add a sprite to the front of the list
+     * @param sprite Sprite to draw
+     * @param x Left of where to draw it
+     * @param y Top of where to draw it
+     */
+    void Add(const SpriteAtlas::Sprite &sprite, int x, int y)
+    {
+        if (sprite.IsOk())
+        {
+            mItems.push_back({sprite, x, y});
+        }
+    }
+
+    /**
+     * Remove sprites from the list, keeping the order of the rest
+     * @param keep For each sprite, nonzero to keep it
+     */
+    void Keep(const std::vector<char> &keep)
+    {
+        size_t to = 0;
+        for (size_t from = 0; from < mItems.size(); from++)
+        {
+            if (keep[from])
+            {
+                mItems[to++] = mItems[from];
+            }
+        }
+
+        mItems.resize(to);
+    }
+
+    /**
+     * Get the number of sprites in the list
+     * @return Number of sprites
+     */
+    int GetSize() const { return (int)mItems.size(); }
+
+    /**
+     * Get a sprite in the list
+     * @param i Index of the sprite, 0 at the back
+     * @return The sprite and where to draw it
+     */
+    const Item &operator[](int i) const { return mItems[i]; }
+
+    /**
+     * Get an iterator at the back of the list
+     * @return Iterator
+     */
+    std::vector<Item>::const_iterator begin() const { return mItems.begin(); }
+
+    /**
+     * Get an iterator past the front of the list
+     * @return Iterator
+     */
+    std::vector<Item>::const_iterator end() const { return mItems.end(); }
+};
+
+#endif //CITY_CITYLIB_DRAWLIST_H
@@ -0,0 +1,69 @@
+/**
+ * @file DrawTimeReport.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+
+#include <cwchar>
+
+#include "DrawTimeReport.h"
+#include "OcclusionCuller.h"
+#include "AllocationCounter.h"
+
+/// Number of frames the drawing time is averaged over
+const int DrawTimeFrames = 30;
+
+/// Longest piece of the report formatted at once, in characters.
+/// The pieces are numbers and a renderer name, well short of this.
+const int MaxPieceLength = 128;
+
+/**
+ * Add a frame, making a new report once enough frames have been drawn
+ * @param micro Time taken to draw the frame in microseconds
+ * @param allocations Heap allocations in the frame
+ * @param renderer Name of the renderer that drew the frame
+ * @param culler Culler that removed hidden sprites from the frame, or nullptr if none did
+ * @return true if there is a new report in GetText
+ */
+bool DrawTimeReport::AddFrame(long micro, long long allocations, const wchar_t *renderer,
+                              const OcclusionCuller *culler)
+{
+    mMicro += micro;
+    mAllocations += allocations;
+    mFrames++;
+    if (mFrames < DrawTimeFrames)
+    {
+        return false;
+    }
+
+    wchar_t buffer[MaxPieceLength];
+    int length = std::swprintf(buffer, MaxPieceLength, L"Drawing %.2f ms (%ls)", mMicro * 0.001 / mFrames, renderer);
+    mText.assign(buffer, length > 0 ? length : 0);
+
+    if (culler != nullptr)
+    {
+        int sprites = culler->GetNumDrawn() + culler->GetNumOccluded() + culler->GetNumOffscreen();
+        length = std::swprintf(buffer, MaxPieceLength, L", %d of %d sprites hidden", culler->GetNumOccluded(), sprites);
+        mText.append(buffer, length > 0 ? length : 0);
+    }
+
+    if (AllocationCounter::IsEnabled())
+    {
+        length = std::swprintf(buffer, MaxPieceLength, L", %.1f allocations per frame", (double)mAllocations / mFrames);
+        mText.append(buffer, length > 0 ? length : 0);
+    }
+
+    Reset();
+    return true;
+}
+
+/**
+ * Start averaging again, as when the renderer changes
+ */
+void DrawTimeReport::Reset()
+{
+    mMicro = 0;
+    mAllocations = 0;
+    mFrames = 0;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file DrawTimeReport.h
+ * @author timan
+ *
+ * Average drawing time and allocations shown in the status bar
+ */
+
+#ifndef CITY_CITYLIB_DRAWTIMEREPORT_H
+#define CITY_CITYLIB_DRAWTIMEREPORT_H
+
+#include <string>
+
+class OcclusionCuller;
+
+/**
+ * Average drawing time and allocations shown in the status bar.
+ *
+ * Frames are added one at a time, and every so many frames
+ * the averages are formatted into a line of text, so the
+ * renderers can be compared. The text keeps its memory from
+ * report to report, so once it has grown to fit the longest
+ * line, reporting makes no heap allocations.
+ */
+class DrawTimeReport
+{
+private:
+    long mMicro = 0;            ///< Time spent drawing since the last report
+    int mFrames = 0;            ///< Frames drawn since the last report
+    long long mAllocations = 0; ///< Heap allocations since the last report
+
+    /// The last report
+    std::wstring mText;
+
+public:
+    bool AddFrame(long micro, long long allocations, const wchar_t *renderer, const OcclusionCuller *culler);
+    void Reset();
+
+    /**
+     * Get the last report
+     * @return Line of text for the status bar
+     */
+    const std::wstring &GetText() const { return mText; }
+};
+
+#endif //CITY_CITYLIB_DRAWTIMEREPORT_H
@@ -35,6 +35,14 @@ public:
 	 */
 	bool IsEmpty(){return mEmpty;}
 
+	/**
+	 * This visitor prefers the first pad it sees, so
+	 * the result depends on visit order. It opts out of
+	 * parallel traversal.
+	 * @return nullptr
+	 */
+	std::unique_ptr<TileVisitor> Clone() const override { return nullptr; }
+
 private:
 	/// a TileStarshipPad pointer that tracks atile
 	TileStarshipPad* mStarshipPad = nullptr;
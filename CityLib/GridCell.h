@@ -0,0 +1,68 @@
+/**
+ * @file GridCell.h
+ * @author timan
+ *
+ * Grid locations packed into keys for hashed lookups
+ */
+
+#ifndef CITY_CITYLIB_GRIDCELL_H
+#define CITY_CITYLIB_GRIDCELL_H
+
+/**
+ * Grid locations packed into keys for hashed lookups.
+ *
+ * A key holds the column in its high 32 bits and the row in
+ * its low 32 bits. The packing is done on unsigned values,
+ * so negative columns and rows are fine. City::GetGridCell
+ * makes the key for a tile location.
+ */
+namespace GridCell
+{
+    /// A grid location as a key
+    typedef long long Key;
+
+    /// Number of neighbors a grid location has
+    const int NumNeighbors = 4;
+
+    /// Offsets to the neighbors of a grid location, the
+    /// locations City::GetAdjacent would return
+    const int Neighbors[NumNeighbors][2] = {{-2, -1}, {2, -1}, {-2, 1}, {2, 1}};
+
+    /**
+     * Make the key for a grid location
+     * @param col Grid column
+     * @param row Grid row
+     * @return Key
+     */
+    inline Key Make(int col, int row)
+    {
+        return (Key)(((unsigned long long)(unsigned)col << 32) | (unsigned)row);
+    }
+
+    /**
+     * Get the grid column of a key
+     * @param key Key
+     * @return Grid column
+     */
+    inline int Column(Key key) { return (int)(unsigned)((unsigned long long)key >> 32); }
+
+    /**
+     * Get the grid row of a key
+     * @param key Key
+     * @return Grid row
+     */
+    inline int Row(Key key) { return (int)(unsigned)key; }
+
+    /**
+     * Get the key of a neighbor of a grid location
+     * @param key Key of the grid location
+     * @param neighbor Index into Neighbors
+     * @return Key of the neighbor
+     */
+    inline Key Neighbor(Key key, int neighbor)
+    {
+        return Make(Column(key) + Neighbors[neighbor][0], Row(key) + Neighbors[neighbor][1]);
+    }
+}
+
+#endif //CITY_CITYLIB_GRIDCELL_H
@@ -32,6 +32,14 @@ public:
 	 */
 	TileStarshipPad* GetStarshipTile() {return mStarshipTile;}
 
+	/**
+	 * This visitor keeps the last matching pad it sees, so
+	 * the result depends on visit order. It opts out of
+	 * parallel traversal.
+	 * @return nullptr
+	 */
+	std::unique_ptr<TileVisitor> Clone() const override { return nullptr; }
+
 private:
 	/// a shared_ptr holding a Starship object
 	std::shared_ptr<Starship> mStarship;
@@ -0,0 +1,413 @@
+/**
+ * @file LandValue.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+
+#include <algorithm>
+
+#include "LandValue.h"
+#include "City.h"
+#include "WorkerPool.h"
+
+/// Time between ticks in seconds
+const double TickInterval = 0.1;
+
+/// Most ticks run by one update, so a slow frame
+/// does not make the next one slower still
+const int MaxTicksPerUpdate = 4;
+
+/// Fraction of the difference from the neighbors'
+/// average a location makes up each tick
+const float Diffusion = 0.2f;
+
+/// Fraction of its value a location loses each tick
+const float Decay = 0.05f;
+
+/// Extra grid locations around the city, so
+/// value can spread beyond its edges
+const int ValueMargin = 32;
+
+/// Rows in a block of the stencil
+const int BlockRows = 32;
+
+/// Columns in a block of the stencil
+const int BlockColumns = 512;
+
+/// Influence of a garden per tick
+const float GardenInfluence = 0.5f;
+
+/// Influence of water per tick
+const float WaterInfluence = 0.4f;
+
+/// Influence of a Sparty statue per tick
+const float SpartyInfluence = 1.0f;
+
+/// Influence of a building per tick
+const float BuildingInfluence = -0.2f;
+
+/**
+ * Constructor
+ * @param city The city we are evaluating
+ */
+LandValue::LandValue(City *city) : mCity(city)
+{
+}
+
+/**
+ * Convert a pixel location to a grid location,
+ * rounding toward negative infinity
+ * @param pixels Location in pixels
+ * @return Grid location
+ */
+int LandValue::GridLocation(int pixels)
+{
+    const int spacing = City::GridSpacing;
+    return pixels >= 0 ? pixels / spacing : (pixels - spacing + 1) / spacing;
+}
+
+/**
+ * Get how much a tile changes the value of its location each tick
+ * @param tile Tile to test
+ * @return Influence, negative if the tile lowers the value
+ */
+float LandValue::GetInfluence(Tile *tile)
+{
+    switch (tile->GetType())
+    {
+        case TileType::Garden:
+            return GardenInfluence;
+
+        case TileType::Water:
+            return WaterInfluence;
+
+        case TileType::Building:
+            return BuildingInfluence;
+
+        case TileType::Landscape:
+            return tile->GetFile() == L"sparty.png" ? SpartyInfluence : 0;
+
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Is a grid location covered by the arrays?
+ * @param col Grid column
+ * @param row Grid row
+ * @return true if covered
+ */
+bool LandValue::Contains(int col, int row) const
+{
+    return col >= mLeft && row >= mTop && col < mLeft + mColumns && row < mTop + mRows;
+}
+
+/**
+ * Get the index of a covered grid location in the arrays
+ * @param col Grid column
+ * @param row Grid row
+ * @return Index
+ */
+int LandValue::GetIndex(int col, int row) const
+{
+    return (row - mTop + 1) * (mColumns + 2) + col - mLeft + 1;
+}
+
+/**
+ * Add or remove a tile and its influence at a location
+ * @param tile The tile
+ * @param x X location of the tile in pixels
+ * @param y Y location of the tile in pixels
+ * @param sign 1 to add the tile, -1 to remove it
+ */
+void LandValue::AddTile(Tile *tile, int x, int y, int sign)
+{
+    float influence = GetInfluence(tile);
+    int col = GridLocation(x);
+    int row = GridLocation(y);
+    if (!Contains(col, row))
+    {
+        // A tile with no influence outside the area has
+        // no value under it to count toward the averages
+        if (influence != 0)
+        {
+            // The rebuild adds the tile as it is now
+            Rebuild(col, row);
+        }
+
+        return;
+    }
+
+    int index = GetIndex(col, row);
+    mTypeCounts[(int)tile->GetType()][index] += sign;
+    mSources[index] += sign * influence;
+}
+
+/**
+ * Resize the arrays to cover the whole city and a grid location.
+ *
+ * Values already computed are kept where the old and new
+ * areas overlap. The influences and tiles are counted again.
+ * @param includeCol Grid column the arrays must cover
+ * @param includeRow Grid row the arrays must cover
+ */
+void LandValue::Rebuild(int includeCol, int includeRow)
+{
+    int minCol = includeCol, maxCol = includeCol;
+    int minRow = includeRow, maxRow = includeRow;
+    for (auto tile : *mCity)
+    {
+        int col = GridLocation(tile->GetX());
+        int row = GridLocation(tile->GetY());
+        minCol = std::min(minCol, col);
+        maxCol = std::max(maxCol, col);
+        minRow = std::min(minRow, row);
+        maxRow = std::max(maxRow, row);
+    }
+
+    int oldLeft = mLeft, oldTop = mTop, oldColumns = mColumns, oldRows = mRows;
+    std::vector<float> oldValues;
+    oldValues.swap(mValues);
+
+    mLeft = minCol - ValueMargin;
+    mTop = minRow - ValueMargin;
+    mColumns = maxCol - minCol + 1 + ValueMargin * 2;
+    mRows = maxRow - minRow + 1 + ValueMargin * 2;
+
+    size_t size = (size_t)(mColumns + 2) * (mRows + 2);
+    mValues.assign(size, 0);
+    mNext.assign(size, 0);
+    mSources.assign(size, 0);
+    for (auto &counts : mTypeCounts)
+    {
+        counts.assign(size, 0);
+    }
+
+    if (!oldValues.empty())
+    {
+        for (int row = std::max(mTop, oldTop); row < std::min(mTop + mRows, oldTop + oldRows); row++)
+        {
+            for (int col = std::max(mLeft, oldLeft); col < std::min(mLeft + mColumns, oldLeft + oldColumns); col++)
+            {
+                mValues[GetIndex(col, row)] =
+                        oldValues[(row - oldTop + 1) * (oldColumns + 2) + col - oldLeft + 1];
+            }
+        }
+    }
+
+    mTypeTotals.fill(0);
+    for (auto tile : *mCity)
+    {
+        int index = GetIndex(GridLocation(tile->GetX()), GridLocation(tile->GetY()));
+        mSources[index] += GetInfluence(tile.get());
+        mTypeCounts[(int)tile->GetType()][index]++;
+        mTypeTotals[(int)tile->GetType()]++;
+    }
+}
+
+/**
+ * Handle updates for animation, running a tick
+ * each time enough time has passed
+ * @param elapsed The time since the last update in seconds
+ */
+void LandValue::Update(double elapsed)
+{
+    mTime += elapsed;
+    int ticks = 0;
+    while (mTime >= TickInterval)
+    {
+        if (ticks == MaxTicksPerUpdate)
+        {
+            mTime = 0;
+            break;
+        }
+
+        Tick();
+        mTime -= TickInterval;
+        ticks++;
+    }
+}
+
+/**
+ * Spread the land value for one tick
+ *
+ * The same pass adds up the new value under each
+ * type of tile for the averages.
+ */
+void LandValue::Tick()
+{
+    if (mValues.empty())
+    {
+        return;
+    }
+
+    const int stride = mColumns + 2;
+    const int rowBlocks = (mRows + BlockRows - 1) / BlockRows;
+    const int columnBlocks = (mColumns + BlockColumns - 1) / BlockColumns;
+
+    const float *values = mValues.data();
+    const float *sources = mSources.data();
+    float *next = mNext.data();
+
+    // What a location keeps of its own value
+    const float keep = 1 - 4 * Diffusion - Decay;
+
+    auto &pool = WorkerPool::Get();
+    mWorkerSums.assign(pool.GetNumWorkers(), {});
+
+    pool.ParallelFor(rowBlocks * columnBlocks,
+            [this, values, sources, next, stride, columnBlocks, keep](int begin, int end, int worker) {
+        std::array<double, NumTileTypes> sums = {};
+        for (int block = begin; block < end; block++)
+        {
+            int firstRow = block / columnBlocks * BlockRows + 1;
+            int lastRow = std::min(firstRow + BlockRows, mRows + 1);
+            int firstCol = block % columnBlocks * BlockColumns + 1;
+            int lastCol = std::min(firstCol + BlockColumns, mColumns + 1);
+
+            for (int row = firstRow; row < lastRow; row++)
+            {
+                const float *value = values + (size_t)row * stride;
+                const float *above = value - stride;
+                const float *below = value + stride;
+                const float *source = sources + (size_t)row * stride;
+                float *out = next + (size_t)row * stride;
+
+                // Simple enough for the compiler to vectorize
+                for (int col = firstCol; col < lastCol; col++)
+                {
+                    out[col] = keep * value[col] + source[col] +
+                            Diffusion * (value[col - 1] + value[col + 1] + above[col] + below[col]);
+                }
+
+                // The row is still in cache
+                for (int type = 0; type < NumTileTypes; type++)
+                {
+                    const int *counts = mTypeCounts[type].data() + (size_t)row * stride;
+                    float sum = 0;
+                    for (int col = firstCol; col < lastCol; col++)
+                    {
+                        sum += out[col] * counts[col];
+                    }
+
+                    sums[type] += sum;
+                }
+            }
+        }
+
+        mWorkerSums[worker] = sums;
+    });
+
+    mValues.swap(mNext);
+
+    std::array<double, NumTileTypes> sums = {};
+    for (auto &workerSums : mWorkerSums)
+    {
+        for (int type = 0; type < NumTileTypes; type++)
+        {
+            sums[type] += workerSums[type];
+        }
+    }
+
+    for (int type = 0; type < NumTileTypes; type++)
+    {
+        mAverages[type] = mTypeTotals[type] > 0 ? (float)(sums[type] / mTypeTotals[type]) : 0;
+    }
+
+    mRevision++;
+}
+
+/**
+ * Get the land value at a location
+ * @param x X location in pixels
+ * @param y Y location in pixels
+ * @return Land value, zero outside the area covered
+ */
+float LandValue::GetValue(int x, int y) const
+{
+    int col = GridLocation(x);
+    int row = GridLocation(y);
+    return Contains(col, row) ? mValues[GetIndex(col, row)] : 0;
+}
+
+/**
+ * A tile has been added to the city
+ * @param tile Tile that was added
+ */
+void LandValue::TileAdded(std::shared_ptr<Tile> tile)
+{
+    mTypeTotals[(int)tile->GetType()]++;
+    AddTile(tile.get(), tile->GetX(), tile->GetY(), 1);
+}
+
+/**
+ * A tile is being removed from the city
+ * @param tile Tile that is being removed
+ */
+void LandValue::TileRemoved(std::shared_ptr<Tile> tile)
+{
+    mTypeTotals[(int)tile->GetType()]--;
+    AddTile(tile.get(), tile->GetX(), tile->GetY(), -1);
+}
+
+/**
+ * A tile has moved, taking its influence with it
+ * @param tile Tile that moved
+ * @param oldX Previous X location of the tile
+ * @param oldY Previous Y location of the tile
+ */
+void LandValue::TileMoved(Tile *tile, int oldX, int oldY)
+{
+    int col = GridLocation(tile->GetX());
+    int row = GridLocation(tile->GetY());
+    if (col == GridLocation(oldX) && row == GridLocation(oldY))
+    {
+        return;
+    }
+
+    if (!Contains(col, row) && GetInfluence(tile) != 0)
+    {
+        // The rebuild adds the tile at the new location
+        Rebuild(col, row);
+        return;
+    }
+
+    AddTile(tile, oldX, oldY, -1);
+    AddTile(tile, tile->GetX(), tile->GetY(), 1);
+}
+
+/**
+ * The city has been cleared
+ */
+void LandValue::CityCleared()
+{
+    mLeft = mTop = mColumns = mRows = 0;
+    mValues.clear();
+    mNext.clear();
+    mSources.clear();
+    for (auto &counts : mTypeCounts)
+    {
+        counts.clear();
+    }
+
+    mTypeTotals.fill(0);
+    mAverages.fill(0);
+}
+
+/**
+ * The city has been loaded
+ */
+void LandValue::CityLoaded()
+{
+    int col = 0, row = 0;
+    for (auto tile : *mCity)
+    {
+        col = GridLocation(tile->GetX());
+        row = GridLocation(tile->GetY());
+        break;
+    }
+
+    Rebuild(col, row);
+}
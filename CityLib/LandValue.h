@@ -0,0 +1,130 @@
+/**
+ * @file LandValue.h
+ * @author timan
+ *
+ * Land value across the city grid
+ */
+
+#ifndef CITY_CITYLIB_LANDVALUE_H
+#define CITY_CITYLIB_LANDVALUE_H
+
+#include <array>
+#include <vector>
+
+#include "CityObserver.h"
+#include "TileType.h"
+
+class City;
+
+/**
+ * Land value across the city grid.
+ *
+ * Gardens, water and Sparty statues raise the value of the
+ * land around them and buildings lower it. Each tick, every
+ * grid location moves toward the average of its four neighbors,
+ * loses a little value and gains the influence of the tiles on
+ * it, so influence spreads out across the city over time.
+ *
+ * The values are a dense array over the area the city covers.
+ * A tick is a five-point stencil over that array, computed
+ * in blocks sized to stay in cache and spread over the
+ * worker pool. The same pass adds up the value under each
+ * type of tile, so the averages cost nothing extra to read.
+ */
+class LandValue : public CityObserver
+{
+private:
+    static int GridLocation(int pixels);
+    static float GetInfluence(Tile *tile);
+
+    bool Contains(int col, int row) const;
+    int GetIndex(int col, int row) const;
+    void AddTile(Tile *tile, int x, int y, int sign);
+    void Rebuild(int includeCol, int includeRow);
+
+    /// The city we are evaluating
+    City *mCity;
+
+    /// Grid column of the first column in the arrays
+    int mLeft = 0;
+
+    /// Grid row of the first row in the arrays
+    int mTop = 0;
+
+    /// Number of grid columns covered
+    int mColumns = 0;
+
+    /// Number of grid rows covered
+    int mRows = 0;
+
+    /// Land value at each location. The arrays have a border
+    /// one location wide that always holds zero, so the stencil
+    /// needs no tests at the edges.
+    std::vector<float> mValues;
+
+    /// Land value for the next tick
+    std::vector<float> mNext;
+
+    /// Influence of the tiles on each location per tick
+    std::vector<float> mSources;
+
+    /// Number of tiles of each type on each location
+    std::vector<int> mTypeCounts[NumTileTypes];
+
+    /// Number of tiles of each type in the city, including
+    /// any outside the area the arrays cover
+    std::array<int, NumTileTypes> mTypeTotals = {};
+
+    /// Sum of the value under each type of tile
+    /// for each worker during a tick
+    std::vector<std::array<double, NumTileTypes>> mWorkerSums;
+
+    /// Average value under each type of tile as of the last tick
+    std::array<float, NumTileTypes> mAverages = {};
+
+    /// Time not yet used for ticks in seconds
+    double mTime = 0;
+
+    /// Incremented on each tick
+    int mRevision = 0;
+
+public:
+    explicit LandValue(City *city);
+
+    /// Copy constructor (disabled)
+    LandValue(const LandValue &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const LandValue &) = delete;
+
+    void Update(double elapsed);
+    void Tick();
+
+    float GetValue(int x, int y) const;
+
+    /**
+     * Get the average land value under each type of tile as of the last tick
+     * @return Averages indexed by TileType, zero for types with no tiles
+     */
+    const std::array<float, NumTileTypes> &GetAverages() const { return mAverages; }
+
+    /**
+     * Get the revision of the values, which changes on every tick
+     * @return Revision number
+     */
+    int GetRevision() const { return mRevision; }
+
+    /**
+     * Get the number of grid locations the values cover
+     * @return Number of locations
+     */
+    long long GetNumLocations() const { return (long long)mColumns * mRows; }
+
+    void TileAdded(std::shared_ptr<Tile> tile) override;
+    void TileRemoved(std::shared_ptr<Tile> tile) override;
+    void TileMoved(Tile *tile, int oldX, int oldY) override;
+    void CityCleared() override;
+    void CityLoaded() override;
+};
+
+#endif //CITY_CITYLIB_LANDVALUE_H
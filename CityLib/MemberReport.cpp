@@ -18,11 +18,19 @@ MemberReport::MemberReport(std::shared_ptr<Tile> tile) : mTile(tile)
 
 /**
  * Generate the report line that is displayed.
+ *
+ * The line is only regenerated when it has been invalidated.
  * @return String report line
 */
-std::wstring MemberReport::Report()
+const std::wstring &MemberReport::Report()
 {
-    std::wstringstream str;
-    str << mTile->GetX() << L", " << mTile->GetY() << L": " << mReport;
-    return str.str();
+    if (!mLineValid)
+    {
+        std::wstringstream str;
+        str << mTile->GetX() << L", " << mTile->GetY() << L": " << mReport;
+        mLine = str.str();
+        mLineValid = true;
+    }
+
+    return mLine;
 }
\ No newline at end of file
@@ -25,13 +25,32 @@ class MemberReport
 public:
     MemberReport(std::shared_ptr<Tile> tile);
 
-    std::wstring Report();
+    const std::wstring &Report();
 
     /**
      * Set the report for this file
      * @param str New report text.
     */
-    void SetReport(std::wstring str) { mReport = str; }
+    void SetReport(std::wstring str) { mReport = str; mLineValid = false; }
+
+    /**
+     * Get the report text set by the tile, without the location
+     * @return Report text
+     */
+    const std::wstring &GetReport() const { return mReport; }
+
+    /**
+     * Indicate the report line is out of date, for example
+     * because the tile has moved. The line is regenerated
+     * the next time it is asked for.
+     */
+    void Invalidate() { mLineValid = false; }
+
+    /**
+     * Get the tile this report is for
+     * @return Tile pointer
+     */
+    Tile *GetTile() { return mTile.get(); }
 
 private:
     /// Tile this report is for
@@ -39,5 +58,11 @@ private:
 
     /// The generated report from the file
     std::wstring mReport;
+
+    /// The report line as displayed, including the location
+    std::wstring mLine;
+
+    /// Is mLine up to date?
+    bool mLineValid = false;
 };
 
@@ -0,0 +1,128 @@
+/**
+ * @file OcclusionCuller.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+#include <algorithm>
+#include "OcclusionCuller.h"
+#include "DrawList.h"
+
+/**
+ * Get 64 bits of a row of a mask
+ * @param row Words of the row
+ * @param words Number of words in the row
+ * @param position Column of the first bit, which may be
+ * before the start of the row; bits outside of it are zero
+ * @return The bits, low bit first
+ */
+static inline uint64_t GetBits(const uint64_t *row, int words, int position)
+{
+    int word = position >= 0 ? position / 64 : -((63 - position) / 64);
+    int shift = position - word * 64;
+
+    uint64_t low = word >= 0 && word < words ? row[word] : 0;
+    if (shift == 0)
+    {
+        return low;
+    }
+
+    uint64_t high = word + 1 >= 0 && word + 1 < words ? row[word + 1] : 0;
+    return (low >> shift) | (high << (64 - shift));
+}
+
+/**
+ * Remove the sprites of a draw list that would not
+ * change the frame
+ * @param list Draw list, back to front
+ * @param atlas Atlas the sprites are in
+ * @param view Area of the city the frame shows
+ */
+void OcclusionCuller::Cull(DrawList *list, const SpriteAtlas &atlas, const wxRect &view)
+{
+    const int wid = std::max(view.GetWidth(), 0);
+    const int hit = std::max(view.GetHeight(), 0);
+    const int count = list->GetSize();
+
+    mKeep.assign(count, 0);
+    mNumOccluded = 0;
+    mNumOffscreen = 0;
+
+    // The coverage is only needed to find hidden sprites
+    if (mEnabled)
+    {
+        // Columns past the right of the view count as covered
+        mWords = (wid + 63) / 64;
+        mCovered.assign((size_t)mWords * hit, 0);
+        if (wid % 64 != 0)
+        {
+            uint64_t outside = ~(uint64_t)0 << (wid % 64);
+            for (int y = 0; y < hit; y++)
+            {
+                mCovered[(size_t)y * mWords + mWords - 1] = outside;
+            }
+        }
+    }
+
+    for (int i = count - 1; i >= 0; i--)
+    {
+        const auto &item = (*list)[i];
+        const wxRect &rect = item.mSprite.mRect;
+        const int x = item.mX - view.x;
+        const int y = item.mY - view.y;
+        const int top = std::max(y, 0);
+        const int bottom = std::min(y + rect.height, hit);
+        const int left = std::max(x, 0);
+        const int right = std::min(x + rect.width, wid);
+        if (top >= bottom || left >= right)
+        {
+            mNumOffscreen++;
+            continue;
+        }
+
+        const int firstWord = left / 64;
+        const int lastWord = (right - 1) / 64;
+
+        if (mEnabled)
+        {
+            // Is any pixel the sprite shows still uncovered?
+            const SpriteAtlas::Mask &visible = atlas.GetVisibleMask(item.mSprite);
+            bool shows = false;
+            for (int row = top; row < bottom && !shows; row++)
+            {
+                const uint64_t *bits = visible.GetRow(row - y);
+                const uint64_t *covered = mCovered.data() + (size_t)row * mWords;
+                for (int word = firstWord; word <= lastWord; word++)
+                {
+                    if ((GetBits(bits, visible.mWords, word * 64 - x) & ~covered[word]) != 0)
+                    {
+                        shows = true;
+                        break;
+                    }
+                }
+            }
+
+            if (!shows)
+            {
+                mNumOccluded++;
+                continue;
+            }
+
+            const SpriteAtlas::Mask &opaque = atlas.GetOpaqueMask(item.mSprite);
+            for (int row = top; row < bottom; row++)
+            {
+                const uint64_t *bits = opaque.GetRow(row - y);
+                uint64_t *covered = mCovered.data() + (size_t)row * mWords;
+                for (int word = firstWord; word <= lastWord; word++)
+                {
+                    covered[word] |= GetBits(bits, opaque.mWords, word * 64 - x);
+                }
+            }
+        }
+
+        mKeep[i] = 1;
+    }
+
+    list->Keep(mKeep);
+    mNumDrawn = list->GetSize();
+}
@@ -0,0 +1,95 @@
+/**
+ * @file OcclusionCuller.h
+ * @author timan
+ *
+ * Removes sprites that would be drawn over completely
+ */
+
+#ifndef CITY_CITYLIB_OCCLUSIONCULLER_H
+#define CITY_CITYLIB_OCCLUSIONCULLER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "SpriteAtlas.h"
+
+class DrawList;
+
+/**
+ * Removes sprites that would be drawn over completely.
+ *
+ * In the isometric view most of a tile is overlapped by the
+ * tiles drawn after it, and a grass tile behind a building is
+ * often hidden entirely. The culler walks a draw list front to
+ * back, keeping one bit for each pixel of the view that an
+ * opaque pixel has already covered. A sprite whose pixels that
+ * are not fully transparent are all covered cannot change the
+ * frame, so it is removed; otherwise its opaque pixels are added
+ * to the coverage. Sprites outside of the view are removed too.
+ * What remains draws exactly the same frame.
+ *
+ * Removing hidden sprites is off unless it is enabled from the
+ * View menu, since on the cities measured so far it takes longer
+ * than it saves compositing; CityBench cull reports both. Sprites
+ * outside of the view are always removed.
+ */
+class OcclusionCuller
+{
+private:
+    /// Pixels of the view covered so far, row by row, 64 to a word
+    std::vector<uint64_t> mCovered;
+
+    /// Words in each row of the coverage
+    int mWords = 0;
+
+    /// For each sprite in the list, nonzero to keep it
+    std::vector<char> mKeep;
+
+    /// Are hidden sprites removed?
+    bool mEnabled = false;
+
+    /// Sprites kept by the last cull
+    int mNumDrawn = 0;
+
+    /// Sprites removed by the last cull because they were covered
+    int mNumOccluded = 0;
+
+    /// Sprites removed by the last cull because they were outside of the view
+    int mNumOffscreen = 0;
+
+public:
+    void Cull(DrawList *list, const SpriteAtlas &atlas, const wxRect &view);
+
+    /**
+     * Set whether hidden sprites are removed. Sprites
+     * outside of the view are removed either way.
+     * @param enabled true to remove hidden sprites
+     */
+    void SetEnabled(bool enabled) { mEnabled = enabled; }
+
+    /**
+     * Are hidden sprites removed?
+     * @return true if hidden sprites are removed
+     */
+    bool IsEnabled() const { return mEnabled; }
+
+    /**
+     * Get the number of sprites kept by the last cull
+     * @return Number of sprites drawn
+     */
+    int GetNumDrawn() const { return mNumDrawn; }
+
+    /**
+     * Get the number of sprites the last cull removed because they were covered
+     * @return Number of sprites
+     */
+    int GetNumOccluded() const { return mNumOccluded; }
+
+    /**
+     * Get the number of sprites the last cull removed because they were outside of the view
+     * @return Number of sprites
+     */
+    int GetNumOffscreen() const { return mNumOffscreen; }
+};
+
+#endif //CITY_CITYLIB_OCCLUSIONCULLER_H
@@ -0,0 +1,300 @@
+/**
+ * @file ReportExporter.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+
+#include "ReportExporter.h"
+#include "BufferedWriter.h"
+#include "City.h"
+#include "MemberReport.h"
+
+/**
+ * Constructor
+ * @param city The city we are exporting
+ */
+ReportExporter::ReportExporter(City *city) : mCity(city)
+{
+}
+
+/**
+ * Export the report, choosing the format from the file
+ * extension. Files ending in .json are written as JSON,
+ * everything else as CSV.
+ * @param filename File to write
+ * @return true if successful
+ */
+bool ReportExporter::Export(const std::wstring &filename)
+{
+    const std::wstring json = L".json";
+    if (filename.size() >= json.size() &&
+        filename.compare(filename.size() - json.size(), json.size(), json) == 0)
+    {
+        return ExportJson(filename);
+    }
+
+    return ExportCsv(filename);
+}
+
+/**
+ * Export the report as CSV.
+ *
+ * Every row has the same columns. Tile rows come first,
+ * followed by rows for the counts by type, by building
+ * and by region. Region rows put the region column and
+ * row in the x and y columns.
+ * @param filename File to write
+ * @return true if successful
+ */
+bool ReportExporter::ExportCsv(const std::wstring &filename)
+{
+    BufferedWriter writer;
+    if (!writer.Open(filename))
+    {
+        return false;
+    }
+
+    writer.Write("record,x,y,type,file,report,count\n");
+
+    for (auto tile : *mCity)
+    {
+        writer.Write("tile,");
+        writer.Write(tile->GetX());
+        writer.Write(',');
+        writer.Write(tile->GetY());
+        writer.Write(',');
+        WriteCsvString(writer, TileTypeName(tile->GetType()));
+        writer.Write(',');
+        WriteCsvString(writer, tile->GetFile());
+        writer.Write(',');
+        WriteCsvString(writer, TileReport(tile.get()));
+        writer.Write(",\n");
+    }
+
+    auto &statistics = mCity->GetStatistics();
+    for (int t = 0; t < NumTileTypes; t++)
+    {
+        writer.Write("type,,,");
+        WriteCsvString(writer, TileTypeName(TileType(t)));
+        writer.Write(",,,");
+        writer.Write(statistics.GetCount(TileType(t)));
+        writer.Write('\n');
+    }
+
+    for (auto &building : statistics.GetBuildingCounts())
+    {
+        writer.Write("building,,,");
+        WriteCsvString(writer, TileTypeName(TileType::Building));
+        writer.Write(',');
+        WriteCsvString(writer, building.first);
+        writer.Write(",,");
+        writer.Write(building.second);
+        writer.Write('\n');
+    }
+
+    for (auto &region : statistics.GetRegionCounts())
+    {
+        for (int t = 0; t < NumTileTypes; t++)
+        {
+            if (region.second[t] == 0)
+            {
+                continue;
+            }
+
+            writer.Write("region,");
+            writer.Write(region.first.first);
+            writer.Write(',');
+            writer.Write(region.first.second);
+            writer.Write(',');
+            WriteCsvString(writer, TileTypeName(TileType(t)));
+            writer.Write(",,,");
+            writer.Write(region.second[t]);
+            writer.Write('\n');
+        }
+    }
+
+    return writer.Close();
+}
+
+/**
+ * Export the report as JSON.
+ *
+ * The document is an object with a "tiles" array and
+ * "types", "buildings" and "regions" aggregates.
+ * @param filename File to write
+ * @return true if successful
+ */
+bool ReportExporter::ExportJson(const std::wstring &filename)
+{
+    BufferedWriter writer;
+    if (!writer.Open(filename))
+    {
+        return false;
+    }
+
+    writer.Write("{\n\"tiles\": [");
+
+    bool first = true;
+    for (auto tile : *mCity)
+    {
+        writer.Write(first ? "\n" : ",\n");
+        first = false;
+
+        writer.Write("{\"x\": ");
+        writer.Write(tile->GetX());
+        writer.Write(", \"y\": ");
+        writer.Write(tile->GetY());
+        writer.Write(", \"type\": ");
+        WriteJsonString(writer, TileTypeName(tile->GetType()));
+        writer.Write(", \"file\": ");
+        WriteJsonString(writer, tile->GetFile());
+        writer.Write(", \"report\": ");
+        WriteJsonString(writer, TileReport(tile.get()));
+        writer.Write('}');
+    }
+
+    auto &statistics = mCity->GetStatistics();
+
+    writer.Write("\n],\n\"types\": {");
+    for (int t = 0; t < NumTileTypes; t++)
+    {
+        writer.Write(t == 0 ? "\n" : ",\n");
+        WriteJsonString(writer, TileTypeName(TileType(t)));
+        writer.Write(": ");
+        writer.Write(statistics.GetCount(TileType(t)));
+    }
+
+    writer.Write("\n},\n\"buildings\": {");
+    first = true;
+    for (auto &building : statistics.GetBuildingCounts())
+    {
+        writer.Write(first ? "\n" : ",\n");
+        first = false;
+        WriteJsonString(writer, building.first);
+        writer.Write(": ");
+        writer.Write(building.second);
+    }
+
+    writer.Write("\n},\n\"regions\": [");
+    first = true;
+    for (auto &region : statistics.GetRegionCounts())
+    {
+        writer.Write(first ? "\n" : ",\n");
+        first = false;
+        writer.Write("{\"column\": ");
+        writer.Write(region.first.first);
+        writer.Write(", \"row\": ");
+        writer.Write(region.first.second);
+        for (int t = 0; t < NumTileTypes; t++)
+        {
+            writer.Write(", ");
+            WriteJsonString(writer, TileTypeName(TileType(t)));
+            writer.Write(": ");
+            writer.Write(region.second[t]);
+        }
+
+        writer.Write('}');
+    }
+
+    writer.Write("\n]\n}\n");
+
+    return writer.Close();
+}
+
+/**
+ * Get the report text a tile generates for the city report.
+ *
+ * One member report is reused for every tile, so the
+ * export does not allocate a report per tile.
+ * @param tile Tile to report on
+ * @return Report text
+ */
+const std::wstring &ReportExporter::TileReport(Tile *tile)
+{
+    if (mMemberReport == nullptr)
+    {
+        mMemberReport = std::make_shared<MemberReport>(nullptr);
+    }
+
+    mMemberReport->SetReport(L"");
+    tile->Report(mMemberReport);
+    return mMemberReport->GetReport();
+}
+
+/**
+ * Write a CSV field, quoting it if necessary
+ * @param writer Writer to write to
+ * @param str Field value
+ */
+void ReportExporter::WriteCsvString(BufferedWriter &writer, const std::wstring &str)
+{
+    if (str.find_first_of(L",\"\r\n") == std::wstring::npos)
+    {
+        writer.Write(str);
+        return;
+    }
+
+    writer.Write('"');
+    for (wchar_t c : str)
+    {
+        if (c == L'"')
+        {
+            writer.Write('"');
+        }
+
+        writer.Write(c);
+    }
+
+    writer.Write('"');
+}
+
+/**
+ * Write a JSON string literal
+ * @param writer Writer to write to
+ * @param str String value
+ */
+void ReportExporter::WriteJsonString(BufferedWriter &writer, const std::wstring &str)
+{
+    writer.Write('"');
+    for (wchar_t c : str)
+    {
+        switch (c)
+        {
+            case L'"':
+                writer.Write("\\\"");
+                break;
+
+            case L'\\':
+                writer.Write("\\\\");
+                break;
+
+            case L'\n':
+                writer.Write("\\n");
+                break;
+
+            case L'\r':
+                writer.Write("\\r");
+                break;
+
+            case L'\t':
+                writer.Write("\\t");
+                break;
+
+            default:
+                if (c < 0x20)
+                {
+                    char escape[8];
+                    snprintf(escape, sizeof(escape), "\\u%04x", (int)c);
+                    writer.Write(escape);
+                }
+                else
+                {
+                    writer.Write(c);
+                }
+                break;
+        }
+    }
+
+    writer.Write('"');
+}
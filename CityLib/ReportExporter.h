@@ -0,0 +1,48 @@
+/**
+ * @file ReportExporter.h
+ * @author timan
+ *
+ * Exports the city report to CSV or JSON files
+ */
+
+#ifndef CITY_CITYLIB_REPORTEXPORTER_H
+#define CITY_CITYLIB_REPORTEXPORTER_H
+
+#include <memory>
+#include <string>
+
+class City;
+class Tile;
+class MemberReport;
+class BufferedWriter;
+
+/**
+ * Exports the city report to CSV or JSON files.
+ *
+ * The export makes a single pass over the city, streaming
+ * one record per tile through a buffered writer, followed
+ * by the aggregate counts from the city statistics. Memory
+ * use does not depend on the size of the city.
+ */
+class ReportExporter
+{
+private:
+    void WriteCsvString(BufferedWriter &writer, const std::wstring &str);
+    void WriteJsonString(BufferedWriter &writer, const std::wstring &str);
+    const std::wstring &TileReport(Tile *tile);
+
+    /// The city we are exporting
+    City *mCity;
+
+    /// Member report reused to get the report text for each tile
+    std::shared_ptr<MemberReport> mMemberReport;
+
+public:
+    explicit ReportExporter(City *city);
+
+    bool Export(const std::wstring &filename);
+    bool ExportCsv(const std::wstring &filename);
+    bool ExportJson(const std::wstring &filename);
+};
+
+#endif //CITY_CITYLIB_REPORTEXPORTER_H
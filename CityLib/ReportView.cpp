@@ -0,0 +1,503 @@
+/**
+ * @file ReportView.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cwchar>
+
+#include "ReportView.h"
+#include "CityReport.h"
+#include "MemberReport.h"
+#include "CityStatistics.h"
+#include "ServiceCoverage.h"
+#include "LandValue.h"
+#include "BuildingSimulation.h"
+#include "Tile.h"
+#include "TextCache.h"
+
+/// Height of a line of text in the report in pixels
+const int RowHeight = 15;
+
+/// Number of rows in the economy grouping
+const int EconomyRows = 5;
+
+/// Longest piece of a line formatted at once, in characters
+const int MaxFormatLength = 256;
+
+/**
+ * Set the report this view displays
+ * @param report City report
+ */
+void ReportView::SetReport(std::shared_ptr<CityReport> report)
+{
+    if (report != mReport)
+    {
+        mReport = report;
+        mRevision = -1;
+    }
+}
+
+/**
+ * Draw the visible part of the report.
+ * @param dc Device context to draw on
+ * @param x Left side of the report in pixels
+ * @param y Top of the report in pixels
+ * @param height Height available for the report in pixels
+ */
+void ReportView::Draw(wxDC *dc, int x, int y, int height)
+{
+    UpdateRows();
+    UpdateCoverageRows();
+    UpdateLandValueRows();
+    UpdateGroupRows();
+
+    if (mText != nullptr)
+    {
+        mText->NextFrame();
+    }
+
+    int numRows = GetNumRows();
+
+    // One row is used by the title
+    mVisibleRows = std::max(height / RowHeight - 1, 1);
+    mFirstRow = std::max(std::min(mFirstRow, numRows - mVisibleRows), 0);
+    int lastRow = std::min(mFirstRow + mVisibleRows, numRows);
+
+    if (numRows > mVisibleRows)
+    {
+        DrawLine(dc, FormatLine(L"City Report (%d-%d of %d)", mFirstRow + 1, lastRow, numRows), x, y);
+    }
+    else
+    {
+        DrawLine(dc, FormatLine(L"City Report"), x, y);
+    }
+
+    y += RowHeight;
+
+    if (mGrouping != Grouping::Tiles)
+    {
+        DrawGroupRows(dc, x, y, mFirstRow, lastRow);
+        return;
+    }
+
+    for (int row = mFirstRow; row < lastRow; row++)
+    {
+        DrawLine(dc, mRows[row]->Report(), x, y);
+        y += RowHeight;
+    }
+}
+
+/**
+ * Get the number of rows in the view for the current grouping
+ * @return Number of rows
+ */
+int ReportView::GetNumRows()
+{
+    if (mGrouping == Grouping::Tiles)
+    {
+        return (int)mRows.size();
+    }
+
+    if (mGrouping == Grouping::Coverage)
+    {
+        return (int)mCoverageRows.size();
+    }
+
+    if (mGrouping == Grouping::LandValue)
+    {
+        return (int)mLandValueRows.size();
+    }
+
+    if (mGrouping == Grouping::Economy)
+    {
+        return mSimulation != nullptr ? EconomyRows : 0;
+    }
+
+    if (mStatistics == nullptr)
+    {
+        return 0;
+    }
+
+    switch (mGrouping)
+    {
+        case Grouping::Type:
+            return NumTileTypes;
+
+        case Grouping::Building:
+            return (int)mStatistics->GetBuildingCounts().size();
+
+        default:
+            return (int)mStatistics->GetRegionCounts().size();
+    }
+}
+
+/**
+ * Draw rows of a grouped report
+ * @param dc Device context to draw on
+ * @param x Left side of the rows in pixels
+ * @param y Top of the first row in pixels
+ * @param first First row to draw
+ * @param last One past the last row to draw
+ */
+void ReportView::DrawGroupRows(wxDC *dc, int x, int y, int first, int last)
+{
+    if (mGrouping == Grouping::Type)
+    {
+        for (int row = first; row < last; row++)
+        {
+            auto type = TileType(row);
+            DrawLine(dc, FormatLine(L"%ls: %d", TileTypeName(type), mStatistics->GetCount(type)), x, y);
+            y += RowHeight;
+        }
+    }
+    else if (mGrouping == Grouping::Building)
+    {
+        for (int row = first; row < last; row++)
+        {
+            auto &building = mBuildingRows[row];
+            DrawLine(dc, FormatLine(L"%ls: %d", building->first.c_str(), building->second), x, y);
+            y += RowHeight;
+        }
+    }
+    else if (mGrouping == Grouping::Coverage || mGrouping == Grouping::LandValue)
+    {
+        auto &rows = mGrouping == Grouping::Coverage ? mCoverageRows : mLandValueRows;
+        for (int row = first; row < last; row++)
+        {
+            DrawLine(dc, rows[row], x, y);
+            y += RowHeight;
+        }
+    }
+    else if (mGrouping == Grouping::Economy)
+    {
+        auto &totals = mSimulation->GetTotals();
+        for (int row = first; row < last; row++)
+        {
+            switch (row)
+            {
+                case 0:
+                    FormatLine(L"Population: %.0f", totals.mPopulation);
+                    break;
+
+                case 1:
+                    FormatLine(L"Jobs: %.0f", totals.mJobs);
+                    break;
+
+                case 2:
+                    FormatLine(L"Employed: %.0f", totals.mEmployed);
+                    break;
+
+                case 3:
+                    FormatLine(L"Upkeep: %.2f per second", totals.mUpkeep);
+                    break;
+
+                default:
+                    FormatLine(L"Funds: %.2f", totals.mFunds);
+                    break;
+            }
+
+            DrawLine(dc, mLine, x, y);
+            y += RowHeight;
+        }
+    }
+    else
+    {
+        for (int row = first; row < last; row++)
+        {
+            auto &region = mRegionRows[row];
+            FormatLine(L"Region %d, %d:", region->first.first, region->first.second);
+            for (int t = 0; t < NumTileTypes; t++)
+            {
+                AppendLine(L" %ls %d", TileTypeName(TileType(t)), region->second[t]);
+            }
+
+            DrawLine(dc, mLine, x, y);
+            y += RowHeight;
+        }
+    }
+}
+
+/**
+ * Set how the report rows are grouped
+ * @param grouping New grouping
+ */
+void ReportView::SetGrouping(Grouping grouping)
+{
+    mGrouping = grouping;
+    mFirstRow = 0;
+}
+
+/**
+ * Scroll the view
+ * @param rows Number of rows to scroll, positive scrolls down
+ */
+void ReportView::Scroll(int rows)
+{
+    mFirstRow = std::max(mFirstRow + rows, 0);
+}
+
+/**
+ * Set the order the rows are displayed in
+ * @param order New sort order
+ */
+void ReportView::SetSortOrder(SortOrder order)
+{
+    mSortOrder = order;
+    mRevision = -1;
+}
+
+/**
+ * Only show rows for one type of tile
+ * @param type Type of tile to show
+ */
+void ReportView::SetFilter(TileType type)
+{
+    mFiltered = true;
+    mFilterType = type;
+    mFirstRow = 0;
+    mRevision = -1;
+}
+
+/**
+ * Show rows for all types of tile
+ */
+void ReportView::ClearFilter()
+{
+    mFiltered = false;
+    mFirstRow = 0;
+    mRevision = -1;
+}
+
+/**
+ * Bring the list of rows up to date with the report.
+ *
+ * This only does any work when the report, filter or sort
+ * order has changed since the rows were last built.
+ */
+void ReportView::UpdateRows()
+{
+    if (mReport == nullptr)
+    {
+        mRows.clear();
+        return;
+    }
+
+    if (mRevision == mReport->GetRevision())
+    {
+        return;
+    }
+
+    mRevision = mReport->GetRevision();
+    mRows.clear();
+    for (auto memberReport : *mReport)
+    {
+        if (!mFiltered || memberReport->GetTile()->GetType() == mFilterType)
+        {
+            mRows.push_back(memberReport.get());
+        }
+    }
+
+    switch (mSortOrder)
+    {
+        case SortOrder::Report:
+            break;
+
+        case SortOrder::Position:
+            std::stable_sort(mRows.begin(), mRows.end(), [](MemberReport *a, MemberReport *b) {
+                Tile *tileA = a->GetTile();
+                Tile *tileB = b->GetTile();
+                if (tileA->GetY() != tileB->GetY())
+                {
+                    return tileA->GetY() < tileB->GetY();
+                }
+
+                return tileA->GetX() < tileB->GetX();
+            });
+            break;
+
+        case SortOrder::Type:
+            std::stable_sort(mRows.begin(), mRows.end(), [](MemberReport *a, MemberReport *b) {
+                return a->GetTile()->GetType() < b->GetTile()->GetType();
+            });
+            break;
+    }
+}
+
+/**
+ * Bring the rows of the building and region groupings up to date.
+ *
+ * The rows are iterators into the statistics, so the counts drawn
+ * are always current and the rows only need rebuilding when a
+ * building image or region comes or goes. Drawing a scrolled view
+ * then goes straight to its first row.
+ */
+void ReportView::UpdateGroupRows()
+{
+    if ((mGrouping != Grouping::Building && mGrouping != Grouping::Region) || mStatistics == nullptr ||
+        mGroupsRevision == mStatistics->GetGroupsRevision())
+    {
+        return;
+    }
+
+    mGroupsRevision = mStatistics->GetGroupsRevision();
+
+    auto &buildings = mStatistics->GetBuildingCounts();
+    mBuildingRows.clear();
+    for (auto building = buildings.begin(); building != buildings.end(); ++building)
+    {
+        mBuildingRows.push_back(building);
+    }
+
+    auto &regions = mStatistics->GetRegionCounts();
+    mRegionRows.clear();
+    for (auto region = regions.begin(); region != regions.end(); ++region)
+    {
+        mRegionRows.push_back(region);
+    }
+}
+
+/**
+ * Bring the rows of the coverage grouping up to date.
+ *
+ * This only does any work when the coverage grouping is
+ * shown and the distances have changed.
+ */
+void ReportView::UpdateCoverageRows()
+{
+    if (mGrouping != Grouping::Coverage || mCoverage == nullptr ||
+        mCoverageRevision == mCoverage->GetRevision())
+    {
+        return;
+    }
+
+    mCoverageRevision = mCoverage->GetRevision();
+    mCoverageRows.clear();
+    auto coverage = mCoverage->GetSnapshot();
+    for (int s = 0; s < ServiceCoverage::NumServices; s++)
+    {
+        auto service = ServiceCoverage::Service(s);
+        auto name = ServiceCoverage::GetServiceName(service);
+        auto &summary = coverage->GetSummary(service);
+
+        mCoverageRows.push_back(wxString::Format(L"%ls: %d buildings", name, summary.mBuildings).ToStdWstring());
+        for (int distance = 0; distance < (int)summary.mDistances.size(); distance++)
+        {
+            if (summary.mDistances[distance] > 0)
+            {
+                mCoverageRows.push_back(wxString::Format(L"%ls at distance %d: %d locations",
+                        name, distance, summary.mDistances[distance]).ToStdWstring());
+            }
+        }
+
+        mCoverageRows.push_back(wxString::Format(L"%ls out of reach: %d locations",
+                name, summary.mUnreachable).ToStdWstring());
+    }
+}
+
+/**
+ * Bring the rows of the land value grouping up to date.
+ *
+ * This only does any work when the land value grouping is
+ * shown and a tick has passed.
+ */
+void ReportView::UpdateLandValueRows()
+{
+    if (mGrouping != Grouping::LandValue || mLandValue == nullptr ||
+        mLandValueRevision == mLandValue->GetRevision())
+    {
+        return;
+    }
+
+    mLandValueRevision = mLandValue->GetRevision();
+    mLandValueRows.clear();
+
+    auto averages = mLandValue->GetAverages();
+    for (int t = 0; t < NumTileTypes; t++)
+    {
+        mLandValueRows.push_back(wxString::Format(L"%ls: average land value %.2f",
+                TileTypeName(TileType(t)), averages[t]).ToStdWstring());
+    }
+}
+
+/**
+ * Draw a line of the report
+ * @param dc Device context to draw on
+ * @param text Text of the line
+ * @param x Left of the line in pixels
+ * @param y Top of the line in pixels
+ */
+void ReportView::DrawLine(wxDC *dc, const std::wstring &text, int x, int y)
+{
+    if (mText != nullptr)
+    {
+        mText->Draw(dc, text, x, y);
+    }
+    else
+    {
+        dc->DrawText(text, x, y);
+    }
+}
+
+/**
+ * Format text into a buffer of MaxFormatLength characters.
+ *
+ * Text too long for the buffer is cut off at the end of the
+ * buffer rather than lost. The buffer must start out zeroed,
+ * so whatever was written before a failure is terminated.
+ * @param buffer Buffer to format into
+ * @param format printf style format of the text
+ * @param args Arguments for the format
+ * @return Number of characters in the buffer
+ */
+static int FormatText(wchar_t *buffer, const wchar_t *format, va_list args)
+{
+    int length = std::vswprintf(buffer, MaxFormatLength, format, args);
+    if (length < 0)
+    {
+        buffer[MaxFormatLength - 1] = 0;
+        length = (int)std::wcslen(buffer);
+    }
+
+    return length;
+}
+
+/**
+ * Format a line of the report into mLine
+ *
+ * mLine keeps its memory from line to line, so once it
+ * has grown to fit the longest line, formatting the lines
+ * of each frame does not allocate.
+ *
+ * @param format printf style format of the line
+ * @return The formatted line
+ */
+const std::wstring &ReportView::FormatLine(const wchar_t *format, ...)
+{
+    wchar_t buffer[MaxFormatLength] = {};
+    va_list args;
+    va_start(args, format);
+    int length = FormatText(buffer, format, args);
+    va_end(args);
+
+    mLine.assign(buffer, length);
+    return mLine;
+}
+
+/**
+ * Add formatted text to the end of the line in mLine
+ * @param format printf style format of the text
+ */
+void ReportView::AppendLine(const wchar_t *format, ...)
+{
+    wchar_t buffer[MaxFormatLength] = {};
+    va_list args;
+    va_start(args, format);
+    int length = FormatText(buffer, format, args);
+    va_end(args);
+
+    mLine.append(buffer, length);
+}
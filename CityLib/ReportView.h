@@ -0,0 +1,198 @@
+/**
+ * @file ReportView.h
+ * @author timan
+ *
+ * A scrollable, virtualized view of the city report
+ */
+
+#ifndef CITY_CITYLIB_REPORTVIEW_H
+#define CITY_CITYLIB_REPORTVIEW_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "TileType.h"
+#include "CityStatistics.h"
+
+class CityReport;
+class ServiceCoverage;
+class LandValue;
+class BuildingSimulation;
+class MemberReport;
+class TextCache;
+
+/**
+ * A scrollable, virtualized view of the city report.
+ *
+ * The view keeps an ordered list of pointers into the
+ * report, so sorting and filtering never copy the report
+ * itself. Only the rows that fit in the window are
+ * formatted and drawn.
+ *
+ * The view can also show the report grouped by tile type,
+ * building or region. Grouped rows come straight from the
+ * live city statistics. The service coverage grouping lists
+ * how many locations are at each distance from a service, the
+ * land value grouping the average value under each type, and
+ * the economy grouping the totals of the building simulation.
+ *
+ * Lines are drawn through a text cache when one is set, so
+ * a line that has not changed is not laid out again.
+ */
+class ReportView
+{
+public:
+    /// The orders the report rows can be sorted in
+    enum class SortOrder { Report, Position, Type };
+
+    /// The ways the report rows can be grouped
+    enum class Grouping { Tiles, Type, Building, Region, Coverage, LandValue, Economy };
+
+private:
+    void UpdateRows();
+    void UpdateCoverageRows();
+    void UpdateLandValueRows();
+    void UpdateGroupRows();
+    int GetNumRows();
+    void DrawGroupRows(wxDC *dc, int x, int y, int first, int last);
+    void DrawLine(wxDC *dc, const std::wstring &text, int x, int y);
+    const std::wstring &FormatLine(const wchar_t *format, ...);
+    void AppendLine(const wchar_t *format, ...);
+
+    /// The report we are viewing
+    std::shared_ptr<CityReport> mReport;
+
+    /// Statistics used for the grouped reports
+    const CityStatistics *mStatistics = nullptr;
+
+    /// Service coverage used for the coverage grouping
+    ServiceCoverage *mCoverage = nullptr;
+
+    /// Rows of the coverage grouping
+    std::vector<std::wstring> mCoverageRows;
+
+    /// Coverage revision mCoverageRows was built from
+    int mCoverageRevision = -1;
+
+    /// Land value used for the land value grouping
+    LandValue *mLandValue = nullptr;
+
+    /// Rows of the land value grouping
+    std::vector<std::wstring> mLandValueRows;
+
+    /// Land value revision mLandValueRows was built from
+    int mLandValueRevision = -1;
+
+    /// Rows of the building grouping, in the order of the statistics
+    std::vector<std::map<std::wstring, int>::const_iterator> mBuildingRows;
+
+    /// Rows of the region grouping, in the order of the statistics
+    std::vector<std::map<CityStatistics::Region, CityStatistics::TypeCounts>::const_iterator> mRegionRows;
+
+    /// Statistics groups revision mBuildingRows and mRegionRows were built from
+    int mGroupsRevision = -1;
+
+    /// Building simulation used for the economy grouping
+    const BuildingSimulation *mSimulation = nullptr;
+
+    /// Rendered lines of text, or nullptr to draw text directly
+    TextCache *mText = nullptr;
+
+    /// Line being formatted, kept so formatting does not allocate
+    std::wstring mLine;
+
+    /// Current grouping
+    Grouping mGrouping = Grouping::Tiles;
+
+    /// The rows that pass the filter, in display order
+    std::vector<MemberReport *> mRows;
+
+    /// Report revision mRows was built from
+    int mRevision = -1;
+
+    /// Current sort order
+    SortOrder mSortOrder = SortOrder::Report;
+
+    /// Are we only showing one type of tile?
+    bool mFiltered = false;
+
+    /// The type of tile shown when mFiltered is true
+    TileType mFilterType = TileType::Landscape;
+
+    /// The first row visible at the top of the view
+    int mFirstRow = 0;
+
+    /// How many rows fit in the view the last time it was drawn
+    int mVisibleRows = 0;
+
+public:
+    void SetReport(std::shared_ptr<CityReport> report);
+
+    /**
+     * Set the statistics used for the grouped reports
+     * @param statistics City statistics
+     */
+    void SetStatistics(const CityStatistics *statistics) { mStatistics = statistics; mGroupsRevision = -1; }
+
+    /**
+     * Set the service coverage used for the coverage grouping
+     * @param coverage Service coverage
+     */
+    void SetCoverage(ServiceCoverage *coverage) { mCoverage = coverage; }
+
+    /**
+     * Set the land value used for the land value grouping
+     * @param landValue Land value
+     */
+    void SetLandValue(LandValue *landValue) { mLandValue = landValue; }
+
+    /**
+     * Set the building simulation used for the economy grouping
+     * @param simulation Building simulation
+     */
+    void SetSimulation(const BuildingSimulation *simulation) { mSimulation = simulation; }
+
+    /**
+     * Set the cache the lines of the report are drawn through
+     * @param text Text cache, or nullptr to draw text directly
+     */
+    void SetTextCache(TextCache *text) { mText = text; }
+
+    void Draw(wxDC *dc, int x, int y, int height);
+
+    void SetGrouping(Grouping grouping);
+
+    /**
+     * Get the current grouping
+     * @return Grouping
+     */
+    Grouping GetGrouping() const { return mGrouping; }
+
+    void Scroll(int rows);
+
+    void SetSortOrder(SortOrder order);
+
+    /**
+     * Get the current sort order
+     * @return Sort order
+     */
+    SortOrder GetSortOrder() const { return mSortOrder; }
+
+    void SetFilter(TileType type);
+    void ClearFilter();
+
+    /**
+     * Is the view only showing one type of tile?
+     * @return true if filtered
+     */
+    bool IsFiltered() const { return mFiltered; }
+
+    /**
+     * Get the type of tile shown when filtered
+     * @return Tile type
+     */
+    TileType GetFilterType() const { return mFilterType; }
+};
+
+#endif //CITY_CITYLIB_REPORTVIEW_H
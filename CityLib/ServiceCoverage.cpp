@@ -0,0 +1,602 @@
+/**
+ * @file ServiceCoverage.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+
+#include <functional>
+#include <queue>
+#include <utility>
+
+#include "ServiceCoverage.h"
+#include "City.h"
+
+/// Image files of the buildings providing each service
+const wchar_t *ServiceImages[ServiceCoverage::NumServices] = {L"firestation.png", L"hospital.png"};
+
+/// Names of the services
+const wchar_t *ServiceNames[ServiceCoverage::NumServices] = {L"Fire Station", L"Hospital"};
+
+/**
+ * Constructor
+ * @param city The city we are measuring
+ */
+ServiceCoverage::ServiceCoverage(City *city) : mCity(city)
+{
+    mThread = std::thread(&ServiceCoverage::ThreadMain, this);
+}
+
+/**
+ * Destructor
+ */
+ServiceCoverage::~ServiceCoverage()
+{
+    {
+        std::lock_guard<std::mutex> lock(mQueueMutex);
+        mStop = true;
+    }
+
+    mWake.notify_all();
+    mThread.join();
+}
+
+/**
+ * Get the name of a service
+ * @param service Service
+ * @return Name for display
+ */
+const wchar_t *ServiceCoverage::GetServiceName(Service service)
+{
+    return ServiceNames[(int)service];
+}
+
+/**
+ * Get the service a tile provides
+ * @param tile Tile to test
+ * @return Service index or -1 if none
+ */
+int ServiceCoverage::GetService(Tile *tile)
+{
+    if (tile->GetType() == TileType::Building)
+    {
+        for (int service = 0; service < NumServices; service++)
+        {
+            if (tile->GetFile() == ServiceImages[service])
+            {
+                return service;
+            }
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Call a function for the known locations adjacent to a location
+ * @param cell Grid location
+ * @param function Function to call with each neighbor and its Location
+ */
+template <typename Function>
+void ServiceCoverage::ForEachNeighbor(Cell cell, Function function)
+{
+    for (int i = 0; i < GridCell::NumNeighbors; i++)
+    {
+        Cell neighbor = GridCell::Neighbor(cell, i);
+        auto found = mLocations.find(neighbor);
+        if (found != mLocations.end())
+        {
+            function(neighbor, found->second);
+        }
+    }
+}
+
+/**
+ * Queue a tile arriving at or leaving a location
+ * @param tile The tile
+ * @param x X location in pixels
+ * @param y Y location in pixels
+ * @param delta 1 if the tile arrives, -1 if it leaves
+ */
+void ServiceCoverage::Queue(Tile *tile, int x, int y, int delta)
+{
+    if (tile->GetType() == TileType::Water)
+    {
+        // Water cannot be crossed, so it changes nothing we measure
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mQueueMutex);
+        mQueue.push_back({City::GetGridCell(x, y), delta, GetService(tile)});
+    }
+
+    mWake.notify_one();
+}
+
+/**
+ * The thread that computes the distances
+ */
+void ServiceCoverage::ThreadMain()
+{
+    std::unique_lock<std::mutex> lock(mQueueMutex);
+    for ( ; ; )
+    {
+        mWake.wait(lock, [this] { return mStop || mReset || !mQueue.empty(); });
+        if (mStop)
+        {
+            return;
+        }
+
+        bool reset = mReset;
+        mReset = false;
+        std::vector<Change> changes;
+        changes.swap(mQueue);
+        mBusy = true;
+        lock.unlock();
+
+        if (reset)
+        {
+            mLocations.clear();
+            mNumBuildings = {};
+        }
+
+        for (auto &change : changes)
+        {
+            Apply(change, !reset);
+        }
+
+        if (reset)
+        {
+            Recompute();
+        }
+
+        Publish(reset);
+
+        lock.lock();
+        mBusy = false;
+        if (mQueue.empty() && !mReset)
+        {
+            mIdle.notify_all();
+        }
+    }
+}
+
+/**
+ * Apply a change to a location
+ * @param change The change
+ * @param update Update the distances? If false, only the
+ * tile counts change and Recompute must be called later.
+ */
+void ServiceCoverage::Apply(const Change &change, bool update)
+{
+    auto &location = mLocations[change.mCell];
+    bool wasWalkable = location.mWalkable > 0;
+    std::array<bool, NumServices> wasBuilding;
+    for (int service = 0; service < NumServices; service++)
+    {
+        wasBuilding[service] = location.mBuildings[service] > 0;
+    }
+
+    location.mWalkable += change.mDelta;
+    if (change.mService >= 0)
+    {
+        location.mBuildings[change.mService] += change.mDelta;
+        mNumBuildings[change.mService] += change.mDelta;
+    }
+
+    bool isWalkable = location.mWalkable > 0;
+    if (update)
+    {
+        for (int service = 0; service < NumServices; service++)
+        {
+            bool isBuilding = location.mBuildings[service] > 0;
+            if (isBuilding && !wasBuilding[service])
+            {
+                // A new service spreads shorter distances outward
+                location.mDistance[service] = 0;
+                location.mFrom[service] = change.mCell;
+                mChanged.insert(change.mCell);
+                Spread(service, {change.mCell});
+            }
+            else if (isWalkable && !wasWalkable)
+            {
+                // A new tile may open a shorter way through it
+                std::vector<Cell> neighbors;
+                ForEachNeighbor(change.mCell, [service, &neighbors](Cell neighbor, Location &other) {
+                    if (other.mDistance[service] != Unreachable)
+                    {
+                        neighbors.push_back(neighbor);
+                    }
+                });
+
+                mChanged.insert(change.mCell);
+                Spread(service, neighbors);
+            }
+            else if ((wasBuilding[service] && !isBuilding) || (wasWalkable && !isWalkable))
+            {
+                Invalidate(service, change.mCell);
+            }
+        }
+    }
+
+    if (!isWalkable)
+    {
+        mLocations.erase(change.mCell);
+        mChanged.insert(change.mCell);
+    }
+}
+
+/**
+ * Spread shorter distances outward from some locations
+ * whose distances are already correct.
+ * @param service Service index
+ * @param cells Locations to spread from
+ */
+void ServiceCoverage::Spread(int service, const std::vector<Cell> &cells)
+{
+    // Locations are visited in order of distance
+    typedef std::pair<int, Cell> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pending;
+    for (auto cell : cells)
+    {
+        pending.push(Entry(mLocations[cell].mDistance[service], cell));
+    }
+
+    while (!pending.empty())
+    {
+        auto entry = pending.top();
+        pending.pop();
+
+        int distance = entry.first;
+        Cell cell = entry.second;
+        if (mLocations[cell].mDistance[service] != distance)
+        {
+            // Reached again since this was queued
+            continue;
+        }
+
+        ForEachNeighbor(cell, [this, service, cell, distance, &pending](Cell neighbor, Location &other) {
+            int &otherDistance = other.mDistance[service];
+            if (other.mWalkable > 0 && (otherDistance == Unreachable || otherDistance > distance + 1))
+            {
+                otherDistance = distance + 1;
+                other.mFrom[service] = cell;
+                mChanged.insert(neighbor);
+                pending.push(Entry(distance + 1, neighbor));
+            }
+        });
+    }
+}
+
+/**
+ * Recompute distances after a location stops providing
+ * a service or can no longer be crossed.
+ *
+ * Every location reached through this one is cleared, then
+ * the cleared locations are filled in again from the services
+ * among them and from the neighbors around them.
+ * @param service Service index
+ * @param cell Location that changed
+ */
+void ServiceCoverage::Invalidate(int service, Cell cell)
+{
+    std::vector<Cell> cleared;
+    std::vector<Cell> pending;
+    mLocations[cell].mDistance[service] = Unreachable;
+    pending.push_back(cell);
+    while (!pending.empty())
+    {
+        Cell from = pending.back();
+        pending.pop_back();
+        cleared.push_back(from);
+        mChanged.insert(from);
+
+        ForEachNeighbor(from, [service, from, &pending](Cell neighbor, Location &other) {
+            if (other.mDistance[service] != Unreachable && other.mFrom[service] == from)
+            {
+                other.mDistance[service] = Unreachable;
+                pending.push_back(neighbor);
+            }
+        });
+    }
+
+    std::vector<Cell> seeds;
+    for (auto clearedCell : cleared)
+    {
+        auto &location = mLocations[clearedCell];
+        if (location.mBuildings[service] > 0)
+        {
+            location.mDistance[service] = 0;
+            location.mFrom[service] = clearedCell;
+            seeds.push_back(clearedCell);
+            continue;
+        }
+
+        ForEachNeighbor(clearedCell, [service, &seeds](Cell neighbor, Location &other) {
+            if (other.mDistance[service] != Unreachable)
+            {
+                seeds.push_back(neighbor);
+            }
+        });
+    }
+
+    Spread(service, seeds);
+}
+
+/**
+ * Compute every distance with a breadth-first
+ * search from all of the services at once
+ */
+void ServiceCoverage::Recompute()
+{
+    for (int service = 0; service < NumServices; service++)
+    {
+        std::vector<Cell> seeds;
+        for (auto &location : mLocations)
+        {
+            if (location.second.mBuildings[service] > 0)
+            {
+                location.second.mDistance[service] = 0;
+                location.second.mFrom[service] = location.first;
+                seeds.push_back(location.first);
+            }
+        }
+
+        Spread(service, seeds);
+    }
+}
+
+/**
+ * Add to or remove from the count of locations at a distance
+ * @param summary Summary to update
+ * @param distance Distance or Unreachable
+ * @param delta 1 to add a location, -1 to remove one
+ */
+void ServiceCoverage::Count(Summary &summary, int distance, int delta)
+{
+    if (distance == Unreachable)
+    {
+        summary.mUnreachable += delta;
+        return;
+    }
+
+    auto &distances = summary.mDistances;
+    if ((int)distances.size() <= distance)
+    {
+        distances.resize(distance + 1);
+    }
+
+    distances[distance] += delta;
+    while (!distances.empty() && distances.back() == 0)
+    {
+        distances.pop_back();
+    }
+}
+
+/**
+ * Bring the distances for one location in a snapshot up to date
+ * @param snapshot Snapshot to update
+ * @param cell Location that may have changed
+ */
+void ServiceCoverage::UpdateSnapshot(Snapshot &snapshot, Cell cell)
+{
+    auto result = snapshot.mDistances.find(cell);
+    if (result != snapshot.mDistances.end())
+    {
+        for (int service = 0; service < NumServices; service++)
+        {
+            Count(snapshot.mSummaries[service], result->second[service], -1);
+        }
+    }
+
+    auto location = mLocations.find(cell);
+    if (location == mLocations.end())
+    {
+        if (result != snapshot.mDistances.end())
+        {
+            snapshot.mDistances.erase(result);
+        }
+
+        return;
+    }
+
+    auto &distances = snapshot.mDistances[cell];
+    distances = location->second.mDistance;
+    for (int service = 0; service < NumServices; service++)
+    {
+        Count(snapshot.mSummaries[service], distances[service], 1);
+    }
+}
+
+/**
+ * Publish the distances that have changed
+ *
+ * The changes are made to a snapshot no reader can see, and
+ * only swapping it in is done under the lock, so readers wait
+ * for a pointer copy rather than for the whole city.
+ * @param all Publish every distance rather than just the changes
+ */
+void ServiceCoverage::Publish(bool all)
+{
+    std::shared_ptr<Snapshot> next;
+    if (all)
+    {
+        next = std::make_shared<Snapshot>();
+        mChanged.clear();
+        for (auto &location : mLocations)
+        {
+            mChanged.insert(location.first);
+        }
+    }
+    else if (mBack != nullptr && mBack.use_count() == 1)
+    {
+        // No reader still holds the snapshot published before
+        // the current one, so catch it up and use it again.
+        // The fence pairs with the readers releasing it.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        next = std::move(mBack);
+        for (auto cell : mBackChanged)
+        {
+            UpdateSnapshot(*next, cell);
+        }
+    }
+    else
+    {
+        // Only this thread swaps mResults, so it can be read without the lock
+        next = std::make_shared<Snapshot>(*mResults);
+    }
+
+    for (auto cell : mChanged)
+    {
+        UpdateSnapshot(*next, cell);
+    }
+
+    for (int service = 0; service < NumServices; service++)
+    {
+        next->mSummaries[service].mBuildings = mNumBuildings[service];
+    }
+
+    std::shared_ptr<const Snapshot> previous = std::move(next);
+    {
+        std::lock_guard<std::mutex> lock(mResultMutex);
+        mResults.swap(previous);
+    }
+
+    // The snapshot just replaced is missing this publish's changes.
+    // After publishing everything it is missing too much to catch up.
+    mBack = all ? nullptr : std::const_pointer_cast<Snapshot>(previous);
+    mBackChanged.clear();
+    if (!all)
+    {
+        mBackChanged.swap(mChanged);
+    }
+
+    mChanged.clear();
+    mRevision++;
+}
+
+/**
+ * Get the published results
+ *
+ * The snapshot does not change while it is held, so a
+ * reader looking up many locations should get it once.
+ * @return Snapshot of the distances and summaries
+ */
+std::shared_ptr<const ServiceCoverage::Snapshot> ServiceCoverage::GetSnapshot() const
+{
+    std::lock_guard<std::mutex> lock(mResultMutex);
+    return mResults;
+}
+
+/**
+ * Get the distance from a location to the nearest building providing a service
+ * @param service Service
+ * @param x X location in pixels
+ * @param y Y location in pixels
+ * @return Distance in steps between adjacent tiles or Unreachable
+ */
+int ServiceCoverage::Snapshot::GetDistance(Service service, int x, int y) const
+{
+    auto result = mDistances.find(City::GetGridCell(x, y));
+    return result != mDistances.end() ? result->second[(int)service] : Unreachable;
+}
+
+/**
+ * Get the distance from a location to the nearest building providing a service
+ * @param service Service
+ * @param x X location in pixels
+ * @param y Y location in pixels
+ * @return Distance in steps between adjacent tiles or Unreachable
+ */
+int ServiceCoverage::GetDistance(Service service, int x, int y) const
+{
+    return GetSnapshot()->GetDistance(service, x, y);
+}
+
+/**
+ * Get the coverage of a service across the city
+ * @param service Service
+ * @return Copy of the current summary
+ */
+ServiceCoverage::Summary ServiceCoverage::GetSummary(Service service) const
+{
+    return GetSnapshot()->GetSummary(service);
+}
+
+/**
+ * Wait until every change to the city has been measured
+ */
+void ServiceCoverage::Wait()
+{
+    std::unique_lock<std::mutex> lock(mQueueMutex);
+    mIdle.wait(lock, [this] { return !mBusy && !mReset && mQueue.empty(); });
+}
+
+/**
+ * A tile has been added to the city
+ * @param tile Tile that was added
+ */
+void ServiceCoverage::TileAdded(std::shared_ptr<Tile> tile)
+{
+    Queue(tile.get(), tile->GetX(), tile->GetY(), 1);
+}
+
+/**
+ * A tile is being removed from the city
+ * @param tile Tile that is being removed
+ */
+void ServiceCoverage::TileRemoved(std::shared_ptr<Tile> tile)
+{
+    Queue(tile.get(), tile->GetX(), tile->GetY(), -1);
+}
+
+/**
+ * A tile has moved, which may move it to another grid location
+ * @param tile Tile that moved
+ * @param oldX Previous X location of the tile
+ * @param oldY Previous Y location of the tile
+ */
+void ServiceCoverage::TileMoved(Tile *tile, int oldX, int oldY)
+{
+    if (City::GetGridCell(oldX, oldY) != City::GetGridCell(tile->GetX(), tile->GetY()))
+    {
+        Queue(tile, oldX, oldY, -1);
+        Queue(tile, tile->GetX(), tile->GetY(), 1);
+    }
+}
+
+/**
+ * The city has been cleared
+ */
+void ServiceCoverage::CityCleared()
+{
+    {
+        std::lock_guard<std::mutex> lock(mQueueMutex);
+        mQueue.clear();
+        mReset = true;
+    }
+
+    mWake.notify_one();
+}
+
+/**
+ * The city has been loaded
+ */
+void ServiceCoverage::CityLoaded()
+{
+    {
+        std::lock_guard<std::mutex> lock(mQueueMutex);
+        mQueue.clear();
+        mReset = true;
+        for (auto tile : *mCity)
+        {
+            if (tile->GetType() != TileType::Water)
+            {
+                mQueue.push_back({City::GetGridCell(tile->GetX(), tile->GetY()), 1, GetService(tile.get())});
+            }
+        }
+    }
+
+    mWake.notify_one();
+}
@@ -0,0 +1,233 @@
+/**
+ * @file ServiceCoverage.h
+ * @author timan
+ *
+ * Distance from every grid location to the nearest city services
+ */
+
+#ifndef CITY_CITYLIB_SERVICECOVERAGE_H
+#define CITY_CITYLIB_SERVICECOVERAGE_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "CityObserver.h"
+#include "GridCell.h"
+
+class City;
+
+/**
+ * Distance from every grid location to the nearest city services.
+ *
+ * Fire stations and hospitals are buildings with those images.
+ * For each service this keeps the number of steps between
+ * adjacent tiles, as City::GetAdjacent defines them, from
+ * every location to the nearest building providing it.
+ * Any location with a tile other than water can be crossed.
+ *
+ * The distances are computed on a thread of their own.
+ * Changes to the city are queued, and the thread updates only
+ * the locations whose distance changes: a new service or tile
+ * spreads shorter distances outward, and removing one clears
+ * just the locations that were reached through it and fills
+ * them in again from their neighbors. Loading a city computes
+ * everything with one breadth-first search from all services.
+ *
+ * The results are published as they are finished, so reading
+ * them never waits for the thread to catch up. The thread brings
+ * a snapshot of the results up to date while readers use another,
+ * and publishing only swaps which snapshot readers are given.
+ */
+class ServiceCoverage : public CityObserver
+{
+public:
+    /// The services we measure
+    enum class Service { FireStation, Hospital };
+
+    /// Number of services
+    static const int NumServices = 2;
+
+    /// Distance of a location no service can reach
+    static const int Unreachable = -1;
+
+    /// Coverage of one service across the city
+    struct Summary
+    {
+        /// Number of buildings providing the service
+        int mBuildings = 0;
+
+        /// Number of locations at each distance
+        std::vector<int> mDistances;
+
+        /// Number of locations the service cannot reach
+        int mUnreachable = 0;
+    };
+
+private:
+    /// A grid location packed into a single key
+    typedef GridCell::Key Cell;
+
+public:
+    /**
+     * The published distances and summaries at one moment.
+     *
+     * A snapshot does not change once it is published, so
+     * it can be read without locking for as long as it is held.
+     */
+    class Snapshot
+    {
+    private:
+        friend class ServiceCoverage;
+
+        /// Distances for each location that can be crossed
+        std::unordered_map<Cell, std::array<int, NumServices>> mDistances;
+
+        /// Summary for each service
+        std::array<Summary, NumServices> mSummaries;
+
+    public:
+        int GetDistance(Service service, int x, int y) const;
+
+        /**
+         * Get the coverage of a service across the city
+         * @param service Service
+         * @return Summary
+         */
+        const Summary &GetSummary(Service service) const { return mSummaries[(int)service]; }
+    };
+
+private:
+
+    /// A change to the tiles at a grid location
+    struct Change
+    {
+        Cell mCell;     ///< Grid location
+        int mDelta;     ///< 1 for a tile arriving, -1 for one leaving
+        int mService;   ///< Service the tile provides or -1
+    };
+
+    /// What the thread knows about a grid location
+    struct Location
+    {
+        /// Number of tiles that can be crossed
+        int mWalkable = 0;
+
+        /// Number of buildings providing each service
+        std::array<int, NumServices> mBuildings = {};
+
+        /// Distance to the nearest building providing each service
+        std::array<int, NumServices> mDistance = {Unreachable, Unreachable};
+
+        /// Neighbor the distance for each service was reached through
+        std::array<Cell, NumServices> mFrom = {};
+    };
+
+    static int GetService(Tile *tile);
+
+    void Queue(Tile *tile, int x, int y, int delta);
+    void ThreadMain();
+    void Apply(const Change &change, bool update);
+    void Recompute();
+    void Spread(int service, const std::vector<Cell> &cells);
+    void Invalidate(int service, Cell cell);
+    void Publish(bool all);
+    void UpdateSnapshot(Snapshot &snapshot, Cell cell);
+
+    template <typename Function>
+    void ForEachNeighbor(Cell cell, Function function);
+
+    static void Count(Summary &summary, int distance, int delta);
+
+    /// The city we are measuring
+    City *mCity;
+
+    /// The thread the distances are computed on
+    std::thread mThread;
+
+    /// Protects the queue of changes
+    std::mutex mQueueMutex;
+
+    /// Signalled when changes are queued or the thread stops
+    std::condition_variable mWake;
+
+    /// Signalled when the thread has no more work
+    std::condition_variable mIdle;
+
+    /// Changes not yet seen by the thread
+    std::vector<Change> mQueue;
+
+    /// Should the thread start over from an empty city?
+    bool mReset = false;
+
+    /// Is the thread working on changes?
+    bool mBusy = false;
+
+    /// Set when the thread should stop
+    bool mStop = false;
+
+    /// Grid locations known to the thread. Only the thread uses this.
+    std::unordered_map<Cell, Location> mLocations;
+
+    /// Number of buildings providing each service. Only the thread uses this.
+    std::array<int, NumServices> mNumBuildings = {};
+
+    /// Locations whose distances changed since they were last published
+    std::unordered_set<Cell> mChanged;
+
+    /// Protects which snapshot is published
+    mutable std::mutex mResultMutex;
+
+    /// The published results
+    std::shared_ptr<const Snapshot> mResults = std::make_shared<Snapshot>();
+
+    /// The snapshot published before mResults, reused for the next
+    /// one once no reader holds it. Only the thread uses this.
+    std::shared_ptr<Snapshot> mBack;
+
+    /// Locations changed in the last publish, which mBack is missing.
+    /// Only the thread uses this.
+    std::unordered_set<Cell> mBackChanged;
+
+    /// Incremented each time results are published
+    std::atomic<int> mRevision{0};
+
+public:
+    explicit ServiceCoverage(City *city);
+
+    /// Copy constructor (disabled)
+    ServiceCoverage(const ServiceCoverage &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const ServiceCoverage &) = delete;
+
+    virtual ~ServiceCoverage();
+
+    static const wchar_t *GetServiceName(Service service);
+
+    std::shared_ptr<const Snapshot> GetSnapshot() const;
+    int GetDistance(Service service, int x, int y) const;
+    Summary GetSummary(Service service) const;
+    void Wait();
+
+    /**
+     * Get the revision of the published results. This
+     * changes whenever any distance changes.
+     * @return Revision number
+     */
+    int GetRevision() const { return mRevision; }
+
+    void TileAdded(std::shared_ptr<Tile> tile) override;
+    void TileRemoved(std::shared_ptr<Tile> tile) override;
+    void TileMoved(Tile *tile, int oldX, int oldY) override;
+    void CityCleared() override;
+    void CityLoaded() override;
+};
+
+#endif //CITY_CITYLIB_SERVICECOVERAGE_H
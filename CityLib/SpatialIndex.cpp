@@ -0,0 +1,460 @@
+/**
+ * @file SpatialIndex.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+
+#include <algorithm>
+#include <queue>
+
+#include "SpatialIndex.h"
+#include "City.h"
+#include "Tile.h"
+
+/// Maximum number of entries in a leaf before it is split
+const int LeafCapacity = 16;
+
+/// Nodes this size or smaller are never split
+const int MinimumNodeSize = 32;
+
+/// Size of the root node when the first tile is added
+const int InitialRootSize = 1024;
+
+/// Largest size the root node can grow to
+const int MaximumRootSize = 1 << 30;
+
+/**
+ * Constructor
+ * @param city The city we index
+ */
+SpatialIndex::SpatialIndex(City *city) : mCity(city)
+{
+}
+
+/**
+ * Determine which child of a node contains a point
+ * @param x X location
+ * @param y Y location
+ * @return Index into mChildren
+ */
+int SpatialIndex::Node::ChildIndex(int x, int y) const
+{
+    int half = mSize / 2;
+    return (x - mX >= half ? 1 : 0) + (y - mY >= half ? 2 : 0);
+}
+
+/**
+ * Add a tile to the index at a location
+ * @param tile Tile to add
+ * @param x X location of the tile center
+ * @param y Y location of the tile center
+ */
+void SpatialIndex::Insert(Tile *tile, int x, int y)
+{
+    if (mRoot == nullptr)
+    {
+        // Align the first root to its own size
+        mRoot = std::make_unique<Node>();
+        mRoot->mSize = InitialRootSize;
+        mRoot->mX = (x >= 0 ? x : x - InitialRootSize + 1) / InitialRootSize * InitialRootSize;
+        mRoot->mY = (y >= 0 ? y : y - InitialRootSize + 1) / InitialRootSize * InitialRootSize;
+    }
+
+    Grow(x, y);
+    Insert(mRoot.get(), Entry{tile, x, y});
+
+    mMaxSpriteHeight = std::max(mMaxSpriteHeight, tile->GetBounds().GetHeight());
+}
+
+/**
+ * Add an entry to a subtree that contains it
+ * @param node Root of the subtree
+ * @param entry Entry to add
+ */
+void SpatialIndex::Insert(Node *node, const Entry &entry)
+{
+    while (!node->IsLeaf())
+    {
+        node->mCount++;
+        node = node->mChildren[node->ChildIndex(entry.mX, entry.mY)].get();
+    }
+
+    node->mCount++;
+    node->mEntries.push_back(entry);
+    if (node->mCount > LeafCapacity && node->mSize > MinimumNodeSize)
+    {
+        Split(node);
+    }
+}
+
+/**
+ * Grow the tree until the root contains a point. Each
+ * step doubles the root, with the old root as one quadrant.
+ * @param x X location
+ * @param y Y location
+ */
+void SpatialIndex::Grow(int x, int y)
+{
+    while (!mRoot->Contains(x, y) && mRoot->mSize < MaximumRootSize)
+    {
+        auto root = std::make_unique<Node>();
+        root->mSize = mRoot->mSize * 2;
+        root->mX = x < mRoot->mX ? mRoot->mX - mRoot->mSize : mRoot->mX;
+        root->mY = y < mRoot->mY ? mRoot->mY - mRoot->mSize : mRoot->mY;
+        root->mCount = mRoot->mCount;
+
+        int half = mRoot->mSize;
+        for (int i = 0; i < 4; i++)
+        {
+            auto child = std::make_unique<Node>();
+            child->mSize = half;
+            child->mX = root->mX + (i % 2) * half;
+            child->mY = root->mY + (i / 2) * half;
+            root->mChildren[i] = std::move(child);
+        }
+
+        root->mChildren[root->ChildIndex(mRoot->mX, mRoot->mY)] = std::move(mRoot);
+        mRoot = std::move(root);
+    }
+}
+
+/**
+ * Split a leaf into four children
+ * @param node Leaf to split
+ */
+void SpatialIndex::Split(Node *node)
+{
+    int half = node->mSize / 2;
+    for (int i = 0; i < 4; i++)
+    {
+        auto child = std::make_unique<Node>();
+        child->mSize = half;
+        child->mX = node->mX + (i % 2) * half;
+        child->mY = node->mY + (i / 2) * half;
+        node->mChildren[i] = std::move(child);
+    }
+
+    for (auto &entry : node->mEntries)
+    {
+        Insert(node->mChildren[node->ChildIndex(entry.mX, entry.mY)].get(), entry);
+    }
+
+    node->mEntries.clear();
+    node->mEntries.shrink_to_fit();
+}
+
+/**
+ * Turn a node whose subtree has few entries back into a leaf
+ * @param node Node to collapse
+ */
+void SpatialIndex::Collapse(Node *node)
+{
+    std::vector<Entry> entries;
+    Gather(node, entries);
+    for (auto &child : node->mChildren)
+    {
+        child.reset();
+    }
+
+    node->mEntries = std::move(entries);
+}
+
+/**
+ * Collect all of the entries in a subtree
+ * @param node Root of the subtree
+ * @param entries Vector to add the entries to
+ */
+void SpatialIndex::Gather(Node *node, std::vector<Entry> &entries)
+{
+    if (node->IsLeaf())
+    {
+        entries.insert(entries.end(), node->mEntries.begin(), node->mEntries.end());
+        return;
+    }
+
+    for (auto &child : node->mChildren)
+    {
+        Gather(child.get(), entries);
+    }
+}
+
+/**
+ * Remove a tile from a subtree
+ * @param node Root of the subtree
+ * @param tile Tile to remove
+ * @param x X location the tile was indexed at
+ * @param y Y location the tile was indexed at
+ * @return true if the tile was found and removed
+ */
+bool SpatialIndex::Remove(Node *node, Tile *tile, int x, int y)
+{
+    if (!node->Contains(x, y))
+    {
+        return false;
+    }
+
+    if (node->IsLeaf())
+    {
+        auto &entries = node->mEntries;
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            if (entries[i].mTile == tile)
+            {
+                entries[i] = entries.back();
+                entries.pop_back();
+                node->mCount--;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    if (!Remove(node->mChildren[node->ChildIndex(x, y)].get(), tile, x, y))
+    {
+        return false;
+    }
+
+    if (--node->mCount <= LeafCapacity / 2)
+    {
+        Collapse(node);
+    }
+
+    return true;
+}
+
+/**
+ * Index every tile in the city from scratch
+ */
+void SpatialIndex::Rebuild()
+{
+    CityCleared();
+    for (auto tile : *mCity)
+    {
+        Insert(tile.get(), tile->GetX(), tile->GetY());
+    }
+}
+
+/**
+ * Find the tiles with centers inside a rectangle
+ * @param left Left side of the rectangle
+ * @param top Top of the rectangle
+ * @param right Right side of the rectangle, inclusive
+ * @param bottom Bottom of the rectangle, inclusive
+ * @param result Vector the tiles found are added to
+ */
+void SpatialIndex::QueryRect(int left, int top, int right, int bottom, std::vector<Tile *> &result) const
+{
+    if (mRoot != nullptr)
+    {
+        QueryRect(mRoot.get(), left, top, right, bottom, result);
+    }
+}
+
+/**
+ * Find the tiles in a subtree with centers inside a rectangle
+ * @param node Root of the subtree
+ * @param left Left side of the rectangle
+ * @param top Top of the rectangle
+ * @param right Right side of the rectangle, inclusive
+ * @param bottom Bottom of the rectangle, inclusive
+ * @param result Vector the tiles found are added to
+ */
+void SpatialIndex::QueryRect(const Node *node, int left, int top, int right, int bottom,
+                             std::vector<Tile *> &result) const
+{
+    if (node->mCount == 0 || right < node->mX || bottom < node->mY ||
+        left - node->mX >= node->mSize || top - node->mY >= node->mSize)
+    {
+        return;
+    }
+
+    if (node->IsLeaf())
+    {
+        for (auto &entry : node->mEntries)
+        {
+            if (entry.mX >= left && entry.mX <= right && entry.mY >= top && entry.mY <= bottom)
+            {
+                result.push_back(entry.mTile);
+            }
+        }
+
+        return;
+    }
+
+    for (auto &child : node->mChildren)
+    {
+        QueryRect(child.get(), left, top, right, bottom, result);
+    }
+}
+
+/**
+ * Find the tiles with centers within a distance of a point
+ * @param x X location of the point
+ * @param y Y location of the point
+ * @param radius Distance in pixels, inclusive
+ * @param result Vector the tiles found are added to
+ */
+void SpatialIndex::QueryRadius(int x, int y, int radius, std::vector<Tile *> &result) const
+{
+    size_t first = result.size();
+    QueryRect(x - radius, y - radius, x + radius, y + radius, result);
+
+    long long radius2 = (long long)radius * radius;
+    auto outside = [x, y, radius2](Tile *tile) {
+        long long dx = tile->GetX() - x;
+        long long dy = tile->GetY() - y;
+        return dx * dx + dy * dy > radius2;
+    };
+
+    result.erase(std::remove_if(result.begin() + first, result.end(), outside), result.end());
+}
+
+/**
+ * Find the k tiles with centers nearest a point,
+ * nearest first
+ * @param x X location of the point
+ * @param y Y location of the point
+ * @param k Number of tiles to find
+ * @param result Vector the tiles found are added to
+ */
+void SpatialIndex::QueryNearest(int x, int y, int k, std::vector<Tile *> &result) const
+{
+    if (mRoot == nullptr || k <= 0)
+    {
+        return;
+    }
+
+    // Best first search. Nodes are queued by the distance
+    // to the closest point of the node, entries by their
+    // exact distance, so entries come out in order.
+    struct Item
+    {
+        long long mDistance;
+        const Node *mNode;
+        Tile *mTile;
+
+        bool operator<(const Item &other) const { return mDistance > other.mDistance; }
+    };
+
+    auto nodeDistance = [x, y](const Node *node) {
+        long long dx = std::max(std::max(node->mX - x, x - (node->mX + node->mSize - 1)), 0);
+        long long dy = std::max(std::max(node->mY - y, y - (node->mY + node->mSize - 1)), 0);
+        return dx * dx + dy * dy;
+    };
+
+    std::priority_queue<Item> queue;
+    queue.push(Item{nodeDistance(mRoot.get()), mRoot.get(), nullptr});
+
+    int found = 0;
+    while (!queue.empty() && found < k)
+    {
+        auto item = queue.top();
+        queue.pop();
+
+        if (item.mTile != nullptr)
+        {
+            result.push_back(item.mTile);
+            found++;
+        }
+        else if (item.mNode->IsLeaf())
+        {
+            for (auto &entry : item.mNode->mEntries)
+            {
+                long long dx = entry.mX - x;
+                long long dy = entry.mY - y;
+                queue.push(Item{dx * dx + dy * dy, nullptr, entry.mTile});
+            }
+        }
+        else
+        {
+            for (auto &child : item.mNode->mChildren)
+            {
+                if (child->mCount > 0)
+                {
+                    queue.push(Item{nodeDistance(child.get()), child.get(), nullptr});
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Find the tiles whose drawn sprites overlap a rectangle.
+ *
+ * The search is on tile centers, widened by the largest
+ * sprite extents, and the candidates are then checked
+ * against their actual sprite bounds.
+ * @param left Left side of the rectangle
+ * @param top Top of the rectangle
+ * @param right Right side of the rectangle, inclusive
+ * @param bottom Bottom of the rectangle, inclusive
+ * @param result Vector the tiles found are added to
+ */
+void SpatialIndex::QuerySprites(int left, int top, int right, int bottom, std::vector<Tile *> &result) const
+{
+    size_t first = result.size();
+    QueryRect(left - Tile::OffsetLeft, top - Tile::OffsetDown,
+              right + Tile::OffsetLeft, bottom - Tile::OffsetDown + mMaxSpriteHeight, result);
+
+    auto outside = [left, top, right, bottom](Tile *tile) {
+        auto bounds = tile->GetBounds();
+        return bounds.GetLeft() > right || bounds.GetRight() < left ||
+               bounds.GetTop() > bottom || bounds.GetBottom() < top;
+    };
+
+    result.erase(std::remove_if(result.begin() + first, result.end(), outside), result.end());
+}
+
+/**
+ * A tile has been added to the city
+ * @param tile Tile that was added
+ */
+void SpatialIndex::TileAdded(std::shared_ptr<Tile> tile)
+{
+    Insert(tile.get(), tile->GetX(), tile->GetY());
+}
+
+/**
+ * A tile is being removed from the city
+ * @param tile Tile that is being removed
+ */
+void SpatialIndex::TileRemoved(std::shared_ptr<Tile> tile)
+{
+    if (mRoot != nullptr)
+    {
+        Remove(mRoot.get(), tile.get(), tile->GetX(), tile->GetY());
+    }
+}
+
+/**
+ * A tile has moved, so move its entry
+ * @param tile Tile that moved
+ * @param oldX Previous X location of the tile
+ * @param oldY Previous Y location of the tile
+ */
+void SpatialIndex::TileMoved(Tile *tile, int oldX, int oldY)
+{
+    if (mRoot != nullptr && Remove(mRoot.get(), tile, oldX, oldY))
+    {
+        Insert(tile, tile->GetX(), tile->GetY());
+    }
+}
+
+/**
+ * The city has been cleared
+ */
+void SpatialIndex::CityCleared()
+{
+    mRoot.reset();
+    mMaxSpriteHeight = 0;
+}
+
+/**
+ * The city has been loaded
+ */
+void SpatialIndex::CityLoaded()
+{
+    Rebuild();
+}
@@ -0,0 +1,121 @@
+/**
+ * @file SpatialIndex.h
+ * @author timan
+ *
+ * Quadtree index of the tile locations in the city
+ */
+
+#ifndef CITY_CITYLIB_SPATIALINDEX_H
+#define CITY_CITYLIB_SPATIALINDEX_H
+
+#include <memory>
+#include <vector>
+
+#include "CityObserver.h"
+
+class City;
+
+/**
+ * Quadtree index of the tile locations in the city.
+ *
+ * The index stores the center of every tile in the city and is
+ * updated as tiles are added, moved and removed. It answers
+ * rectangle, radius and nearest neighbor queries on tile centers,
+ * and rectangle queries on the sprite bounds drawn for each tile.
+ * The tree grows to cover whatever area the city uses.
+ */
+class SpatialIndex : public CityObserver
+{
+private:
+    /// A tile stored in the index
+    struct Entry
+    {
+        Tile *mTile;    ///< The tile
+        int mX;         ///< X location the tile was indexed at
+        int mY;         ///< Y location the tile was indexed at
+    };
+
+    /// A square node of the quadtree
+    struct Node
+    {
+        int mX = 0;         ///< Left side of the node
+        int mY = 0;         ///< Top of the node
+        int mSize = 0;      ///< Width and height of the node
+        int mCount = 0;     ///< Number of entries in this subtree
+
+        /// Entries, for leaf nodes only
+        std::vector<Entry> mEntries;
+
+        /// Children, in the order upper left, upper right,
+        /// lower left, lower right. Null for leaf nodes.
+        std::unique_ptr<Node> mChildren[4];
+
+        /**
+         * Is this a leaf node?
+         * @return true if the node has no children
+         */
+        bool IsLeaf() const { return mChildren[0] == nullptr; }
+
+        /**
+         * Does this node contain a point?
+         * @param x X location
+         * @param y Y location
+         * @return true if the point is inside the node
+         */
+        bool Contains(int x, int y) const
+        {
+            return x >= mX && y >= mY && x - mX < mSize && y - mY < mSize;
+        }
+
+        int ChildIndex(int x, int y) const;
+    };
+
+    void Insert(Tile *tile, int x, int y);
+    void Insert(Node *node, const Entry &entry);
+    bool Remove(Node *node, Tile *tile, int x, int y);
+    void Split(Node *node);
+    void Collapse(Node *node);
+    void Gather(Node *node, std::vector<Entry> &entries);
+    void Grow(int x, int y);
+    void Rebuild();
+
+    void QueryRect(const Node *node, int left, int top, int right, int bottom,
+                   std::vector<Tile *> &result) const;
+
+    /// The city we index
+    City *mCity;
+
+    /// The root of the quadtree
+    std::unique_ptr<Node> mRoot;
+
+    /// Tallest sprite of any indexed tile in pixels
+    int mMaxSpriteHeight = 0;
+
+public:
+    explicit SpatialIndex(City *city);
+
+    /// Copy constructor (disabled)
+    SpatialIndex(const SpatialIndex &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const SpatialIndex &) = delete;
+
+    /**
+     * Get the number of tiles in the index
+     * @return Number of tiles
+     */
+    int GetCount() const { return mRoot != nullptr ? mRoot->mCount : 0; }
+
+    void QueryRect(int left, int top, int right, int bottom, std::vector<Tile *> &result) const;
+    void QueryRadius(int x, int y, int radius, std::vector<Tile *> &result) const;
+    void QueryNearest(int x, int y, int k, std::vector<Tile *> &result) const;
+    void QuerySprites(int left, int top, int right, int bottom, std::vector<Tile *> &result) const;
+
+    void TileAdded(std::shared_ptr<Tile> tile) override;
+    void TileRemoved(std::shared_ptr<Tile> tile) override;
+    void TileMoved(Tile *tile, int oldX, int oldY) override;
+    void CityCleared() override;
+    void CityLoaded() override;
+};
+
+#endif //CITY_CITYLIB_SPATIALINDEX_H
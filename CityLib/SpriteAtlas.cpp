@@ -0,0 +1,326 @@
+/**
+ * @file SpriteAtlas.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "SpriteAtlas.h"
+#include "AssetPack.h"
+
+/// Empty pixels left around each sprite, so scaled
+/// drawing does not pick up its neighbors
+const int Padding = 1;
+
+/**
+ * Constructor
+ */
+SpriteAtlas::SpriteAtlas()
+{
+}
+
+/**
+ * Destructor
+ */
+SpriteAtlas::~SpriteAtlas()
+{
+}
+
+/**
+ * Set an asset pack to copy images from instead of decoding them
+ * @param assets The asset pack or nullptr for none
+ * @param directory Directory the images in the pack came from
+ */
+void SpriteAtlas::SetAssets(const AssetPack *assets, const std::wstring &directory)
+{
+    mAssets = assets;
+    mAssetsDirectory = directory;
+}
+
+/**
+ * Load a sprite from a file, if it is not already in the atlas
+ * @param directory Directory containing the image file
+ * @param file Name of the image file
+ * @return The sprite, which is not Ok if the file could not be loaded
+ */
+SpriteAtlas::Sprite SpriteAtlas::Load(const std::wstring &directory, const std::wstring &file)
+{
+    std::wstring filename = directory + L"/" + file;
+    auto found = mSprites.find(filename);
+    if (found != mSprites.end())
+    {
+        return found->second;
+    }
+
+    if (mAssets != nullptr && directory == mAssetsDirectory)
+    {
+        auto asset = mAssets->Find(file);
+        if (asset != nullptr)
+        {
+            return Add(filename, asset->mWidth, asset->mHeight, asset->mRGB, asset->mAlpha);
+        }
+    }
+
+    wxImage image(filename, wxBITMAP_TYPE_ANY);
+    if (!image.IsOk())
+    {
+        return Sprite();
+    }
+
+    return Add(filename, image);
+}
+
+/**
+ * Add an image made in memory to the atlas
+ * @param name Name to find the sprite by later
+ * @param image The image
+ * @return The sprite
+ */
+SpriteAtlas::Sprite SpriteAtlas::Add(const std::wstring &name, const wxImage &image)
+{
+    // Make a mask or no transparency into alpha
+    wxImage source = image;
+    if (!source.HasAlpha())
+    {
+        source = image.Copy();
+        source.InitAlpha();
+    }
+
+    return Add(name, source.GetWidth(), source.GetHeight(), source.GetData(), source.GetAlpha());
+}
+
+/**
+ * Add pixels to the atlas
+ * @param name Name to find the sprite by later
+ * @param wid Width in pixels
+ * @param hit Height in pixels
+ * @param rgb Rows of RGB
+ * @param alpha Rows of alpha
+ * @return The sprite
+ */
+SpriteAtlas::Sprite SpriteAtlas::Add(const std::wstring &name, int wid, int hit,
+                                     const unsigned char *rgb, const unsigned char *alpha)
+{
+    auto sprite = Pack(wid, hit, rgb, alpha);
+    mSprites[name] = sprite;
+    return sprite;
+}
+
+/**
+ * Load a set of sprites together, tallest first
+ * @param directory Directory containing the files
+ * @param files Names of the files in the directory
+ */
+void SpriteAtlas::Preload(const std::wstring &directory, const std::vector<std::wstring> &files)
+{
+    // Heights come from the asset pack if possible, so
+    // nothing there needs to be decoded to sort it
+    std::vector<std::pair<int, std::wstring>> sprites;
+    std::map<std::wstring, wxImage> images;
+    for (auto &file : files)
+    {
+        if (mSprites.find(directory + L"/" + file) != mSprites.end())
+        {
+            continue;
+        }
+
+        const AssetPack::Asset *asset = nullptr;
+        if (mAssets != nullptr && directory == mAssetsDirectory)
+        {
+            asset = mAssets->Find(file);
+        }
+
+        if (asset != nullptr)
+        {
+            sprites.emplace_back(asset->mHeight, file);
+        }
+        else
+        {
+            wxImage image(directory + L"/" + file, wxBITMAP_TYPE_ANY);
+            if (image.IsOk())
+            {
+                sprites.emplace_back(image.GetHeight(), file);
+                images[file] = image;
+            }
+        }
+    }
+
+    std::stable_sort(sprites.begin(), sprites.end(), [](const std::pair<int, std::wstring> &a,
+                                                        const std::pair<int, std::wstring> &b) {
+        return a.first > b.first;
+    });
+
+    for (auto &sprite : sprites)
+    {
+        auto image = images.find(sprite.second);
+        if (image != images.end())
+        {
+            Add(directory + L"/" + sprite.second, image->second);
+        }
+        else
+        {
+            Load(directory, sprite.second);
+        }
+    }
+}
+
+/**
+ * Find space for an image and copy it into the atlas
+ * @param wid Width in pixels
+ * @param hit Height in pixels
+ * @param rgb Rows of RGB
+ * @param alpha Rows of alpha
+ * @return Where the image was put
+ */
+SpriteAtlas::Sprite SpriteAtlas::Pack(int wid, int hit, const unsigned char *rgb, const unsigned char *alpha)
+{
+    const int needWid = wid + Padding * 2;
+    const int needHit = hit + Padding * 2;
+
+    Sprite sprite;
+    for (int p = 0; p < (int)mPages.size() && !sprite.IsOk(); p++)
+    {
+        auto &page = *mPages[p];
+        const int pageWid = page.mImage.GetWidth();
+        const int pageHit = page.mImage.GetHeight();
+
+        // The lowest shelf with room, wasting as little height as possible
+        Shelf *best = nullptr;
+        for (auto &shelf : page.mShelves)
+        {
+            if (shelf.mHeight >= needHit && shelf.mX + needWid <= pageWid &&
+                (best == nullptr || shelf.mHeight < best->mHeight))
+            {
+                best = &shelf;
+            }
+        }
+
+        if (best == nullptr && page.mBottom + needHit <= pageHit && needWid <= pageWid)
+        {
+            page.mShelves.push_back({page.mBottom, needHit, 0});
+            page.mBottom += needHit;
+            best = &page.mShelves.back();
+        }
+
+        if (best != nullptr)
+        {
+            sprite.mPage = p;
+            sprite.mRect = wxRect(best->mX + Padding, best->mY + Padding, wid, hit);
+            best->mX += needWid;
+        }
+    }
+
+    if (!sprite.IsOk())
+    {
+        // Start a new page, larger than usual if the image needs it
+        // A copy, as std::max takes references and PageSize has no definition
+        const int pageSize = PageSize;
+        auto page = std::make_unique<Page>();
+        page->mImage = wxImage(std::max(pageSize, needWid), std::max(pageSize, needHit), true);
+        page->mImage.InitAlpha();
+        memset(page->mImage.GetAlpha(), 0, page->mImage.GetWidth() * page->mImage.GetHeight());
+
+        page->mShelves.push_back({0, needHit, needWid});
+        page->mBottom = needHit;
+
+        sprite.mPage = (int)mPages.size();
+        sprite.mRect = wxRect(Padding, Padding, wid, hit);
+        mPages.push_back(std::move(page));
+    }
+
+    // Copy the pixels
+    auto &page = *mPages[sprite.mPage];
+    const int pageWid = page.mImage.GetWidth();
+    unsigned char *pageData = page.mImage.GetData();
+    unsigned char *pageAlpha = page.mImage.GetAlpha();
+    for (int y = 0; y < hit; y++)
+    {
+        int at = (sprite.mRect.y + y) * pageWid + sprite.mRect.x;
+        memcpy(pageData + at * 3, rgb + y * wid * 3, wid * 3);
+        memcpy(pageAlpha + at, alpha + y * wid, wid);
+    }
+
+    // What the sprite covers
+    Mask opaque;
+    Mask visible;
+    opaque.mWords = visible.mWords = (wid + 63) / 64;
+    opaque.mBits.assign((size_t)opaque.mWords * hit, 0);
+    visible.mBits.assign((size_t)visible.mWords * hit, 0);
+    for (int y = 0; y < hit; y++)
+    {
+        for (int x = 0; x < wid; x++)
+        {
+            unsigned char a = alpha[y * wid + x];
+            uint64_t bit = (uint64_t)1 << (x & 63);
+            size_t word = (size_t)y * opaque.mWords + (x >> 6);
+            if (a == 255)
+            {
+                opaque.mBits[word] |= bit;
+            }
+
+            if (a != 0)
+            {
+                visible.mBits[word] |= bit;
+            }
+        }
+    }
+
+    sprite.mIndex = (int)mOpaqueMasks.size();
+    mOpaqueMasks.push_back(std::move(opaque));
+    mVisibleMasks.push_back(std::move(visible));
+
+    // The bitmap no longer matches the page
+    page.mRevision++;
+    page.mSource.reset();
+    page.mBitmap.reset();
+
+    return sprite;
+}
+
+/**
+ * Get a device context to draw from a page, making
+ * the bitmap of the page if it is out of date
+ * @param page Page index
+ * @return Device context with the page bitmap selected
+ */
+wxMemoryDC *SpriteAtlas::GetSource(int page)
+{
+    auto &atlasPage = *mPages[page];
+    if (atlasPage.mSource == nullptr)
+    {
+        atlasPage.mBitmap = std::make_unique<wxBitmap>(atlasPage.mImage);
+        atlasPage.mSource = std::make_unique<wxMemoryDC>();
+        atlasPage.mSource->SelectObjectAsSource(*atlasPage.mBitmap);
+    }
+
+    return atlasPage.mSource.get();
+}
+
+/**
+ * Get a copy of the pixels of a sprite
+ * @param sprite Sprite
+ * @return Image of the sprite
+ */
+wxImage SpriteAtlas::GetImage(const Sprite &sprite) const
+{
+    return mPages[sprite.mPage]->mImage.GetSubImage(sprite.mRect);
+}
+
+/**
+ * Draw a sprite
+ * @param dc Device context to draw on
+ * @param sprite Sprite to draw
+ * @param x Left of where to draw the sprite
+ * @param y Top of where to draw the sprite
+ */
+void SpriteAtlas::Draw(wxDC *dc, const Sprite &sprite, int x, int y)
+{
+    if (sprite.IsOk())
+    {
+        auto &rect = sprite.mRect;
+        dc->Blit(x, y, rect.width, rect.height, GetSource(sprite.mPage), rect.x, rect.y, wxCOPY, true);
+    }
+}
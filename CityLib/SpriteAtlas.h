@@ -0,0 +1,197 @@
+/**
+ * @file SpriteAtlas.h
+ * @author timan
+ *
+ * Sprites packed into a few large images
+ */
+
+#ifndef CITY_CITYLIB_SPRITEATLAS_H
+#define CITY_CITYLIB_SPRITEATLAS_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class AssetPack;
+
+/**
+ * Sprites packed into a few large images.
+ *
+ * Every sprite is copied into a page of the atlas the first time
+ * it is loaded, and anything that draws it refers to a rectangle
+ * of that page. Drawing many tiles then copies from a handful of
+ * source bitmaps rather than one bitmap per tile, and a sprite
+ * used by many tiles is only decoded once.
+ *
+ * Pages are packed in shelves: rows as tall as the first sprite
+ * put in them, filled left to right. A sprite goes on the lowest
+ * shelf it fits on, or starts a new shelf, or a new page. Loading
+ * a set of sprites together packs them tallest first, which wastes
+ * less space. The bitmap for a page is made when it is first drawn
+ * from, and made again if sprites have been added since.
+ *
+ * Images found in an asset pack are copied from it rather than
+ * decoded from their files.
+ *
+ * Each sprite also gets two masks when it is added: the pixels
+ * that are fully opaque and the pixels that are not fully
+ * transparent, so what a sprite covers can be tested without
+ * reading its pixels.
+ */
+class SpriteAtlas
+{
+public:
+    /// Width and height of a page in pixels
+    static const int PageSize = 1024;
+
+    /// Where a sprite is in the atlas
+    struct Sprite
+    {
+        int mPage = -1;     ///< Page the sprite is on or -1 for none
+        int mIndex = -1;    ///< Index of the sprite in the atlas, for its masks
+        wxRect mRect;       ///< Location of the sprite on the page
+
+        /**
+         * Is this a sprite in the atlas?
+         * @return true if the sprite can be drawn
+         */
+        bool IsOk() const { return mPage >= 0; }
+    };
+
+    /// One bit for each pixel of a sprite, row by row, 64 pixels to a word
+    struct Mask
+    {
+        int mWords = 0;                 ///< Words in each row
+        std::vector<uint64_t> mBits;    ///< The rows of bits, low bit leftmost
+
+        /**
+         * Get a row of the mask
+         * @param y Row, from 0 at the top of the sprite
+         * @return The words of the row
+         */
+        const uint64_t *GetRow(int y) const { return mBits.data() + (size_t)y * mWords; }
+
+        /**
+         * Test the bit for a pixel
+         * @param x Column, from 0 at the left of the sprite
+         * @param y Row, from 0 at the top of the sprite
+         * @return true if the bit is set
+         */
+        bool Test(int x, int y) const { return (GetRow(y)[x >> 6] >> (x & 63)) & 1; }
+    };
+
+private:
+    /// A row of sprites on a page
+    struct Shelf
+    {
+        int mY;         ///< Top of the shelf
+        int mHeight;    ///< Height of the shelf
+        int mX;         ///< Left of the space still free
+    };
+
+    /// One large image sprites are packed into
+    struct Page
+    {
+        /// Pixels of all of the sprites on the page
+        wxImage mImage;
+
+        /// Shelves on the page, top to bottom
+        std::vector<Shelf> mShelves;
+
+        /// Top of the space below the last shelf
+        int mBottom = 0;
+
+        /// Number of times sprites have been added to the page
+        int mRevision = 0;
+
+        /// Bitmap of the page, or nullptr if not made since the page changed
+        std::unique_ptr<wxBitmap> mBitmap;
+
+        /// Device context the bitmap is selected into for drawing from
+        std::unique_ptr<wxMemoryDC> mSource;
+    };
+
+    Sprite Pack(int wid, int hit, const unsigned char *rgb, const unsigned char *alpha);
+    Sprite Add(const std::wstring &name, int wid, int hit, const unsigned char *rgb, const unsigned char *alpha);
+    wxMemoryDC *GetSource(int page);
+
+    /// The pages of the atlas
+    std::vector<std::unique_ptr<Page>> mPages;
+
+    /// Masks of the fully opaque pixels of each sprite, by sprite index
+    std::vector<Mask> mOpaqueMasks;
+
+    /// Masks of the pixels of each sprite that are not fully transparent
+    std::vector<Mask> mVisibleMasks;
+
+    /// Sprites loaded, by file name or the name they were added with
+    std::map<std::wstring, Sprite> mSprites;
+
+    /// Images decoded ahead of time, or nullptr if none
+    const AssetPack *mAssets = nullptr;
+
+    /// Directory the images in the asset pack came from
+    std::wstring mAssetsDirectory;
+
+public:
+    SpriteAtlas();
+    virtual ~SpriteAtlas();
+
+    /// Copy constructor (disabled)
+    SpriteAtlas(const SpriteAtlas &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const SpriteAtlas &) = delete;
+
+    void SetAssets(const AssetPack *assets, const std::wstring &directory);
+    Sprite Load(const std::wstring &directory, const std::wstring &file);
+    Sprite Add(const std::wstring &name, const wxImage &image);
+    void Preload(const std::wstring &directory, const std::vector<std::wstring> &files);
+    void Draw(wxDC *dc, const Sprite &sprite, int x, int y);
+    wxImage GetImage(const Sprite &sprite) const;
+
+    /**
+     * Get the number of pages in the atlas
+     * @return Number of pages
+     */
+    int GetNumPages() const { return (int)mPages.size(); }
+
+    /**
+     * Get the number of sprites in the atlas
+     * @return Number of sprites
+     */
+    int GetNumSprites() const { return (int)mSprites.size(); }
+
+    /**
+     * Get the mask of the pixels of a sprite that are fully opaque
+     * @param sprite Sprite in the atlas
+     * @return Mask of the sprite
+     */
+    const Mask &GetOpaqueMask(const Sprite &sprite) const { return mOpaqueMasks[sprite.mIndex]; }
+
+    /**
+     * Get the mask of the pixels of a sprite that are not fully transparent
+     * @param sprite Sprite in the atlas
+     * @return Mask of the sprite
+     */
+    const Mask &GetVisibleMask(const Sprite &sprite) const { return mVisibleMasks[sprite.mIndex]; }
+
+    /**
+     * Get the pixels of a page
+     * @param page Page index
+     * @return Image of the whole page
+     */
+    const wxImage &GetPageImage(int page) const { return mPages[page]->mImage; }
+
+    /**
+     * Get how many times sprites have been added to a page,
+     * so copies of the page can tell when they are out of date
+     * @param page Page index
+     * @return Revision of the page
+     */
+    int GetPageRevision(int page) const { return mPages[page]->mRevision; }
+};
+
+#endif //CITY_CITYLIB_SPRITEATLAS_H
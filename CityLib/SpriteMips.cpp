@@ -0,0 +1,110 @@
+/**
+ * @file SpriteMips.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+
+#include <algorithm>
+
+#include "SpriteMips.h"
+
+/**
+ * Constructor
+ * @param atlas Atlas the sprites are in
+ * @param budget Most bytes the copies may use
+ */
+SpriteMips::SpriteMips(SpriteAtlas *atlas, size_t budget) : mAtlas(atlas), mBudget(budget)
+{
+}
+
+/**
+ * Draw a sprite at a zoom level
+ * @param dc Device context to draw on
+ * @param sprite Sprite to draw
+ * @param level Zoom level, where 0 is full size
+ * @param x Left of where to draw the sprite, already zoomed
+ * @param y Top of where to draw the sprite, already zoomed
+ */
+void SpriteMips::Draw(wxDC *dc, const SpriteAtlas::Sprite &sprite, int level, int x, int y)
+{
+    if (!sprite.IsOk())
+    {
+        return;
+    }
+
+    if (level <= 0)
+    {
+        mAtlas->Draw(dc, sprite, x, y);
+        return;
+    }
+
+    dc->DrawBitmap(*GetMip(sprite, level).mBitmap, x, y);
+}
+
+/**
+ * Get the copy of a sprite for a level, making it if needed
+ * @param sprite Sprite
+ * @param level Zoom level, greater than 0
+ * @return The copy
+ */
+const SpriteMips::Mip &SpriteMips::GetMip(const SpriteAtlas::Sprite &sprite, int level)
+{
+    Key key = {sprite.mPage, sprite.mRect.x, sprite.mRect.y, level};
+    auto found = mMips.find(key);
+    if (found != mMips.end())
+    {
+        // Now the most recently used
+        mUse.splice(mUse.begin(), mUse, found->second.mUse);
+        return found->second;
+    }
+
+    int wid = std::max(sprite.mRect.width >> level, 1);
+    int hit = std::max(sprite.mRect.height >> level, 1);
+    auto image = mAtlas->GetImage(sprite).Scale(wid, hit, wxIMAGE_QUALITY_BOX_AVERAGE);
+
+    mUse.push_front(key);
+    auto &mip = mMips[key];
+    mip.mBitmap = std::make_unique<wxBitmap>(image);
+    mip.mBytes = (size_t)wid * hit * 4;
+    mip.mUse = mUse.begin();
+    mBytes += mip.mBytes;
+
+    Trim();
+    return mip;
+}
+
+/**
+ * Drop the least recently used copies until they are within the
+ * budget. The most recently used copy is always kept.
+ */
+void SpriteMips::Trim()
+{
+    while (mBytes > mBudget && mUse.size() > 1)
+    {
+        auto found = mMips.find(mUse.back());
+        mBytes -= found->second.mBytes;
+        mMips.erase(found);
+        mUse.pop_back();
+    }
+}
+
+/**
+ * Set the most memory the copies may use
+ * @param budget Budget in bytes
+ */
+void SpriteMips::SetBudget(size_t budget)
+{
+    mBudget = budget;
+    Trim();
+}
+
+/**
+ * Drop all of the copies
+ */
+void SpriteMips::Clear()
+{
+    mMips.clear();
+    mUse.clear();
+    mBytes = 0;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file SpriteMips.h
+ * @author timan
+ *
+ * Reduced size copies of atlas sprites for zoomed out drawing
+ */
+
+#ifndef CITY_CITYLIB_SPRITEMIPS_H
+#define CITY_CITYLIB_SPRITEMIPS_H
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+#include "SpriteAtlas.h"
+
+/**
+ * Reduced size copies of atlas sprites for zoomed out drawing.
+ *
+ * Zoom level n draws everything at 1/2^n of its size. The copy of
+ * a sprite for a level is made by averaging boxes of its pixels
+ * the first time it is drawn at that level, so drawing never scales
+ * bitmaps. Copies are kept in least recently used order, and the
+ * oldest are dropped whenever their total size is over a budget.
+ */
+class SpriteMips
+{
+public:
+    /// Default memory budget in bytes
+    static const size_t DefaultBudget = 16 * 1024 * 1024;
+
+private:
+    /// Identifies a copy: a sprite and a level
+    struct Key
+    {
+        int mPage;      ///< Atlas page of the sprite
+        int mX;         ///< Left of the sprite on the page
+        int mY;         ///< Top of the sprite on the page
+        int mLevel;     ///< Zoom level
+
+        /**
+         * Compare keys
+         * @param other Key to compare to
+         * @return true if equal
+         */
+        bool operator==(const Key &other) const
+        {
+            return mPage == other.mPage && mX == other.mX && mY == other.mY && mLevel == other.mLevel;
+        }
+    };
+
+    /// Hash function for keys
+    struct KeyHash
+    {
+        /**
+         * Hash a key
+         * @param key Key to hash
+         * @return Hash value
+         */
+        size_t operator()(const Key &key) const
+        {
+            return std::hash<long long>()(((long long)key.mPage << 40) ^ ((long long)key.mX << 24) ^
+                                          ((long long)key.mY << 4) ^ key.mLevel);
+        }
+    };
+
+    /// A reduced copy of a sprite
+    struct Mip
+    {
+        std::unique_ptr<wxBitmap> mBitmap;      ///< The copy
+        size_t mBytes;                          ///< Memory it uses
+        std::list<Key>::iterator mUse;          ///< Place in the use order
+    };
+
+    const Mip &GetMip(const SpriteAtlas::Sprite &sprite, int level);
+    void Trim();
+
+    /// Atlas the sprites are in
+    SpriteAtlas *mAtlas;
+
+    /// The copies that have been made
+    std::unordered_map<Key, Mip, KeyHash> mMips;
+
+    /// Keys of the copies, most recently used first
+    std::list<Key> mUse;
+
+    /// Most bytes the copies may use
+    size_t mBudget;
+
+    /// Bytes the copies use
+    size_t mBytes = 0;
+
+public:
+    explicit SpriteMips(SpriteAtlas *atlas, size_t budget = DefaultBudget);
+
+    /// Copy constructor (disabled)
+    SpriteMips(const SpriteMips &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const SpriteMips &) = delete;
+
+    void Draw(wxDC *dc, const SpriteAtlas::Sprite &sprite, int level, int x, int y);
+    void SetBudget(size_t budget);
+    void Clear();
+
+    /**
+     * Get the memory the copies use
+     * @return Size in bytes
+     */
+    size_t GetBytes() const { return mBytes; }
+
+    /**
+     * Get the number of copies kept
+     * @return Number of copies
+     */
+    int GetNumMips() const { return (int)mMips.size(); }
+};
+
+#endif //CITY_CITYLIB_SPRITEMIPS_H
@@ -6,9 +6,11 @@
 #include <string>
 #include "Starship.h"
 #include "TileStarshipPad.h"
+#include "City.h"
+#include "DrawList.h"
 
 /// The Sparty Starship image
-const std::wstring StarshipImage = L"images/sparty-starship.png";
+const std::wstring StarshipImage = L"sparty-starship.png";
 
 /// Starship offset to draw in the x dimension in pixels
 const float StarshipOffsetX = -64;
@@ -26,9 +28,12 @@ const double StarshipSpeed = 0.5;
  * Constructor
  * @param city City this Starship is associated with.
 */
-Starship::Starship(City* city)
+Starship::Starship(City* city) : mCity(city)
 {
-    mImage = std::make_unique<wxBitmap>(StarshipImage, wxBITMAP_TYPE_ANY);
+    if (city->AreImagesEnabled())
+    {
+        mSprite = city->GetAtlas().Load(city->GetImagesDirectory(), StarshipImage);
+    }
 }
 
 /**
@@ -115,18 +120,34 @@ void Starship::Draw(TileStarshipPad *pad, wxDC* dc)
         return;
     }
 
-    if (mImage != nullptr)
+    if (mSprite.IsOk())
     {
         auto position = ComputePosition();
 
-        int wid = mImage->GetWidth();
-        int hit = mImage->GetHeight();
-
-        dc->DrawBitmap(*mImage,
+        mCity->GetAtlas().Draw(dc, mSprite,
                        position.x + StarshipOffsetX, position.y + StarshipOffsetY);
     }
 }
 
+/**
+ * Add the Starship to a draw list
+ *
+ * Adds it only when Draw would draw it for this pad.
+ *
+ * @param pad The pad object adding to the list.
+ * @param list Draw list to add the Starship to.
+*/
+void Starship::AddToDrawList(TileStarshipPad *pad, DrawList* list)
+{
+    if (!IsLowerOwner(pad))
+    {
+        return;
+    }
+
+    auto position = ComputePosition();
+    list->Add(mSprite, (int)(position.x + StarshipOffsetX), (int)(position.y + StarshipOffsetY));
+}
+
 /**
  * Determine if this pad is the lower (int Y) of two pads owning
  * the Starship. If only owned by one, return true.
@@ -10,8 +10,11 @@
 
 #include <memory>
 
+#include "SpriteAtlas.h"
+
 class City;
 class TileStarshipPad;
+class DrawList;
 
 /**
  * Class the implements Sparty Starship, a simple rocket
@@ -22,8 +25,11 @@ private:
     wxRealPoint ComputePosition();
     bool IsLowerOwner(TileStarshipPad* pad);
 
-    /// The image of the starship
-    std::unique_ptr<wxBitmap> mImage;
+    /// The city the starship flies over
+    City *mCity;
+
+    /// Where the image of the starship is in the city sprite atlas
+    SpriteAtlas::Sprite mSprite;
 
     /// The launching pad for the starship
     TileStarshipPad* mLaunchingPad = nullptr;
@@ -48,6 +54,8 @@ public:
 
     void Draw(TileStarshipPad* pad, wxDC* dc);
 
+    void AddToDrawList(TileStarshipPad* pad, DrawList* list);
+
  
     bool InFlight();
 };
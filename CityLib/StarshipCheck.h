@@ -32,6 +32,14 @@ public:
 	 */
 	TileStarshipPad* GetStarshipPad() {return mStarshipPad;}
 
+	/**
+	 * This visitor keeps the last matching pad it sees, so
+	 * the result depends on visit order. It opts out of
+	 * parallel traversal.
+	 * @return nullptr
+	 */
+	std::unique_ptr<TileVisitor> Clone() const override { return nullptr; }
+
 
 private:
 	/// a boolean determining if the Tile is a StarshipTile
@@ -0,0 +1,386 @@
+/**
+ * @file SummedAreaTable.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "SummedAreaTable.h"
+#include "City.h"
+#include "WorkerPool.h"
+
+/// Fewest extra grid locations added around the city
+/// when the tables are rebuilt to cover it
+const int TableMargin = 16;
+
+/// Fewest changes held before they are folded into the tables
+/// without waiting for a flush
+const int MinPending = 64;
+
+/**
+ * Constructor
+ * @param city The city we are counting
+ */
+SummedAreaTable::SummedAreaTable(City *city) : mCity(city)
+{
+}
+
+/**
+ * Convert a pixel location to a grid location,
+ * rounding toward negative infinity
+ * @param pixels Location in pixels
+ * @return Grid location
+ */
+int SummedAreaTable::GridLocation(int pixels)
+{
+    const int spacing = City::GridSpacing;
+    return pixels >= 0 ? pixels / spacing : (pixels - spacing + 1) / spacing;
+}
+
+/**
+ * Is a grid location covered by the tables?
+ * @param col Grid column
+ * @param row Grid row
+ * @return true if covered
+ */
+bool SummedAreaTable::Contains(int col, int row) const
+{
+    return col >= mLeft && row >= mTop && col < mLeft + mColumns && row < mTop + mRows;
+}
+
+/**
+ * Get a table entry: the number of tiles of a type in
+ * the columns before col and the rows before row.
+ * @param type Tile type index
+ * @param col Column in the table, from 0 to mColumns
+ * @param row Row in the table, from 0 to mRows
+ * @return Count
+ */
+int SummedAreaTable::Sum(int type, int col, int row) const
+{
+    return mTables[type][(size_t)row * (mColumns + 1) + col];
+}
+
+/**
+ * Count the tiles of a type in a rectangle of grid locations,
+ * as of the last flush
+ * @param type Tile type to count
+ * @param left Leftmost grid column
+ * @param top Top grid row
+ * @param right Rightmost grid column, inclusive
+ * @param bottom Bottom grid row, inclusive
+ * @return Number of tiles
+ */
+int SummedAreaTable::Count(TileType type, int left, int top, int right, int bottom) const
+{
+    // Clip to the area covered, in table coordinates
+    int c1 = std::max(left - mLeft, 0);
+    int r1 = std::max(top - mTop, 0);
+    int c2 = std::min(right - mLeft + 1, mColumns);
+    int r2 = std::min(bottom - mTop + 1, mRows);
+    if (c1 >= c2 || r1 >= r2)
+    {
+        return 0;
+    }
+
+    int t = (int)type;
+    return Sum(t, c2, r2) - Sum(t, c1, r2) - Sum(t, c2, r1) + Sum(t, c1, r1);
+}
+
+/**
+ * Count the tiles of a type with centers in a rectangle of pixels,
+ * as of the last flush
+ * @param type Tile type to count
+ * @param left Left side of the rectangle
+ * @param top Top of the rectangle
+ * @param right Right side of the rectangle, inclusive
+ * @param bottom Bottom of the rectangle, inclusive
+ * @return Number of tiles
+ */
+int SummedAreaTable::CountPixels(TileType type, int left, int top, int right, int bottom) const
+{
+    // Grid locations whose centers fall inside the rectangle
+    return Count(type, GridLocation(left + City::GridSpacing - 1), GridLocation(top + City::GridSpacing - 1),
+                 GridLocation(right), GridLocation(bottom));
+}
+
+/**
+ * Add to the count for one grid location
+ * @param x X location of the tile in pixels
+ * @param y Y location of the tile in pixels
+ * @param type Tile type
+ * @param delta Amount to add to the count
+ */
+void SummedAreaTable::Update(int x, int y, TileType type, int delta)
+{
+    int col = GridLocation(x);
+    int row = GridLocation(y);
+    if (!Contains(col, row))
+    {
+        // Only a tile outside the tables can get here, and the
+        // rebuild counts it as it is now, so we are done.
+        Rebuild(col, row);
+        return;
+    }
+
+    mPending.push_back({col, row, (int)type, delta});
+
+    // Changes are folded in on each update, but a long run
+    // of edits in between is folded in as it goes too
+    int limit = std::max(MinPending, 16 * (int)std::sqrt((double)mColumns * mRows));
+    if ((int)mPending.size() > limit)
+    {
+        Flush();
+    }
+}
+
+/**
+ * Fold the pending changes into the tables.
+ *
+ * The changes are summed into tables of their own,
+ * which are then added to the tables in place.
+ */
+void SummedAreaTable::Flush()
+{
+    if (mPending.empty())
+    {
+        return;
+    }
+
+    int stride = mColumns + 1;
+    size_t size = (size_t)stride * (mRows + 1);
+
+    bool changed[NumTileTypes] = {};
+    std::vector<int> deltas[NumTileTypes];
+    for (auto &pending : mPending)
+    {
+        auto &table = deltas[pending.mType];
+        if (!changed[pending.mType])
+        {
+            table.assign(size, 0);
+            changed[pending.mType] = true;
+        }
+
+        table[(size_t)(pending.mRow - mTop + 1) * stride + pending.mCol - mLeft + 1] += pending.mDelta;
+    }
+
+    mPending.clear();
+    Accumulate(deltas, NumTileTypes);
+
+    WorkerPool::Get().ParallelFor(mRows + 1, [this, &deltas, &changed, stride](int begin, int end, int worker) {
+        for (int type = 0; type < NumTileTypes; type++)
+        {
+            if (!changed[type])
+            {
+                continue;
+            }
+
+            int *entry = &mTables[type][(size_t)begin * stride];
+            const int *delta = &deltas[type][(size_t)begin * stride];
+            for (size_t i = 0; i < (size_t)(end - begin) * stride; i++)
+            {
+                entry[i] += delta[i];
+            }
+        }
+    });
+}
+
+/**
+ * Turn tables of counts into summed-area tables, in place.
+ *
+ * The rows and then the columns are summed in parallel.
+ * Empty tables are skipped.
+ * @param tables Tables to sum
+ * @param numTables Number of tables
+ */
+void SummedAreaTable::Accumulate(std::vector<int> *tables, int numTables) const
+{
+    int stride = mColumns + 1;
+    auto &pool = WorkerPool::Get();
+
+    // Sum along each row. Rows are independent.
+    pool.ParallelFor(numTables * mRows, [this, tables, stride](int begin, int end, int worker) {
+        for (int i = begin; i < end; i++)
+        {
+            auto &table = tables[i / mRows];
+            if (table.empty())
+            {
+                continue;
+            }
+
+            int *entry = &table[(size_t)(i % mRows + 1) * stride];
+            for (int c = 1; c <= mColumns; c++)
+            {
+                entry[c] += entry[c - 1];
+            }
+        }
+    });
+
+    // Sum down the columns. Each worker takes a band of
+    // columns and walks down the rows, so memory is
+    // still read in order.
+    pool.ParallelFor(mColumns, [this, tables, numTables, stride](int begin, int end, int worker) {
+        for (int t = 0; t < numTables; t++)
+        {
+            auto &table = tables[t];
+            if (table.empty())
+            {
+                continue;
+            }
+
+            for (int r = 2; r <= mRows; r++)
+            {
+                int *entry = &table[(size_t)r * stride + 1];
+                const int *above = entry - stride;
+                for (int c = begin; c < end; c++)
+                {
+                    entry[c] += above[c];
+                }
+            }
+        }
+    });
+}
+
+/**
+ * Rebuild the tables to cover the whole city
+ */
+void SummedAreaTable::Rebuild()
+{
+    bool empty = true;
+    int minCol = 0, minRow = 0;
+    for (auto tile : *mCity)
+    {
+        int col = GridLocation(tile->GetX());
+        int row = GridLocation(tile->GetY());
+        if (empty)
+        {
+            minCol = col;
+            minRow = row;
+            empty = false;
+        }
+
+        minCol = std::min(minCol, col);
+        minRow = std::min(minRow, row);
+    }
+
+    Rebuild(minCol, minRow);
+}
+
+/**
+ * Rebuild the tables to cover the whole city and a grid location.
+ *
+ * The tile counts are scattered into the tables, which
+ * are then summed in parallel.
+ * @param includeCol Grid column the tables must cover
+ * @param includeRow Grid row the tables must cover
+ */
+void SummedAreaTable::Rebuild(int includeCol, int includeRow)
+{
+    int minCol = includeCol, maxCol = includeCol;
+    int minRow = includeRow, maxRow = includeRow;
+    for (auto tile : *mCity)
+    {
+        int col = GridLocation(tile->GetX());
+        int row = GridLocation(tile->GetY());
+        minCol = std::min(minCol, col);
+        maxCol = std::max(maxCol, col);
+        minRow = std::min(minRow, row);
+        maxRow = std::max(maxRow, row);
+    }
+
+    // The margins grow with the city, so a city that
+    // keeps growing is rebuilt fewer and fewer times
+    int columnMargin = std::max(TableMargin, (maxCol - minCol) / 4);
+    int rowMargin = std::max(TableMargin, (maxRow - minRow) / 4);
+
+    mPending.clear();
+    mLeft = minCol - columnMargin;
+    mTop = minRow - rowMargin;
+    mColumns = maxCol - minCol + 1 + columnMargin * 2;
+    mRows = maxRow - minRow + 1 + rowMargin * 2;
+
+    int stride = mColumns + 1;
+    for (auto &table : mTables)
+    {
+        table.assign((size_t)stride * (mRows + 1), 0);
+    }
+
+    // Each tile counts in the entry one right and one below
+    // its location. The sums below turn these into totals.
+    for (auto tile : *mCity)
+    {
+        int col = GridLocation(tile->GetX()) - mLeft + 1;
+        int row = GridLocation(tile->GetY()) - mTop + 1;
+        mTables[(int)tile->GetType()][(size_t)row * stride + col]++;
+    }
+
+    Accumulate(mTables, NumTileTypes);
+}
+
+/**
+ * A tile has been added to the city
+ * @param tile Tile that was added
+ */
+void SummedAreaTable::TileAdded(std::shared_ptr<Tile> tile)
+{
+    Update(tile->GetX(), tile->GetY(), tile->GetType(), 1);
+}
+
+/**
+ * A tile is being removed from the city
+ * @param tile Tile that is being removed
+ */
+void SummedAreaTable::TileRemoved(std::shared_ptr<Tile> tile)
+{
+    Update(tile->GetX(), tile->GetY(), tile->GetType(), -1);
+}
+
+/**
+ * A tile has moved, which may move it to another grid location
+ * @param tile Tile that moved
+ * @param oldX Previous X location of the tile
+ * @param oldY Previous Y location of the tile
+ */
+void SummedAreaTable::TileMoved(Tile *tile, int oldX, int oldY)
+{
+    int col = GridLocation(tile->GetX());
+    int row = GridLocation(tile->GetY());
+    if (col == GridLocation(oldX) && row == GridLocation(oldY))
+    {
+        return;
+    }
+
+    if (!Contains(col, row))
+    {
+        // The rebuild counts the tile at its new location
+        Rebuild(col, row);
+        return;
+    }
+
+    Update(oldX, oldY, tile->GetType(), -1);
+    Update(tile->GetX(), tile->GetY(), tile->GetType(), 1);
+}
+
+/**
+ * The city has been cleared
+ */
+void SummedAreaTable::CityCleared()
+{
+    mLeft = mTop = mColumns = mRows = 0;
+    mPending.clear();
+    for (auto &table : mTables)
+    {
+        table.clear();
+    }
+}
+
+/**
+ * The city has been loaded
+ */
+void SummedAreaTable::CityLoaded()
+{
+    Rebuild();
+}
@@ -0,0 +1,101 @@
+/**
+ * @file SummedAreaTable.h
+ * @author timan
+ *
+ * Summed-area tables of the tiles of each type on the city grid
+ */
+
+#ifndef CITY_CITYLIB_SUMMEDAREATABLE_H
+#define CITY_CITYLIB_SUMMEDAREATABLE_H
+
+#include <vector>
+
+#include "CityObserver.h"
+#include "TileType.h"
+
+class City;
+
+/**
+ * Summed-area tables of the tiles of each type on the city grid.
+ *
+ * For each tile type the table holds, for every grid location,
+ * the number of tiles of that type above and to the left of it.
+ * The number of tiles of a type in any rectangle of the grid is
+ * then four lookups.
+ *
+ * Changing one location changes every entry below and to the
+ * right of it, so changes are held in a list and folded into the
+ * tables together in one parallel pass by Flush, which City::Update
+ * calls, or when the list gets long. A run of edits then costs one
+ * pass. Counting only reads the tables, so it is always the four
+ * lookups and safe from several threads at once, and counts include
+ * the changes up to the last flush. The tables are rebuilt when a
+ * city is loaded or grows past the area they cover.
+ *
+ * Grid locations are tile locations divided by City::GridSpacing.
+ */
+class SummedAreaTable : public CityObserver
+{
+private:
+    /// A change not yet folded into the tables
+    struct Pending
+    {
+        int mCol;       ///< Grid column
+        int mRow;       ///< Grid row
+        int mType;      ///< Tile type index
+        int mDelta;     ///< Change to the count
+    };
+
+    void Update(int x, int y, TileType type, int delta);
+    bool Contains(int col, int row) const;
+    void Rebuild(int includeCol, int includeRow);
+    void Rebuild();
+    void Accumulate(std::vector<int> *tables, int numTables) const;
+    int Sum(int type, int col, int row) const;
+
+    static int GridLocation(int pixels);
+
+    /// The city we are counting
+    City *mCity;
+
+    /// Grid column of the first column in the tables
+    int mLeft = 0;
+
+    /// Grid row of the first row in the tables
+    int mTop = 0;
+
+    /// Number of grid columns covered
+    int mColumns = 0;
+
+    /// Number of grid rows covered
+    int mRows = 0;
+
+    /// The tables, one per tile type. Each has (mColumns + 1) by
+    /// (mRows + 1) entries, with a leading row and column of zeros.
+    std::vector<int> mTables[NumTileTypes];
+
+    /// Changes not yet folded into the tables
+    std::vector<Pending> mPending;
+
+public:
+    explicit SummedAreaTable(City *city);
+
+    /// Copy constructor (disabled)
+    SummedAreaTable(const SummedAreaTable &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const SummedAreaTable &) = delete;
+
+    void Flush();
+
+    int Count(TileType type, int left, int top, int right, int bottom) const;
+    int CountPixels(TileType type, int left, int top, int right, int bottom) const;
+
+    void TileAdded(std::shared_ptr<Tile> tile) override;
+    void TileRemoved(std::shared_ptr<Tile> tile) override;
+    void TileMoved(Tile *tile, int oldX, int oldY) override;
+    void CityCleared() override;
+    void CityLoaded() override;
+};
+
+#endif //CITY_CITYLIB_SUMMEDAREATABLE_H
@@ -0,0 +1,120 @@
+/**
+ * @file TextCache.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+#include <algorithm>
+#include <wx/dcmemory.h>
+#include "TextCache.h"
+
+/**
+ * Constructor
+ */
+TextCache::TextCache() : mColour(*wxBLACK)
+{
+}
+
+/**
+ * Set the font and colour the text is drawn in
+ *
+ * Any lines already rendered are dropped.
+ *
+ * @param font Font to draw in
+ * @param colour Colour to draw in
+ */
+void TextCache::SetFont(const wxFont &font, const wxColour &colour)
+{
+    mFont = font;
+    mColour = colour;
+    mLines.clear();
+}
+
+/**
+ * Start a new frame, dropping the lines
+ * that were not drawn in the last one
+ */
+void TextCache::NextFrame()
+{
+    for (auto line = mLines.begin(); line != mLines.end(); )
+    {
+        if (line->second.mFrame < mFrame)
+        {
+            line = mLines.erase(line);
+        }
+        else
+        {
+            ++line;
+        }
+    }
+
+    mFrame++;
+}
+
+/**
+ * Get a rendered line, rendering it if it is new
+ *
+ * The text is drawn white on black and the brightness
+ * of each pixel becomes its alpha, so the line keeps
+ * its antialiasing when drawn over anything.
+ *
+ * @param text Text of the line
+ * @return The line
+ */
+const TextCache::Line &TextCache::GetLine(const std::wstring &text)
+{
+    auto found = mLines.find(text);
+    if (found != mLines.end())
+    {
+        found->second.mFrame = mFrame;
+        return found->second;
+    }
+
+    wxBitmap measure(1, 1);
+    wxMemoryDC dc(measure);
+    dc.SetFont(mFont);
+    wxSize size = dc.GetTextExtent(text);
+    size.x = std::max(size.x, 1);
+    size.y = std::max(size.y, 1);
+
+    wxBitmap bitmap(size.x, size.y, 24);
+    dc.SelectObject(bitmap);
+    dc.SetBackground(wxBrush(*wxBLACK));
+    dc.Clear();
+    dc.SetTextForeground(*wxWHITE);
+    dc.DrawText(text, 0, 0);
+    dc.SelectObject(wxNullBitmap);
+
+    wxImage image = bitmap.ConvertToImage();
+    if (!image.HasAlpha())
+    {
+        image.InitAlpha();
+    }
+
+    unsigned char *rgb = image.GetData();
+    unsigned char *alpha = image.GetAlpha();
+    for (int i = 0; i < size.x * size.y; i++)
+    {
+        alpha[i] = std::max(rgb[i * 3], std::max(rgb[i * 3 + 1], rgb[i * 3 + 2]));
+        rgb[i * 3] = mColour.Red();
+        rgb[i * 3 + 1] = mColour.Green();
+        rgb[i * 3 + 2] = mColour.Blue();
+    }
+
+    auto &line = mLines[text];
+    line.mBitmap = std::make_unique<wxBitmap>(image);
+    line.mFrame = mFrame;
+    return line;
+}
+
+/**
+ * Draw a line of text
+ * @param dc Device context to draw on
+ * @param text Text of the line
+ * @param x Left of the text
+ * @param y Top of the text
+ */
+void TextCache::Draw(wxDC *dc, const std::wstring &text, int x, int y)
+{
+    dc->DrawBitmap(*GetLine(text).mBitmap, x, y);
+}
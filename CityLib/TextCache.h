@@ -0,0 +1,70 @@
+/**
+ * @file TextCache.h
+ * @author timan
+ *
+ * Lines of text kept as bitmaps so they are only laid out once
+ */
+
+#ifndef CITY_CITYLIB_TEXTCACHE_H
+#define CITY_CITYLIB_TEXTCACHE_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+/**
+ * Lines of text kept as bitmaps so they are only laid out once.
+ *
+ * Drawing text on a device context shapes it and rasterizes it
+ * every time. A line drawn through the cache is rendered once into
+ * a bitmap with an alpha channel, in the cache's font and colour,
+ * and after that drawing it is a single bitmap copy. Lines are
+ * found by their content, so a line that changes is simply a new
+ * line. Lines not drawn in a frame are dropped at the start of
+ * the next one, which keeps the cache the size of what is shown.
+ */
+class TextCache
+{
+private:
+    /// A line rendered into a bitmap
+    struct Line
+    {
+        std::unique_ptr<wxBitmap> mBitmap;  ///< The rendered line
+        int mFrame;                         ///< Last frame the line was drawn in
+    };
+
+    const Line &GetLine(const std::wstring &text);
+
+    /// Font the text is drawn in
+    wxFont mFont;
+
+    /// Colour the text is drawn in
+    wxColour mColour;
+
+    /// Rendered lines, by their text
+    std::unordered_map<std::wstring, Line> mLines;
+
+    /// Incremented at the start of each frame
+    int mFrame = 0;
+
+public:
+    TextCache();
+
+    /// Copy constructor (disabled)
+    TextCache(const TextCache &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const TextCache &) = delete;
+
+    void SetFont(const wxFont &font, const wxColour &colour);
+    void NextFrame();
+    void Draw(wxDC *dc, const std::wstring &text, int x, int y);
+
+    /**
+     * Get the number of lines rendered and kept
+     * @return Number of lines
+     */
+    int GetNumLines() const { return (int)mLines.size(); }
+};
+
+#endif //CITY_CITYLIB_TEXTCACHE_H
@@ -5,8 +5,10 @@
  */
 
 #include "pch.h"
+#include <algorithm>
 #include "Tile.h"
 #include "City.h"
+#include "DrawList.h"
 
 /**
  *  Distance from center for inside of tiles.
@@ -22,8 +24,9 @@ const int InsideTolerance = 64;
 
 /**  Constructor
  * @param city The city this item is a member of
+ * @param type The kind of tile this is
  */
-Tile::Tile(City *city) : mCity(city)
+Tile::Tile(City *city, TileType type) : mCity(city), mType(type)
 {
 }
 
@@ -41,38 +44,113 @@ Tile::~Tile()
  */
 void Tile::SetImage(const std::wstring &file)
 {
-    if (!file.empty())
+    if (!file.empty() && mCity->AreImagesEnabled())
     {
-        std::wstring filename = mCity->GetImagesDirectory() + L"/" + file;
-        mItemImage = std::make_unique<wxImage>(filename, wxBITMAP_TYPE_ANY);
-        mItemBitmap = std::make_unique<wxBitmap>(*mItemImage);
+        mSprite = mCity->GetAtlas().Load(mCity->GetImagesDirectory(), file);
     }
     else
     {
-        mItemImage.release();
-        mItemBitmap.release();
+        mSprite = SpriteAtlas::Sprite();
     }
 
     mFile = file;
 }
 
+/**
+ *  Draw this tile with a sprite already in the city atlas
+ * @param file The base filename the tile is saved with
+ * @param sprite The sprite, which may not be Ok to draw nothing
+ */
+void Tile::SetSprite(const std::wstring &file, const SpriteAtlas::Sprite &sprite)
+{
+    mSprite = sprite;
+    mFile = file;
+}
+
+/**  Set the item location
+ *
+ * If the tile is in the city, the city is told about
+ * the move so it can update anything that depends on it.
+ * @param x X location
+ * @param y Y location
+ */
+void Tile::SetLocation(int x, int y)
+{
+    int oldX = mX;
+    int oldY = mY;
+    mX = x;
+    mY = y;
+
+    if (mInCity && (x != oldX || y != oldY))
+    {
+        mCity->TileMoved(this, oldX, oldY);
+    }
+}
+
+/**
+ * Get the bounding rectangle of the sprite drawn for this tile.
+ * Tiles without an image use the bounds of the tile diamond.
+ * @return Bounding rectangle in pixels
+ */
+wxRect Tile::GetBounds() const
+{
+    if (mSprite.IsOk())
+    {
+        int wid = mSprite.mRect.width;
+        int hit = mSprite.mRect.height;
+        return wxRect(mX - OffsetLeft, mY + OffsetDown - hit, wid, hit);
+    }
+
+    return wxRect(mX - OffsetLeft, mY - OffsetDown, OffsetLeft * 2, OffsetDown * 2);
+}
+
 /**
  * Draw the tile.
  * @param dc Device context to draw the tile on
 */
 void Tile::Draw(wxDC* dc)
 {
-    if (mItemImage != nullptr)
+    if (mSprite.IsOk())
     {
-        int wid = mItemImage->GetWidth();
-        int hit = mItemImage->GetHeight();
+        int hit = mSprite.mRect.height;
 
-        dc->DrawBitmap(*mItemBitmap,
+        mCity->GetAtlas().Draw(dc, mSprite,
                 mX - OffsetLeft,
                 mY + OffsetDown - hit);
     }
 }
 
+/**
+ * Add the sprites this tile draws to a draw list
+ *
+ * Adds exactly what Draw would draw, in the same place.
+ *
+ * @param list Draw list to add to
+ */
+void Tile::AddToDrawList(DrawList *list)
+{
+    int hit = mSprite.mRect.height;
+    list->Add(mSprite, mX - OffsetLeft, mY + OffsetDown - hit);
+}
+
+
+/**
+ * Draw the tile zoomed out, with a reduced copy of its sprite.
+ * @param dc Device context to draw the tile on
+ * @param level Zoom level, drawing at 1/2^level of full size
+ */
+void Tile::DrawZoomed(wxDC* dc, int level)
+{
+    if (mSprite.IsOk())
+    {
+        // Keep the bottom of the sprite on the bottom of the tile
+        int hit = std::max(mSprite.mRect.height >> level, 1);
+        int bottom = (mY + OffsetDown) >> level;
+
+        mCity->GetMips().Draw(dc, mSprite, level, (mX - OffsetLeft) >> level, bottom - hit);
+    }
+}
+
 
 /**  Draw a border around the tile
  * @param dc The graphics context to draw on
@@ -89,8 +167,20 @@ void Tile::DrawBorder(wxDC* dc)
 
 bool Tile::HitTest(int x, int y)
 {
-    // Simple manhattan distance 
-    return (abs(x - mX) + abs(y - mY) * 2) <= InsideTolerance;
+    if (!mSprite.IsOk())
+    {
+        // Simple manhattan distance
+        return (abs(x - mX) + abs(y - mY) * 2) <= InsideTolerance;
+    }
+
+    int left = mX - OffsetLeft;
+    int top = mY + OffsetDown - mSprite.mRect.height;
+    if (x < left || y < top || x >= left + mSprite.mRect.width || y >= top + mSprite.mRect.height)
+    {
+        return false;
+    }
+
+    return mCity->GetAtlas().GetVisibleMask(mSprite).Test(x - left, y - top);
 }
 
 
@@ -136,24 +226,26 @@ void Tile::XmlLoad(wxXmlNode* node)
 void Tile::QuantizeLocation()
 {
     int spacing = City::GridSpacing;
+    int x, y;
     if (mX < 0)
     {
-        mX = ((mX + spacing / 2) / spacing) * spacing - spacing;
+        x = ((mX + spacing / 2) / spacing) * spacing - spacing;
     }
     else
     {
-        mX = ((mX + spacing / 2) / spacing) * spacing;
+        x = ((mX + spacing / 2) / spacing) * spacing;
     }
 
     if (mY < 0)
     {
-        mY = ((mY + spacing / 2) / spacing) * spacing - spacing;
+        y = ((mY + spacing / 2) / spacing) * spacing - spacing;
     }
     else
     {
-        mY = ((mY + spacing / 2) / spacing) * spacing;
+        y = ((mY + spacing / 2) / spacing) * spacing;
     }
 
+    SetLocation(x, y);
 }
 
 /**
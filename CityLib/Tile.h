@@ -11,8 +11,11 @@
 #include <string>
 #include <memory>
 #include "TileVisitor.h"
+#include "TileType.h"
+#include "SpriteAtlas.h"
 
 class City;
+class DrawList;
 class MemberReport;
 
 /**
@@ -24,21 +27,29 @@ private:
     /// The city this item is contained in
     City *mCity;
 
+    /// The kind of tile this is
+    TileType mType;
+
     // Item location in the city
     int   mX = 0;     ///< X location for the center of the item
     int   mY = 0;     ///< Y location for the center of the item
 
-    /// The image for this tile
-    std::unique_ptr<wxImage> mItemImage;
-
-    /// The bitmap for this tile
-    std::unique_ptr<wxBitmap> mItemBitmap;
+    /// Where the image for this tile is in the city sprite atlas
+    SpriteAtlas::Sprite mSprite;
 
     /// The file for this item
     std::wstring mFile;
 
+    /// Is this tile currently a member of its city?
+    bool mInCity = false;
+
+    /// Position of this tile in the order its city draws tiles
+    int mDrawOrder = -1;
+
 protected:
-    Tile(City *city);
+    Tile(City *city, TileType type);
+
+    void SetSprite(const std::wstring &file, const SpriteAtlas::Sprite &sprite);
 
 
 public:
@@ -65,6 +76,10 @@ public:
      * @return Filename or blank if none */
     std::wstring GetFile() { return mFile; }
 
+    /**  Get the kind of tile this is
+     * @return Tile type */
+    TileType GetType() const { return mType; }
+
     /**  The X location of the center of the tile
     * @return X location in pixels */
     int GetX() const { return mX; }
@@ -73,16 +88,40 @@ public:
     * @return Y location in pixels */
     int GetY() const { return mY; }
 
-    /**  Set the item location
-    * @param x X location
-    * @param y Y location */
-    void SetLocation(int x, int y) { mX = x; mY = y; }
+    void SetLocation(int x, int y);
+
+    /**  Is this tile currently a member of its city?
+    * @return true if the tile has been added to the city */
+    bool IsInCity() const { return mInCity; }
+
+    /**  Set whether this tile is a member of its city.
+    * This is maintained by City as tiles are added and removed.
+    * @param inCity true if the tile is now in the city */
+    void SetInCity(bool inCity) { mInCity = inCity; }
+
+    /**  Get the position of this tile in the order its city draws tiles.
+    * Tiles with larger values are drawn over those with smaller ones.
+    * @return Draw order, or -1 if not in a city */
+    int GetDrawOrder() const { return mDrawOrder; }
+
+    /**  Set the position of this tile in the order its city draws tiles.
+    * This is maintained by City as tiles are added, removed and reordered.
+    * @param order Draw order */
+    void SetDrawOrder(int order) { mDrawOrder = order; }
+
+    wxRect GetBounds() const;
 
     virtual void Draw(wxDC *dc);
 
+    void DrawZoomed(wxDC *dc, int level);
+
+    virtual void AddToDrawList(DrawList *list);
+
     virtual void DrawBorder(wxDC *dc);
 
-    /**  Test this item to see if it has been clicked on
+    /**  Test this item to see if it has been clicked on.
+    * A pixel of the sprite is clicked on if it is not fully
+    * transparent. Tiles without sprites use the grid diamond.
     * @param x X location on the city to test
     * @param y Y location on the city to test
     * @return true if clicked on */
@@ -15,7 +15,7 @@
  * Constructor
  * @param city The city this is a member of
 */
-TileBuilding::TileBuilding(City *city) : Tile(city)
+TileBuilding::TileBuilding(City *city) : Tile(city, TileType::Building)
 {
 }
 
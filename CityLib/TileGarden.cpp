@@ -43,7 +43,7 @@ const double GardenOvergrownTime4 = 10.0;
 /** Constructor
  * @param city The city this is a member of
  */
-TileGarden::TileGarden(City* city) : Tile(city)
+TileGarden::TileGarden(City* city) : Tile(city, TileType::Garden)
 {
     SetImage(GardenImage);
 }
@@ -17,7 +17,7 @@ const double DistributionRate = 40;
 /** Constructor
 * @param city The city this is a member of
 */
-TileLandscape::TileLandscape(City *city) : Tile(city)
+TileLandscape::TileLandscape(City *city) : Tile(city, TileType::Landscape)
 {
 }
 
@@ -12,9 +12,11 @@
 #include "MemberReport.h"
 #include "City.h"
 #include "Starship.h"
+#include "DrawList.h"
 #include "StarshipCheck.h"
 #include "HasStarship.h"
 #include "EmptyTileVisitor.h"
+#include "CompositeVisitor.h"
 
 
 /// The image to display for the starship pad
@@ -24,7 +26,7 @@ const std::wstring StarshipPadImage = L"pad.png";
 /** Constructor
 * @param city The city this is a member of
 */
-TileStarshipPad::TileStarshipPad(City* city) : Tile(city)
+TileStarshipPad::TileStarshipPad(City* city) : Tile(city, TileType::StarshipPad)
 {
 	HasStarship visitor;
 
@@ -77,13 +79,15 @@ void TileStarshipPad::Report(std::shared_ptr<MemberReport> report)
 bool TileStarshipPad::PendingDelete()
 {
 	if(this->mStarship != nullptr){
+		// Find an empty pad and the current starship
+		// in a single pass over the city
 		EmptyTileVisitor visitor;
-		this->GetCity()->Accept(&visitor);
+		HasStarship shipVisitor;
+		CompositeVisitor both{&visitor, &shipVisitor};
+		this->GetCity()->Accept(&both);
 
 		if(visitor.IsEmpty())
 		{
-			HasStarship shipVisitor;
-			this->GetCity()->Accept(&shipVisitor);
 
 			visitor.GetStarshipPad()->mStarship = shipVisitor.GetStarship();
 			visitor.GetStarshipPad()->mStarship->SetLaunchingPad(visitor.GetStarshipPad());
@@ -147,6 +151,27 @@ void TileStarshipPad::Draw(wxDC* dc)
 	}
 }
 
+/**
+ * Adds the TileStarshipPad to a draw list, followed
+ * by its Starship if it draws one
+ * @param list Draw list to add to
+ */
+void TileStarshipPad::AddToDrawList(DrawList* list)
+{
+	Tile::AddToDrawList(list);
+	StarshipCheck tileVisitor;
+	this->Accept(&tileVisitor);
+	if(tileVisitor.IsStarshipPad())
+	{
+		HasStarship shipVisitor;
+		this->Accept(&shipVisitor);
+		if(shipVisitor.GetStarship() != nullptr)
+		{
+			mStarship->AddToDrawList(this, list);
+		}
+	}
+}
+
 /**
  * A function that updates the TileStarshipPad
  * will call the update function for Starship object if associated
@@ -34,6 +34,7 @@ public:
     wxXmlNode* XmlSave(wxXmlNode* node) override;
 
 	void Draw(wxDC* dc) override;
+	void AddToDrawList(DrawList* list) override;
 	void Update(double elapsed) override;
 
 
@@ -0,0 +1,48 @@
+/**
+ * @file TileType.h
+ * @author timan
+ *
+ * Type tags for the kinds of tile in the city
+ */
+
+#ifndef CITY_CITYLIB_TILETYPE_H
+#define CITY_CITYLIB_TILETYPE_H
+
+/**
+ * The kinds of tile in the city. Every tile stores
+ * its type so code can test it without a visitor.
+ */
+enum class TileType { Landscape, Building, Garden, Water, StarshipPad };
+
+/// The number of values in TileType
+const int NumTileTypes = 5;
+
+/**
+ * Get a display name for a tile type
+ * @param type Tile type
+ * @return Name of the type
+ */
+inline const wchar_t *TileTypeName(TileType type)
+{
+    switch (type)
+    {
+        case TileType::Landscape:
+            return L"Landscape";
+
+        case TileType::Building:
+            return L"Building";
+
+        case TileType::Garden:
+            return L"Garden";
+
+        case TileType::Water:
+            return L"Water";
+
+        case TileType::StarshipPad:
+            return L"Starship Pad";
+    }
+
+    return L"";
+}
+
+#endif //CITY_CITYLIB_TILETYPE_H
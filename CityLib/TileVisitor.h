@@ -8,6 +8,8 @@
 #ifndef CITY_TILEVISITOR_H
 #define CITY_TILEVISITOR_H
 
+#include <memory>
+
 // Forward references to all tile types
 class TileBuilding;
 class TileLandscape;
@@ -58,6 +60,23 @@ public:
 	 */
 	 virtual void VisitStarshipPad(TileStarshipPad* pad){}
 
+	/**
+	 * Create a new, empty visitor of the same kind for one
+	 * worker of a parallel traversal (City::ParallelAccept).
+	 *
+	 * The default returns nullptr, which means the visitor
+	 * cannot be run in parallel and is visited on the calling
+	 * thread instead.
+	 * @return New visitor or nullptr if not parallelizable
+	 */
+	virtual std::unique_ptr<TileVisitor> Clone() const { return nullptr; }
+
+	/**
+	 * Merge the results of a worker visitor created by Clone
+	 * into this visitor. Workers are reduced in tile order.
+	 * @param other Visitor to merge, of the same kind as this one
+	 */
+	virtual void Reduce(TileVisitor* other) {}
 };
 
 #endif //CITY_TILEVISITOR_H
@@ -5,8 +5,9 @@
 
 #include "pch.h"
 #include "TileWater.h"
+#include "City.h"
 
-/// Garden base image
+/// Water base image
 const std::wstring WaterImage = L"water.png";
 
 /**
@@ -14,9 +15,10 @@ const std::wstring WaterImage = L"water.png";
  * @param city City this water object inhabits.
  */
 TileWater::TileWater(City* city)
-        :Tile(city)
+        :Tile(city, TileType::Water)
 {
-    SetImage(WaterImage);
+    // Until it is placed next to other water, this is a pond
+    SetEdges(0);
 }
 
 
@@ -34,3 +36,39 @@ wxXmlNode* TileWater::XmlSave(wxXmlNode* node)
 
     return itemNode;
 }
+
+
+/**
+ * Set the mask of the neighbors that are water, choosing
+ * the shoreline sprite shared by all tiles with that mask
+ * @param edges Mask with a bit set for each neighbor that is water
+ */
+void TileWater::SetEdges(int edges)
+{
+    if (edges == mEdges)
+    {
+        return;
+    }
+
+    mEdges = edges;
+
+    SetSprite(WaterImage, GetCity()->GetWaterEdges().GetSprite(edges));
+}
+
+/**
+ * Get an identifier for the body of water this tile belongs to
+ * @return Body identifier, shared by all tiles in the body
+ */
+int TileWater::GetBody()
+{
+    return GetCity()->GetWaterBodies().GetBody(this);
+}
+
+/**
+ * Get the number of tiles in the body of water this tile belongs to
+ * @return Number of water tiles
+ */
+int TileWater::GetBodySize()
+{
+    return GetCity()->GetWaterBodies().GetBodySize(this);
+}
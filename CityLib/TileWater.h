@@ -14,6 +14,10 @@
  * A water tile
  */
 class TileWater: public Tile {
+private:
+    /// Mask of the neighbors that are water, or -1 if not set yet
+    int mEdges = -1;
+
 public:
     TileWater(City* city);
 
@@ -28,6 +32,17 @@ public:
 
     virtual wxXmlNode* XmlSave(wxXmlNode* node) override;
 
+    int GetBody();
+    int GetBodySize();
+
+    void SetEdges(int edges);
+
+    /**
+     * Get the mask of the neighbors that are water
+     * @return Mask with a bit set for each neighbor that is water
+     */
+    int GetEdges() const { return mEdges; }
+
 	/**
  	* Accept a visitor
  	* @param visitor The visitor we accept
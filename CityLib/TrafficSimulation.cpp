@@ -0,0 +1,761 @@
+/**
+ * @file TrafficSimulation.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include "TrafficSimulation.h"
+#include "City.h"
+#include "WorkerPool.h"
+
+/// Walking speed of an agent in pixels per second
+const float AgentSpeed = 120;
+
+/// Average time an agent spends in a building in seconds
+const float VisitTime = 5;
+
+/// Longest time a single update moves agents, in seconds
+const double MaxElapsed = 0.25;
+
+/// Distance from home first searched for destinations in pixels
+const int NearbyRadius = 256;
+
+/// Farthest an agent will go from home in pixels
+const int TripRadius = 2048;
+
+/// Most destinations considered for each house
+const int MaxNearby = 4;
+
+/// Most locations all the route searches in one update will visit
+const int MaxSearchLocationsPerUpdate = 16384;
+
+/// Most locations a single route search will visit
+const int MaxSearchLocations = 1024;
+
+/// Most routes kept in the cache
+const size_t MaxCachedRoutes = 65536;
+
+/// Size of an agent when drawn in pixels
+const int AgentSize = 4;
+
+/// Images of the buildings agents live in
+const wchar_t *HomeImages[] = {L"house.png", L"yellowhouse.png", L"condos.png"};
+
+/**
+ * Constructor
+ * @param city The city we are simulating
+ */
+TrafficSimulation::TrafficSimulation(City *city) : mCity(city)
+{
+}
+
+/**
+ * Can agents walk over a tile?
+ * @param tile Tile to test
+ * @return true if walkable
+ */
+bool TrafficSimulation::IsWalkable(Tile *tile)
+{
+    return tile->GetType() == TileType::Landscape || tile->GetType() == TileType::Garden;
+}
+
+/**
+ * Is a tile a building agents live in?
+ * @param tile Tile to test
+ * @return true if a house
+ */
+bool TrafficSimulation::IsHome(Tile *tile)
+{
+    for (auto image : HomeImages)
+    {
+        if (tile->GetFile() == image)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Add a tile at a location to what agents know about the city
+ * @param tile The tile
+ * @param x X location of the tile in pixels
+ * @param y Y location of the tile in pixels
+ */
+void TrafficSimulation::AddTile(Tile *tile, int x, int y)
+{
+    Cell cell = City::GetGridCell(x, y);
+    if (IsWalkable(tile))
+    {
+        if (mWalkable[cell]++ == 0)
+        {
+            InvalidateRoutes();
+        }
+    }
+    else if (tile->GetType() == TileType::Building)
+    {
+        bool home = IsHome(tile);
+        mBuildings[tile] = {cell, home};
+        if (home)
+        {
+            mHomes.push_back(cell);
+        }
+        else
+        {
+            mDestinations[cell]++;
+            mNearby.clear();
+        }
+    }
+}
+
+/**
+ * Remove a tile at a location from what agents know about the city
+ * @param tile The tile
+ * @param x X location of the tile in pixels
+ * @param y Y location of the tile in pixels
+ */
+void TrafficSimulation::RemoveTile(Tile *tile, int x, int y)
+{
+    Cell cell = City::GetGridCell(x, y);
+    if (IsWalkable(tile))
+    {
+        auto walkable = mWalkable.find(cell);
+        if (walkable != mWalkable.end() && --walkable->second == 0)
+        {
+            mWalkable.erase(walkable);
+            InvalidateRoutes();
+        }
+
+        return;
+    }
+
+    auto building = mBuildings.find(tile);
+    if (building == mBuildings.end())
+    {
+        return;
+    }
+
+    bool home = building->second.mHome;
+    mBuildings.erase(building);
+
+    if (home)
+    {
+        auto entry = std::find(mHomes.begin(), mHomes.end(), cell);
+        if (entry != mHomes.end())
+        {
+            *entry = mHomes.back();
+            mHomes.pop_back();
+        }
+
+        if (std::find(mHomes.begin(), mHomes.end(), cell) == mHomes.end())
+        {
+            // Nobody lives here any more
+            for (int agent = (int)mX.size() - 1; agent >= 0; agent--)
+            {
+                if (mHome[agent] == cell)
+                {
+                    RemoveAgent(agent);
+                }
+            }
+        }
+    }
+    else
+    {
+        auto destination = mDestinations.find(cell);
+        if (destination != mDestinations.end() && --destination->second == 0)
+        {
+            mDestinations.erase(destination);
+        }
+
+        mNearby.clear();
+    }
+}
+
+/**
+ * Rebuild what agents know about the city from its tiles
+ */
+void TrafficSimulation::Rebuild()
+{
+    int target = mTargetAgents;
+    CityCleared();
+    mTargetAgents = target;
+
+    for (auto tile : *mCity)
+    {
+        AddTile(tile.get(), tile->GetX(), tile->GetY());
+    }
+}
+
+/**
+ * Empty the route cache, after the tiles agents can walk on change.
+ * Agents already travelling keep the routes they have.
+ */
+void TrafficSimulation::InvalidateRoutes()
+{
+    mRoutes.clear();
+}
+
+/**
+ * Set how many agents there should be. Agents are added
+ * to or removed from the city on the next update.
+ * @param numAgents Number of agents
+ */
+void TrafficSimulation::SetNumAgents(int numAgents)
+{
+    mTargetAgents = numAgents;
+    mAgentsPerHome = 0;
+}
+
+/**
+ * Set how many agents there should be for each house, so
+ * the number of agents follows the houses as they are added
+ * and removed. Agents are added to or removed from the city
+ * on the next update.
+ * @param agentsPerHome Number of agents for each house
+ * @param maxAgents Most agents there should be
+ */
+void TrafficSimulation::SetAgentsPerHome(int agentsPerHome, int maxAgents)
+{
+    mAgentsPerHome = agentsPerHome;
+    mMaxAgents = maxAgents;
+}
+
+/**
+ * Add an agent, visiting its home
+ * @param home House the agent lives in
+ */
+void TrafficSimulation::AddAgent(Cell home)
+{
+    mX.push_back((float)(GridCell::Column(home) * City::GridSpacing));
+    mY.push_back((float)(GridCell::Row(home) * City::GridSpacing));
+    mState.push_back(State::Visiting);
+    mTimer.push_back(0);
+    mStep.push_back(0);
+    mHome.push_back(home);
+    mAt.push_back(home);
+    mRoute.push_back(nullptr);
+
+    StartVisit((int)mX.size() - 1);
+}
+
+/**
+ * Remove an agent. The last agent is moved into its place.
+ * @param agent Agent to remove
+ */
+void TrafficSimulation::RemoveAgent(int agent)
+{
+    int last = (int)mX.size() - 1;
+    mX[agent] = mX[last];
+    mY[agent] = mY[last];
+    mState[agent] = mState[last];
+    mTimer[agent] = mTimer[last];
+    mStep[agent] = mStep[last];
+    mHome[agent] = mHome[last];
+    mAt[agent] = mAt[last];
+    mRoute[agent] = std::move(mRoute[last]);
+
+    mX.pop_back();
+    mY.pop_back();
+    mState.pop_back();
+    mTimer.pop_back();
+    mStep.pop_back();
+    mHome.pop_back();
+    mAt.pop_back();
+    mRoute.pop_back();
+}
+
+/**
+ * Have an agent spend a while in the building it is at
+ * @param agent Agent
+ */
+void TrafficSimulation::StartVisit(int agent)
+{
+    std::uniform_real_distribution<float> time(VisitTime * 0.5f, VisitTime * 1.5f);
+    mState[agent] = State::Visiting;
+    mTimer[agent] = time(mRandom);
+    mRoute[agent] = nullptr;
+}
+
+/**
+ * Start an agent on a trip from the building it is at.
+ *
+ * Agents at home go to a nearby workplace or shop;
+ * agents anywhere else go home.
+ * @param agent Agent
+ * @param budget Locations route searches may still visit in this update
+ * @return false if the agent must wait for a route search
+ */
+bool TrafficSimulation::StartTrip(int agent, int &budget)
+{
+    Cell from = mAt[agent];
+    Cell to = mHome[agent];
+    if (from == to)
+    {
+        auto &destinations = GetDestinations(from);
+        if (destinations.empty())
+        {
+            StartVisit(agent);
+            return true;
+        }
+
+        std::uniform_int_distribution<int> pick(0, (int)destinations.size() - 1);
+        to = destinations[pick(mRandom)];
+    }
+
+    std::shared_ptr<const Route> route;
+    if (!FindRoute(from, to, budget, route))
+    {
+        return false;
+    }
+
+    if (route == nullptr)
+    {
+        if (to == mHome[agent])
+        {
+            // No way home, so the agent finds another way there
+            mX[agent] = (float)(GridCell::Column(to) * City::GridSpacing);
+            mY[agent] = (float)(GridCell::Row(to) * City::GridSpacing);
+            mAt[agent] = to;
+        }
+
+        StartVisit(agent);
+        return true;
+    }
+
+    mRoute[agent] = route;
+    mStep[agent] = 1;
+    mAt[agent] = to;
+    mState[agent] = State::Travelling;
+    return true;
+}
+
+/**
+ * Get the workplaces and shops near a house
+ * @param home Grid location of the house
+ * @return Grid locations of the nearest destinations
+ */
+const std::vector<TrafficSimulation::Cell> &TrafficSimulation::GetDestinations(Cell home)
+{
+    auto found = mNearby.find(home);
+    if (found != mNearby.end())
+    {
+        return found->second;
+    }
+
+    int x = GridCell::Column(home) * City::GridSpacing;
+    int y = GridCell::Row(home) * City::GridSpacing;
+
+    // Search outward until there are enough destinations
+    std::vector<Tile *> tiles;
+    std::vector<std::pair<long long, Cell>> candidates;
+    for (int radius = NearbyRadius; radius <= TripRadius && (int)candidates.size() < MaxNearby; radius *= 2)
+    {
+        tiles.clear();
+        candidates.clear();
+        mCity->GetSpatialIndex().QueryRadius(x, y, radius, tiles);
+
+        for (auto tile : tiles)
+        {
+            if (tile->GetType() != TileType::Building)
+            {
+                continue;
+            }
+
+            auto building = mBuildings.find(tile);
+            if (building != mBuildings.end() && !building->second.mHome)
+            {
+                long long dx = tile->GetX() - x;
+                long long dy = tile->GetY() - y;
+                candidates.emplace_back(dx * dx + dy * dy, building->second.mCell);
+            }
+        }
+    }
+
+    int count = std::min((int)candidates.size(), MaxNearby);
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+
+    auto &destinations = mNearby[home];
+    for (int i = 0; i < count; i++)
+    {
+        destinations.push_back(candidates[i].second);
+    }
+
+    return destinations;
+}
+
+/**
+ * Find a route, from the cache if possible
+ * @param from Start of the route
+ * @param to End of the route
+ * @param budget Locations route searches may still visit in this update
+ * @param route Set to the route or nullptr if there is none
+ * @return false if no more searching can be done in this update
+ */
+bool TrafficSimulation::FindRoute(Cell from, Cell to, int &budget, std::shared_ptr<const Route> &route)
+{
+    RouteKey key = {from, to};
+    auto found = mRoutes.find(key);
+    if (found != mRoutes.end())
+    {
+        route = found->second;
+        return true;
+    }
+
+    if (budget <= 0)
+    {
+        return false;
+    }
+
+    route = Search(from, to, budget);
+
+    if (mRoutes.size() >= MaxCachedRoutes)
+    {
+        mRoutes.clear();
+    }
+
+    mRoutes[key] = route;
+    return true;
+}
+
+/**
+ * Search for a route with A*.
+ *
+ * A route may start and end at buildings, but every
+ * location between must be walkable.
+ * @param from Start of the route
+ * @param to End of the route
+ * @param budget Reduced by the number of locations visited
+ * @return Route or nullptr if none was found nearby
+ */
+std::shared_ptr<const TrafficSimulation::Route> TrafficSimulation::Search(Cell from, Cell to, int &budget)
+{
+    const int toCol = GridCell::Column(to);
+    const int toRow = GridCell::Row(to);
+
+    // Each step moves two columns and one row, so this
+    // never overestimates the steps still needed
+    auto estimate = [toCol, toRow](int col, int row) {
+        return std::max(std::abs(toCol - col) / 2, std::abs(toRow - row));
+    };
+
+    // Distance from the start and the previous location on the best way there
+    auto &visited = mVisited;
+    ClearVisited();
+
+    // Locations to try, a heap with the shortest estimated total length on top
+    typedef std::pair<int, Cell> Entry;
+    auto &pending = mPending;
+    std::greater<Entry> longer;
+    pending.clear();
+    std::shared_ptr<Route> route;
+
+    AddVisited(from, 0, from);
+    pending.emplace_back(estimate(GridCell::Column(from), GridCell::Row(from)), from);
+
+    while (!pending.empty())
+    {
+        std::pop_heap(pending.begin(), pending.end(), longer);
+        Cell cell = pending.back().second;
+        pending.pop_back();
+
+        if (cell == to)
+        {
+            route = std::make_shared<Route>();
+            for (Cell at = to; ; at = visited[at].second)
+            {
+                route->mPoints.emplace_back((float)(GridCell::Column(at) * City::GridSpacing),
+                                            (float)(GridCell::Row(at) * City::GridSpacing));
+                if (at == from)
+                {
+                    break;
+                }
+            }
+
+            std::reverse(route->mPoints.begin(), route->mPoints.end());
+            break;
+        }
+
+        if ((int)visited.size() > MaxSearchLocations)
+        {
+            break;
+        }
+
+        int col = GridCell::Column(cell);
+        int row = GridCell::Row(cell);
+        int distance = visited[cell].first + 1;
+        for (auto &offset : GridCell::Neighbors)
+        {
+            Cell neighbor = GridCell::Make(col + offset[0], row + offset[1]);
+            if (neighbor != to && mWalkable.find(neighbor) == mWalkable.end())
+            {
+                continue;
+            }
+
+            auto known = visited.find(neighbor);
+            if (known == visited.end() || known->second.first > distance)
+            {
+                if (known == visited.end())
+                {
+                    AddVisited(neighbor, distance, cell);
+                }
+                else
+                {
+                    known->second = std::make_pair(distance, cell);
+                }
+
+                pending.emplace_back(distance + estimate(col + offset[0], row + offset[1]), neighbor);
+                std::push_heap(pending.begin(), pending.end(), longer);
+            }
+        }
+    }
+
+    budget -= (int)visited.size();
+    return route;
+}
+
+/**
+ * Empty the locations visited by the last route search,
+ * keeping their entries for the next search to reuse
+ */
+void TrafficSimulation::ClearVisited()
+{
+    while (!mVisited.empty())
+    {
+        mFreeVisits.push_back(mVisited.extract(mVisited.begin()));
+    }
+}
+
+/**
+ * Add a location to those visited by a route search
+ * @param cell Location, which must not have been visited yet
+ * @param distance Distance from the start of the search
+ * @param previous Previous location on the best way to the location
+ */
+void TrafficSimulation::AddVisited(Cell cell, int distance, Cell previous)
+{
+    if (mFreeVisits.empty())
+    {
+        mVisited.emplace(cell, std::make_pair(distance, previous));
+        return;
+    }
+
+    auto visit = std::move(mFreeVisits.back());
+    mFreeVisits.pop_back();
+    visit.key() = cell;
+    visit.mapped() = std::make_pair(distance, previous);
+    mVisited.insert(std::move(visit));
+}
+
+/**
+ * Move the agents and start new trips and visits
+ * @param elapsed The time since the last update in seconds
+ */
+void TrafficSimulation::Update(double elapsed)
+{
+    if (mAgentsPerHome > 0)
+    {
+        mTargetAgents = std::min((int)mHomes.size() * mAgentsPerHome, mMaxAgents);
+    }
+
+    // Bring the number of agents up or down to the target
+    while ((int)mX.size() > mTargetAgents)
+    {
+        RemoveAgent((int)mX.size() - 1);
+    }
+
+    if (!mHomes.empty())
+    {
+        while ((int)mX.size() < mTargetAgents)
+        {
+            AddAgent(mHomes[mX.size() % mHomes.size()]);
+        }
+    }
+
+    if (mX.empty())
+    {
+        return;
+    }
+
+    float step = (float)std::min(elapsed, MaxElapsed);
+
+    float *xs = mX.data();
+    float *ys = mY.data();
+    State *states = mState.data();
+    float *timers = mTimer.data();
+    int *steps = mStep.data();
+    const std::shared_ptr<const Route> *routes = mRoute.data();
+
+    WorkerPool::Get().ParallelFor((int)mX.size(),
+            [xs, ys, states, timers, steps, routes, step](int begin, int end, int worker) {
+        for (int agent = begin; agent < end; agent++)
+        {
+            if (states[agent] == State::Visiting)
+            {
+                timers[agent] -= step;
+                if (timers[agent] <= 0)
+                {
+                    states[agent] = State::Ready;
+                }
+
+                continue;
+            }
+
+            if (states[agent] != State::Travelling)
+            {
+                continue;
+            }
+
+            // Walk along the route as far as this update allows
+            auto &points = routes[agent]->mPoints;
+            float distance = AgentSpeed * step;
+            float x = xs[agent];
+            float y = ys[agent];
+            int next = steps[agent];
+            while (distance > 0 && next < (int)points.size())
+            {
+                float dx = points[next].first - x;
+                float dy = points[next].second - y;
+                float length = std::sqrt(dx * dx + dy * dy);
+                if (length <= distance)
+                {
+                    x = points[next].first;
+                    y = points[next].second;
+                    distance -= length;
+                    next++;
+                }
+                else
+                {
+                    x += dx * distance / length;
+                    y += dy * distance / length;
+                    distance = 0;
+                }
+            }
+
+            xs[agent] = x;
+            ys[agent] = y;
+            steps[agent] = next;
+            if (next == (int)points.size())
+            {
+                states[agent] = State::Arrived;
+            }
+        }
+    });
+
+    // Trips and visits use the cache and random numbers,
+    // so they are started here one agent at a time
+    int budget = MaxSearchLocationsPerUpdate;
+    for (int agent = 0; agent < (int)mX.size(); agent++)
+    {
+        if (mState[agent] == State::Arrived)
+        {
+            StartVisit(agent);
+        }
+        else if (mState[agent] == State::Ready)
+        {
+            // Agents that cannot get a route now try again next update
+            StartTrip(agent, budget);
+        }
+    }
+}
+
+/**
+ * Draw the agents that are travelling.
+ *
+ * The visible agents are gathered first, then all
+ * drawn with the same pen and brush, which are kept
+ * from frame to frame.
+ * @param dc Device context to draw on
+ * @param visible Area of the city that is visible
+ */
+void TrafficSimulation::Draw(wxDC *dc, const wxRect &visible)
+{
+    mDrawPoints.clear();
+    for (int agent = 0; agent < (int)mX.size(); agent++)
+    {
+        if (mState[agent] == State::Travelling)
+        {
+            int x = (int)mX[agent];
+            int y = (int)mY[agent];
+            if (visible.Contains(x, y))
+            {
+                mDrawPoints.emplace_back(x - AgentSize / 2, y - AgentSize / 2);
+            }
+        }
+    }
+
+    dc->SetPen(mAgentPen);
+    dc->SetBrush(mAgentBrush);
+    for (auto &point : mDrawPoints)
+    {
+        dc->DrawRectangle(point.x, point.y, AgentSize, AgentSize);
+    }
+}
+
+/**
+ * A tile has been added to the city
+ * @param tile Tile that was added
+ */
+void TrafficSimulation::TileAdded(std::shared_ptr<Tile> tile)
+{
+    AddTile(tile.get(), tile->GetX(), tile->GetY());
+}
+
+/**
+ * A tile is being removed from the city
+ * @param tile Tile that is being removed
+ */
+void TrafficSimulation::TileRemoved(std::shared_ptr<Tile> tile)
+{
+    RemoveTile(tile.get(), tile->GetX(), tile->GetY());
+}
+
+/**
+ * A tile has moved, which may move it to another grid location
+ * @param tile Tile that moved
+ * @param oldX Previous X location of the tile
+ * @param oldY Previous Y location of the tile
+ */
+void TrafficSimulation::TileMoved(Tile *tile, int oldX, int oldY)
+{
+    if (City::GetGridCell(oldX, oldY) != City::GetGridCell(tile->GetX(), tile->GetY()))
+    {
+        RemoveTile(tile, oldX, oldY);
+        AddTile(tile, tile->GetX(), tile->GetY());
+    }
+}
+
+/**
+ * The city has been cleared
+ */
+void TrafficSimulation::CityCleared()
+{
+    mWalkable.clear();
+    mBuildings.clear();
+    mHomes.clear();
+    mDestinations.clear();
+    mRoutes.clear();
+    mNearby.clear();
+
+    mX.clear();
+    mY.clear();
+    mState.clear();
+    mTimer.clear();
+    mStep.clear();
+    mHome.clear();
+    mAt.clear();
+    mRoute.clear();
+}
+
+/**
+ * The city has been loaded
+ */
+void TrafficSimulation::CityLoaded()
+{
+    Rebuild();
+}
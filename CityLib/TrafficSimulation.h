@@ -0,0 +1,218 @@
+/**
+ * @file TrafficSimulation.h
+ * @author timan
+ *
+ * People travelling between the buildings of the city
+ */
+
+#ifndef CITY_CITYLIB_TRAFFICSIMULATION_H
+#define CITY_CITYLIB_TRAFFICSIMULATION_H
+
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "CityObserver.h"
+#include "GridCell.h"
+
+class City;
+
+/**
+ * People travelling between the buildings of the city.
+ *
+ * Each agent lives in a house, walks to a nearby workplace or
+ * shop, stays a while and walks home again. Agents walk over
+ * landscape and garden tiles, stepping between tiles adjacent
+ * in the City::GetAdjacent sense.
+ *
+ * Routes are found with A* and cached by their end points, so
+ * the agents of a house share the few routes they use. Searches
+ * in each update may only visit so many locations in total;
+ * agents waiting for a route simply stay where they are. Any
+ * change to the tiles that can be walked on empties the cache.
+ *
+ * Agents are kept in parallel arrays, one per field, packed at
+ * the front. Moving them is a pass over those arrays on the
+ * worker pool. Starting trips, which touches the cache, is done
+ * afterward for just the agents that need it.
+ */
+class TrafficSimulation : public CityObserver
+{
+private:
+    /// A grid location packed into a single key
+    typedef GridCell::Key Cell;
+
+    /// A route between two buildings
+    struct Route
+    {
+        /// Points along the route in pixels
+        std::vector<std::pair<float, float>> mPoints;
+    };
+
+    /// What an agent is doing. Arrived and Ready are
+    /// set while moving agents and handled afterward.
+    enum class State : unsigned char { Visiting, Travelling, Arrived, Ready };
+
+    /// A building agents travel to or from
+    struct Building
+    {
+        Cell mCell;                 ///< Grid location
+        bool mHome;                 ///< Do agents live here?
+    };
+
+    /// Key for the route cache, the two end points
+    struct RouteKey
+    {
+        Cell mFrom;     ///< Start of the route
+        Cell mTo;       ///< End of the route
+
+        /**
+         * Compare keys
+         * @param other Key to compare to
+         * @return true if equal
+         */
+        bool operator==(const RouteKey &other) const { return mFrom == other.mFrom && mTo == other.mTo; }
+    };
+
+    /// Hash function for route keys
+    struct RouteKeyHash
+    {
+        /**
+         * Hash a key
+         * @param key Key to hash
+         * @return Hash value
+         */
+        size_t operator()(const RouteKey &key) const
+        {
+            return std::hash<Cell>()(key.mFrom * 0x9E3779B97F4A7C15LL ^ key.mTo);
+        }
+    };
+
+    /// Distance from the start of a route search and the
+    /// previous location on the best way, for each location visited
+    typedef std::unordered_map<Cell, std::pair<int, Cell>> VisitedMap;
+
+    static bool IsWalkable(Tile *tile);
+    static bool IsHome(Tile *tile);
+
+    void AddTile(Tile *tile, int x, int y);
+    void RemoveTile(Tile *tile, int x, int y);
+    void Rebuild();
+
+    void AddAgent(Cell home);
+    void RemoveAgent(int agent);
+    void StartVisit(int agent);
+    bool StartTrip(int agent, int &budget);
+    const std::vector<Cell> &GetDestinations(Cell home);
+    bool FindRoute(Cell from, Cell to, int &budget, std::shared_ptr<const Route> &route);
+    std::shared_ptr<const Route> Search(Cell from, Cell to, int &budget);
+    void ClearVisited();
+    void AddVisited(Cell cell, int distance, Cell previous);
+    void InvalidateRoutes();
+
+    /// The city we are simulating
+    City *mCity;
+
+    /// Number of walkable tiles at each grid location
+    std::unordered_map<Cell, int> mWalkable;
+
+    /// The buildings agents travel to or from
+    std::unordered_map<Tile *, Building> mBuildings;
+
+    /// Grid locations of the houses, one entry per house
+    std::vector<Cell> mHomes;
+
+    /// Grid locations of the workplaces and shops, one entry per building
+    std::unordered_map<Cell, int> mDestinations;
+
+    /// Cached routes, nullptr where no route was found
+    std::unordered_map<RouteKey, std::shared_ptr<const Route>, RouteKeyHash> mRoutes;
+
+    /// Cached destinations near each house
+    std::unordered_map<Cell, std::vector<Cell>> mNearby;
+
+    /// Locations visited by a route search, kept between searches
+    VisitedMap mVisited;
+
+    /// Entries of mVisited from earlier searches, reused so searches do not allocate
+    std::vector<VisitedMap::node_type> mFreeVisits;
+
+    /// Locations a route search still has to try, as a heap kept between searches
+    std::vector<std::pair<int, Cell>> mPending;
+
+    /// Number of agents wanted
+    int mTargetAgents = 0;
+
+    /// Agents wanted for each house, or 0 for a fixed number
+    int mAgentsPerHome = 0;
+
+    /// Most agents wanted when following the number of houses
+    int mMaxAgents = 0;
+
+    /// Random numbers for trip choices and visit times
+    std::mt19937 mRandom;
+
+    //
+    // The agents, one entry per agent in each array
+    //
+
+    std::vector<float> mX;                  ///< X location in pixels
+    std::vector<float> mY;                  ///< Y location in pixels
+    std::vector<State> mState;              ///< What the agent is doing
+    std::vector<float> mTimer;              ///< Time left visiting in seconds
+    std::vector<int> mStep;                 ///< Next point on the route
+    std::vector<Cell> mHome;                ///< House the agent lives in
+    std::vector<Cell> mAt;                  ///< Building the agent is at or heading to
+    std::vector<std::shared_ptr<const Route>> mRoute;   ///< Route being travelled
+
+    /// Locations of the agents drawn, kept to avoid allocating each frame
+    std::vector<wxPoint> mDrawPoints;
+
+    /// Outline of the agents
+    wxPen mAgentPen{wxColour(0, 0, 0)};
+
+    /// Fill of the agents
+    wxBrush mAgentBrush{wxColour(255, 220, 0)};
+
+public:
+    explicit TrafficSimulation(City *city);
+
+    /// Copy constructor (disabled)
+    TrafficSimulation(const TrafficSimulation &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const TrafficSimulation &) = delete;
+
+    void SetNumAgents(int numAgents);
+    void SetAgentsPerHome(int agentsPerHome, int maxAgents);
+
+    /**
+     * Get the number of agents
+     * @return Number of agents
+     */
+    int GetNumAgents() const { return (int)mX.size(); }
+
+    /**
+     * Get the number of houses agents can live in
+     * @return Number of houses
+     */
+    int GetNumHomes() const { return (int)mHomes.size(); }
+
+    /**
+     * Get the number of routes in the cache
+     * @return Number of cached routes
+     */
+    int GetNumRoutes() const { return (int)mRoutes.size(); }
+
+    void Update(double elapsed);
+    void Draw(wxDC *dc, const wxRect &visible);
+
+    void TileAdded(std::shared_ptr<Tile> tile) override;
+    void TileRemoved(std::shared_ptr<Tile> tile) override;
+    void TileMoved(Tile *tile, int oldX, int oldY) override;
+    void CityCleared() override;
+    void CityLoaded() override;
+};
+
+#endif //CITY_CITYLIB_TRAFFICSIMULATION_H
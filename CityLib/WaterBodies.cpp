@@ -0,0 +1,326 @@
+/**
+ * @file WaterBodies.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+
+#include <algorithm>
+
+#include "WaterBodies.h"
+#include "City.h"
+
+/**
+ * Constructor
+ * @param city The city we are tracking
+ */
+WaterBodies::WaterBodies(City *city) : mCity(city)
+{
+}
+
+/**
+ * Call a function for the nodes at a grid location
+ * and the four locations adjacent to it.
+ * @param cell Grid location
+ * @param function Function to call with each node
+ */
+template <typename Function>
+void WaterBodies::ForEachNeighbor(Cell cell, Function function) const
+{
+    // The location itself comes first, then its neighbors
+    for (int neighbor = -1; neighbor < GridCell::NumNeighbors; neighbor++)
+    {
+        auto found = mCells.find(neighbor < 0 ? cell : GridCell::Neighbor(cell, neighbor));
+        if (found != mCells.end())
+        {
+            for (auto node : found->second)
+            {
+                function(node);
+            }
+        }
+    }
+}
+
+/**
+ * Find the root node of the body a node belongs to
+ * @param node Node to find the root of
+ * @return Root node
+ */
+int WaterBodies::Find(int node) const
+{
+    while (mParents[node] != node)
+    {
+        // Point every other node at its grandparent
+        mParents[node] = mParents[mParents[node]];
+        node = mParents[node];
+    }
+
+    return node;
+}
+
+/**
+ * Merge the bodies two nodes belong to
+ * @param a First node
+ * @param b Second node
+ */
+void WaterBodies::Union(int a, int b)
+{
+    a = Find(a);
+    b = Find(b);
+    if (a == b)
+    {
+        return;
+    }
+
+    // Hang the smaller body under the larger
+    if (mSizes[a] < mSizes[b])
+    {
+        std::swap(a, b);
+    }
+
+    mParents[b] = a;
+    mSizes[a] += mSizes[b];
+    mNumBodies--;
+}
+
+/**
+ * Add a water tile at a grid location, merging
+ * it with any bodies it touches
+ * @param tile Tile to add
+ * @param cell Grid location of the tile
+ */
+void WaterBodies::Insert(Tile *tile, Cell cell)
+{
+    int node;
+    if (!mFreeNodes.empty())
+    {
+        node = mFreeNodes.back();
+        mFreeNodes.pop_back();
+        mParents[node] = node;
+        mSizes[node] = 1;
+        mNodeCells[node] = cell;
+    }
+    else
+    {
+        node = (int)mParents.size();
+        mParents.push_back(node);
+        mSizes.push_back(1);
+        mNodeCells.push_back(cell);
+    }
+
+    mNodes[tile] = node;
+    mNumBodies++;
+
+    ForEachNeighbor(cell, [this, node](int neighbor) { Union(node, neighbor); });
+    mCells[cell].push_back(node);
+}
+
+/**
+ * Remove a water tile from a grid location,
+ * splitting its body if necessary
+ * @param tile Tile to remove
+ * @param cell Grid location of the tile
+ */
+void WaterBodies::Erase(Tile *tile, Cell cell)
+{
+    auto found = mNodes.find(tile);
+    if (found == mNodes.end())
+    {
+        return;
+    }
+
+    int node = found->second;
+    mNodes.erase(found);
+
+    auto &nodes = mCells[cell];
+    nodes.erase(std::find(nodes.begin(), nodes.end(), node));
+    if (nodes.empty())
+    {
+        mCells.erase(cell);
+    }
+
+    mFreeNodes.push_back(node);
+    Regroup(cell);
+}
+
+/**
+ * Regroup the body that contained a tile just removed
+ * from a grid location.
+ *
+ * Union-find cannot split a body, so every part of the
+ * old body still reachable from the location is found
+ * and made into a body of its own. Only the members
+ * of the one body are visited.
+ * @param cell Grid location the tile was removed from
+ */
+void WaterBodies::Regroup(Cell cell)
+{
+    // The old body is gone, whatever it splits into
+    mNumBodies--;
+
+    std::vector<int> starts;
+    ForEachNeighbor(cell, [&starts](int neighbor) { starts.push_back(neighbor); });
+
+    // Nodes are marked as visited by making them their own parent
+    // with a size of zero. Nothing else has a size of zero.
+    std::vector<int> pending;
+    for (auto start : starts)
+    {
+        pending.push_back(start);
+        while (!pending.empty())
+        {
+            int node = pending.back();
+            pending.pop_back();
+            mParents[node] = node;
+            mSizes[node] = 0;
+            ForEachNeighbor(mNodeCells[node], [this, &pending](int neighbor) {
+                if (mSizes[neighbor] != 0 || mParents[neighbor] != neighbor)
+                {
+                    mParents[neighbor] = neighbor;
+                    mSizes[neighbor] = 0;
+                    pending.push_back(neighbor);
+                }
+            });
+        }
+    }
+
+    // Rebuild each part from the first node found in it
+    for (auto start : starts)
+    {
+        if (mSizes[start] != 0 || mParents[start] != start)
+        {
+            // Already part of an earlier start's body
+            continue;
+        }
+
+        mSizes[start] = 1;
+        mNumBodies++;
+        pending.push_back(start);
+        while (!pending.empty())
+        {
+            int node = pending.back();
+            pending.pop_back();
+            ForEachNeighbor(mNodeCells[node], [this, start, &pending](int neighbor) {
+                if (neighbor != start && mSizes[neighbor] == 0 && mParents[neighbor] == neighbor)
+                {
+                    mParents[neighbor] = start;
+                    mSizes[start]++;
+                    pending.push_back(neighbor);
+                }
+            });
+        }
+    }
+}
+
+/**
+ * Rebuild the bodies from the water tiles in the city
+ */
+void WaterBodies::Rebuild()
+{
+    CityCleared();
+    for (auto tile : *mCity)
+    {
+        if (tile->GetType() == TileType::Water)
+        {
+            Insert(tile.get(), City::GetGridCell(tile->GetX(), tile->GetY()));
+        }
+    }
+}
+
+/**
+ * Get an identifier for the body of water a tile belongs to.
+ *
+ * Tiles in the same body have the same identifier. Identifiers
+ * may change when the city changes.
+ * @param tile Tile to look up
+ * @return Body identifier or -1 if the tile is not water in the city
+ */
+int WaterBodies::GetBody(Tile *tile) const
+{
+    auto found = mNodes.find(tile);
+    if (found == mNodes.end())
+    {
+        return -1;
+    }
+
+    return Find(found->second);
+}
+
+/**
+ * Get the number of tiles in the body of water a tile belongs to
+ * @param tile Tile to look up
+ * @return Number of tiles or 0 if the tile is not water in the city
+ */
+int WaterBodies::GetBodySize(Tile *tile) const
+{
+    int body = GetBody(tile);
+    return body < 0 ? 0 : mSizes[body];
+}
+
+/**
+ * A tile has been added to the city
+ * @param tile Tile that was added
+ */
+void WaterBodies::TileAdded(std::shared_ptr<Tile> tile)
+{
+    if (tile->GetType() == TileType::Water)
+    {
+        Insert(tile.get(), City::GetGridCell(tile->GetX(), tile->GetY()));
+    }
+}
+
+/**
+ * A tile is being removed from the city
+ * @param tile Tile that is being removed
+ */
+void WaterBodies::TileRemoved(std::shared_ptr<Tile> tile)
+{
+    if (tile->GetType() == TileType::Water)
+    {
+        Erase(tile.get(), City::GetGridCell(tile->GetX(), tile->GetY()));
+    }
+}
+
+/**
+ * A tile has moved, which may connect or split bodies of water
+ * @param tile Tile that moved
+ * @param oldX Previous X location of the tile
+ * @param oldY Previous Y location of the tile
+ */
+void WaterBodies::TileMoved(Tile *tile, int oldX, int oldY)
+{
+    if (tile->GetType() != TileType::Water)
+    {
+        return;
+    }
+
+    Cell oldCell = City::GetGridCell(oldX, oldY);
+    Cell newCell = City::GetGridCell(tile->GetX(), tile->GetY());
+    if (oldCell != newCell)
+    {
+        Erase(tile, oldCell);
+        Insert(tile, newCell);
+    }
+}
+
+/**
+ * The city has been cleared
+ */
+void WaterBodies::CityCleared()
+{
+    mNodes.clear();
+    mCells.clear();
+    mParents.clear();
+    mSizes.clear();
+    mNodeCells.clear();
+    mFreeNodes.clear();
+    mNumBodies = 0;
+}
+
+/**
+ * The city has been loaded
+ */
+void WaterBodies::CityLoaded()
+{
+    Rebuild();
+}
@@ -0,0 +1,96 @@
+/**
+ * @file WaterBodies.h
+ * @author timan
+ *
+ * Connected bodies of water in the city
+ */
+
+#ifndef CITY_CITYLIB_WATERBODIES_H
+#define CITY_CITYLIB_WATERBODIES_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "CityObserver.h"
+#include "GridCell.h"
+
+class City;
+
+/**
+ * Connected bodies of water in the city.
+ *
+ * Water tiles are connected when they are adjacent in the
+ * sense of City::GetAdjacent, or share a grid location. The
+ * bodies are kept in a union-find structure, so finding the
+ * body a tile belongs to and its size takes nearly constant
+ * time. Adding a tile only merges bodies. Removing or moving
+ * a tile away may split its body, so the members of that one
+ * body are regrouped.
+ */
+class WaterBodies : public CityObserver
+{
+private:
+    /// A grid location packed into a single key
+    typedef GridCell::Key Cell;
+
+    int Find(int node) const;
+    void Union(int a, int b);
+    void Insert(Tile *tile, Cell cell);
+    void Erase(Tile *tile, Cell cell);
+    void Regroup(Cell cell);
+    void Rebuild();
+
+    template <typename Function>
+    void ForEachNeighbor(Cell cell, Function function) const;
+
+    /// The city we are tracking
+    City *mCity;
+
+    /// Node for each water tile in the city
+    std::unordered_map<Tile *, int> mNodes;
+
+    /// Nodes of the water tiles at each grid location
+    std::unordered_map<Cell, std::vector<int>> mCells;
+
+    /// Parent of each node. Roots are their own parent.
+    /// Finding a root shortens the paths, hence mutable.
+    mutable std::vector<int> mParents;
+
+    /// Number of tiles in the body, valid for root nodes
+    std::vector<int> mSizes;
+
+    /// Grid location of the tile of each node
+    std::vector<Cell> mNodeCells;
+
+    /// Nodes no longer in use
+    std::vector<int> mFreeNodes;
+
+    /// Number of separate bodies of water
+    int mNumBodies = 0;
+
+public:
+    explicit WaterBodies(City *city);
+
+    /// Copy constructor (disabled)
+    WaterBodies(const WaterBodies &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const WaterBodies &) = delete;
+
+    int GetBody(Tile *tile) const;
+    int GetBodySize(Tile *tile) const;
+
+    /**
+     * Get the number of separate bodies of water
+     * @return Number of bodies
+     */
+    int GetNumBodies() const { return mNumBodies; }
+
+    void TileAdded(std::shared_ptr<Tile> tile) override;
+    void TileRemoved(std::shared_ptr<Tile> tile) override;
+    void TileMoved(Tile *tile, int oldX, int oldY) override;
+    void CityCleared() override;
+    void CityLoaded() override;
+};
+
+#endif //CITY_CITYLIB_WATERBODIES_H
@@ -0,0 +1,288 @@
+/**
+ * @file WaterEdges.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+
+#include <algorithm>
+
+#include "WaterEdges.h"
+#include "City.h"
+#include "TileWater.h"
+
+/// Image the water variants are made from
+const std::wstring WaterImage = L"water.png";
+
+/// Width of the shore along an edge, in the units
+/// of the diamond distance used by Tile::HitTest
+const int ShoreWidth = 16;
+
+/// Color the shore shades toward
+const unsigned char ShoreColor[] = {214, 196, 140};
+
+/**
+ * Constructor
+ * @param city The city we are tracking
+ */
+WaterEdges::WaterEdges(City *city) : mCity(city)
+{
+}
+
+/**
+ * Get the mask of the neighbors of a grid location that are water
+ * @param cell Grid location
+ * @return Mask with a bit set for each neighbor that is water
+ */
+int WaterEdges::GetMask(Cell cell) const
+{
+    // Each neighbor has the bit of its index in GridCell::Neighbors
+    int mask = 0;
+    for (int bit = 0; bit < GridCell::NumNeighbors; bit++)
+    {
+        if (mCells.find(GridCell::Neighbor(cell, bit)) != mCells.end())
+        {
+            mask |= 1 << bit;
+        }
+    }
+
+    return mask;
+}
+
+/**
+ * Give the water tiles at a grid location the sprite for their neighbors
+ * @param cell Grid location
+ */
+void WaterEdges::Refresh(Cell cell)
+{
+    auto found = mCells.find(cell);
+    if (found == mCells.end())
+    {
+        return;
+    }
+
+    int mask = GetMask(cell);
+    for (auto tile : found->second)
+    {
+        tile->SetEdges(mask);
+    }
+}
+
+/**
+ * Refresh the water tiles next to a grid location
+ * @param cell Grid location
+ */
+void WaterEdges::RefreshAround(Cell cell)
+{
+    for (int neighbor = 0; neighbor < GridCell::NumNeighbors; neighbor++)
+    {
+        Refresh(GridCell::Neighbor(cell, neighbor));
+    }
+}
+
+/**
+ * Add a water tile at a grid location
+ * @param tile The tile
+ * @param cell Grid location
+ */
+void WaterEdges::Insert(TileWater *tile, Cell cell)
+{
+    auto &tiles = mCells[cell];
+    tiles.push_back(tile);
+
+    if (tiles.size() == 1)
+    {
+        // The neighbors now have water on this side
+        RefreshAround(cell);
+    }
+
+    tile->SetEdges(GetMask(cell));
+}
+
+/**
+ * Remove a water tile from a grid location
+ * @param tile The tile
+ * @param cell Grid location
+ */
+void WaterEdges::Erase(TileWater *tile, Cell cell)
+{
+    auto found = mCells.find(cell);
+    if (found == mCells.end())
+    {
+        return;
+    }
+
+    auto &tiles = found->second;
+    tiles.erase(std::remove(tiles.begin(), tiles.end(), tile), tiles.end());
+    if (tiles.empty())
+    {
+        mCells.erase(found);
+        RefreshAround(cell);
+    }
+}
+
+/**
+ * Rebuild the masks of all of the water tiles in the city
+ */
+void WaterEdges::Rebuild()
+{
+    mCells.clear();
+    for (auto tile : *mCity)
+    {
+        if (tile->GetType() == TileType::Water)
+        {
+            mCells[City::GetGridCell(tile->GetX(), tile->GetY())].push_back(static_cast<TileWater *>(tile.get()));
+        }
+    }
+
+    for (auto &cell : mCells)
+    {
+        Refresh(cell.first);
+    }
+}
+
+/**
+ * Get the sprite for a mask of water neighbors.
+ * @param mask Mask with a bit set for each neighbor that is water
+ * @return The sprite, not Ok if images are not enabled in the city
+ */
+SpriteAtlas::Sprite WaterEdges::GetSprite(int mask)
+{
+    if (!mCity->AreImagesEnabled())
+    {
+        return SpriteAtlas::Sprite();
+    }
+
+    if (mSpritesDirectory != mCity->GetImagesDirectory())
+    {
+        LoadSprites();
+    }
+
+    return mSprites[mask];
+}
+
+/**
+ * Make the sprite for each mask from the water image.
+ *
+ * Every pixel gets its distance inside each edge of the tile
+ * diamond. Pixels near an edge with no water beyond it are
+ * shaded toward the shore color, more so nearer the edge.
+ */
+void WaterEdges::LoadSprites()
+{
+    mSpritesDirectory = mCity->GetImagesDirectory();
+    wxImage water;
+    if (!mCity->GetAssets().GetImage(WaterImage, water))
+    {
+        water.LoadFile(mSpritesDirectory + L"/" + WaterImage, wxBITMAP_TYPE_ANY);
+    }
+
+    const int wid = water.GetWidth();
+    const int hit = water.GetHeight();
+
+    // The image is drawn with the tile center this far from its corner
+    const int centerX = Tile::OffsetLeft;
+    const int centerY = hit - Tile::OffsetDown;
+
+    for (int mask = 0; mask < NumVariants; mask++)
+    {
+        wxImage image = water.Copy();
+        unsigned char *data = image.GetData();
+        for (int y = 0; y < hit && data != nullptr; y++)
+        {
+            int dy = (y - centerY) * 2;
+            for (int x = 0; x < wid; x++)
+            {
+                int dx = x - centerX;
+
+                // Distance inside each edge, in the order of the mask bits
+                int inside[] = {Tile::OffsetLeft + dx + dy, Tile::OffsetLeft - dx + dy,
+                                Tile::OffsetLeft + dx - dy, Tile::OffsetLeft - dx - dy};
+
+                int shore = ShoreWidth;
+                for (int bit = 0; bit < 4; bit++)
+                {
+                    if ((mask & (1 << bit)) == 0)
+                    {
+                        shore = std::min(shore, std::max(inside[bit], 0));
+                    }
+                }
+
+                if (shore < ShoreWidth)
+                {
+                    int weight = ShoreWidth - shore;
+                    unsigned char *pixel = data + (y * wid + x) * 3;
+                    for (int c = 0; c < 3; c++)
+                    {
+                        pixel[c] = (unsigned char)((pixel[c] * shore + ShoreColor[c] * weight) / ShoreWidth);
+                    }
+                }
+            }
+        }
+
+        auto name = mSpritesDirectory + L"/" + WaterImage + L"#" + std::to_wstring(mask);
+        mSprites[mask] = mCity->GetAtlas().Add(name, image);
+    }
+}
+
+/**
+ * A tile has been added to the city
+ * @param tile Tile that was added
+ */
+void WaterEdges::TileAdded(std::shared_ptr<Tile> tile)
+{
+    if (tile->GetType() == TileType::Water)
+    {
+        Insert(static_cast<TileWater *>(tile.get()), City::GetGridCell(tile->GetX(), tile->GetY()));
+    }
+}
+
+/**
+ * A tile is being removed from the city
+ * @param tile Tile that is being removed
+ */
+void WaterEdges::TileRemoved(std::shared_ptr<Tile> tile)
+{
+    if (tile->GetType() == TileType::Water)
+    {
+        Erase(static_cast<TileWater *>(tile.get()), City::GetGridCell(tile->GetX(), tile->GetY()));
+    }
+}
+
+/**
+ * A tile has moved, which may move it to another grid location
+ * @param tile Tile that moved
+ * @param oldX Previous X location of the tile
+ * @param oldY Previous Y location of the tile
+ */
+void WaterEdges::TileMoved(Tile *tile, int oldX, int oldY)
+{
+    if (tile->GetType() != TileType::Water)
+    {
+        return;
+    }
+
+    Cell from = City::GetGridCell(oldX, oldY);
+    Cell to = City::GetGridCell(tile->GetX(), tile->GetY());
+    if (from != to)
+    {
+        Erase(static_cast<TileWater *>(tile), from);
+        Insert(static_cast<TileWater *>(tile), to);
+    }
+}
+
+/**
+ * The city has been cleared
+ */
+void WaterEdges::CityCleared()
+{
+    mCells.clear();
+}
+
+/**
+ * The city has been loaded
+ */
+void WaterEdges::CityLoaded()
+{
+    Rebuild();
+}
@@ -0,0 +1,84 @@
+/**
+ * @file WaterEdges.h
+ * @author timan
+ *
+ * Shoreline sprites for the water tiles of the city
+ */
+
+#ifndef CITY_CITYLIB_WATEREDGES_H
+#define CITY_CITYLIB_WATEREDGES_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "CityObserver.h"
+#include "GridCell.h"
+#include "SpriteAtlas.h"
+
+class City;
+class TileWater;
+
+/**
+ * Shoreline sprites for the water tiles of the city.
+ *
+ * Each water tile is drawn with one of sixteen variants of the
+ * water image, chosen by a mask with a bit for each of its four
+ * neighbors, in the sense of City::GetAdjacent, that is water.
+ * Edges without water next to them are shaded as shore.
+ *
+ * The variants are made from water.png the first time they are
+ * needed and added to the city sprite atlas, where every water
+ * tile draws them from. The water tiles are kept by grid
+ * location, so when a tile is added, removed or moved only it
+ * and the tiles next to it get a new mask.
+ */
+class WaterEdges : public CityObserver
+{
+public:
+    /// Number of sprite variants, one for each mask
+    static const int NumVariants = 16;
+
+private:
+    /// A grid location packed into a single key
+    typedef GridCell::Key Cell;
+
+    int GetMask(Cell cell) const;
+    void Insert(TileWater *tile, Cell cell);
+    void Erase(TileWater *tile, Cell cell);
+    void Refresh(Cell cell);
+    void RefreshAround(Cell cell);
+    void Rebuild();
+    void LoadSprites();
+
+    /// The city we are tracking
+    City *mCity;
+
+    /// The water tiles at each grid location
+    std::unordered_map<Cell, std::vector<TileWater *>> mCells;
+
+    /// Sprite in the city atlas for each mask
+    SpriteAtlas::Sprite mSprites[NumVariants];
+
+    /// Directory the sprites were made from, empty if not made yet
+    std::wstring mSpritesDirectory;
+
+public:
+    explicit WaterEdges(City *city);
+
+    /// Copy constructor (disabled)
+    WaterEdges(const WaterEdges &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const WaterEdges &) = delete;
+
+    SpriteAtlas::Sprite GetSprite(int mask);
+
+    void TileAdded(std::shared_ptr<Tile> tile) override;
+    void TileRemoved(std::shared_ptr<Tile> tile) override;
+    void TileMoved(Tile *tile, int oldX, int oldY) override;
+    void CityCleared() override;
+    void CityLoaded() override;
+};
+
+#endif //CITY_CITYLIB_WATEREDGES_H
@@ -0,0 +1,149 @@
+/**
+ * @file WorkerPool.cpp
+ * @author timan
+ */
+
+#include "pch.h"
+
+#include <algorithm>
+
+#include "WorkerPool.h"
+
+/// Set on threads that are running part of a loop
+thread_local bool InsideLoop = false;
+
+/**
+ * Constructor
+ * @param numWorkers Number of workers, including the
+ * calling thread. Zero uses one per hardware thread.
+ */
+WorkerPool::WorkerPool(int numWorkers)
+{
+    if (numWorkers <= 0)
+    {
+        numWorkers = std::max((int)std::thread::hardware_concurrency(), 1);
+    }
+
+    for (int worker = 1; worker < numWorkers; worker++)
+    {
+        mThreads.emplace_back(&WorkerPool::WorkerMain, this, worker);
+    }
+}
+
+/**
+ * Destructor. Stops and joins the worker threads.
+ */
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+
+    mWake.notify_all();
+    for (auto &thread : mThreads)
+    {
+        thread.join();
+    }
+}
+
+/**
+ * Get the pool shared by the whole program
+ * @return Shared worker pool
+ */
+WorkerPool &WorkerPool::Get()
+{
+    static WorkerPool pool;
+    return pool;
+}
+
+/**
+ * Run a loop over count items in parallel.
+ *
+ * The items are split into contiguous parts, at most one
+ * per worker, and the call returns when all are done.
+ * @param count Number of items
+ * @param task Function that processes one part
+ */
+void WorkerPool::ParallelFor(int count, const Task &task)
+{
+    int parts = std::min(count, GetNumWorkers());
+    if (parts <= 0)
+    {
+        return;
+    }
+
+    if (parts == 1 || InsideLoop)
+    {
+        task(0, count, 0);
+        return;
+    }
+
+    std::lock_guard<std::mutex> loop(mLoopMutex);
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTask = &task;
+        mCount = count;
+        mParts = parts;
+        mRemaining = parts - 1;
+        mGeneration++;
+    }
+
+    mWake.notify_all();
+
+    // The calling thread does the first part
+    InsideLoop = true;
+    RunPart(0);
+    InsideLoop = false;
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mDone.wait(lock, [this] { return mRemaining == 0; });
+    mTask = nullptr;
+}
+
+/**
+ * Run one part of the current loop
+ * @param part Part to run
+ */
+void WorkerPool::RunPart(int part)
+{
+    int begin = (int)((long long)mCount * part / mParts);
+    int end = (int)((long long)mCount * (part + 1) / mParts);
+    (*mTask)(begin, end, part);
+}
+
+/**
+ * Main function for a worker thread
+ * @param worker Index of this worker
+ */
+void WorkerPool::WorkerMain(int worker)
+{
+    InsideLoop = true;
+
+    int generation = 0;
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true)
+    {
+        mWake.wait(lock, [this, generation] { return mStop || mGeneration != generation; });
+        if (mStop)
+        {
+            return;
+        }
+
+        generation = mGeneration;
+        if (worker >= mParts)
+        {
+            continue;
+        }
+
+        lock.unlock();
+        RunPart(worker);
+        lock.lock();
+
+        if (--mRemaining == 0)
+        {
+            mDone.notify_one();
+        }
+    }
+}
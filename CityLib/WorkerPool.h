@@ -0,0 +1,129 @@
+/**
+ * @file WorkerPool.h
+ * @author timan
+ *
+ * A pool of worker threads for data parallel loops
+ */
+
+#ifndef CITY_CITYLIB_WORKERPOOL_H
+#define CITY_CITYLIB_WORKERPOOL_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * A pool of worker threads for data parallel loops.
+ *
+ * ParallelFor splits a range of items into one contiguous
+ * part per worker and blocks until every part is done. The
+ * calling thread runs the first part itself. A ParallelFor
+ * called from inside a part simply runs on the calling thread.
+ */
+class WorkerPool
+{
+public:
+    /**
+     * A part of a parallel loop, called with the first item in
+     * the part, one past the last item, and the index of the
+     * worker running the part, from 0.
+     *
+     * A Task only refers to the function it is made from, which
+     * must outlive it. ParallelFor blocks until the loop is done,
+     * so a lambda written in the call lives long enough. Unlike
+     * a std::function, making a Task never allocates memory.
+     */
+    class Task
+    {
+    private:
+        /// The function this task calls
+        const void *mFunction;
+
+        /// Calls mFunction with the arguments of the part
+        void (*mCall)(const void *function, int begin, int end, int worker);
+
+    public:
+        /**
+         * Constructor
+         * @param function Function to call for each part
+         */
+        template <typename Function,
+                  typename = std::enable_if_t<!std::is_same<std::decay_t<Function>, Task>::value>>
+        Task(const Function &function) : mFunction(&function)
+        {
+            mCall = [](const void *function, int begin, int end, int worker) {
+                (*static_cast<const Function *>(function))(begin, end, worker);
+            };
+        }
+
+        /**
+         * Run a part of the loop
+         * @param begin First item in the part
+         * @param end One past the last item in the part
+         * @param worker Index of the worker running the part, from 0
+         */
+        void operator()(int begin, int end, int worker) const { mCall(mFunction, begin, end, worker); }
+    };
+
+private:
+    void WorkerMain(int worker);
+    void RunPart(int part);
+
+    /// The worker threads. Worker 0 is the calling thread.
+    std::vector<std::thread> mThreads;
+
+    /// Only one loop runs on the pool at a time
+    std::mutex mLoopMutex;
+
+    /// Protects the state of the current loop
+    std::mutex mMutex;
+
+    /// Signalled when a new loop starts or the pool stops
+    std::condition_variable mWake;
+
+    /// Signalled when the last worker finishes its part
+    std::condition_variable mDone;
+
+    /// The task for the current loop
+    const Task *mTask = nullptr;
+
+    /// Number of items in the current loop
+    int mCount = 0;
+
+    /// Number of parts the current loop is split into
+    int mParts = 0;
+
+    /// Number of parts still running on worker threads
+    int mRemaining = 0;
+
+    /// Incremented for each new loop
+    int mGeneration = 0;
+
+    /// Set when the pool is being destroyed
+    bool mStop = false;
+
+public:
+    explicit WorkerPool(int numWorkers = 0);
+
+    /// Copy constructor (disabled)
+    WorkerPool(const WorkerPool &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const WorkerPool &) = delete;
+
+    virtual ~WorkerPool();
+
+    /**
+     * Get the number of workers, including the calling thread
+     * @return Number of workers
+     */
+    int GetNumWorkers() const { return (int)mThreads.size() + 1; }
+
+    void ParallelFor(int count, const Task &task);
+
+    static WorkerPool &Get();
+};
+
+#endif //CITY_CITYLIB_WORKERPOOL_H
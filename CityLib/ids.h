@@ -69,7 +69,97 @@ enum IDs {
     IDM_BUSINESSES_STARSHIPPAD,
 
 	/// Buildings>Count menu option
-	IDM_BUILDINGS_COUNT
+	IDM_BUILDINGS_COUNT,
+
+    /// View>Report Order>As Added menu option
+    IDM_VIEW_REPORT_ORDER_ADDED,
+
+    /// View>Report Order>Position menu option
+    IDM_VIEW_REPORT_ORDER_POSITION,
+
+    /// View>Report Order>Type menu option
+    IDM_VIEW_REPORT_ORDER_TYPE,
+
+    /// View>Report Filter>All menu option
+    IDM_VIEW_REPORT_FILTER_ALL,
+
+    /// View>Report Filter>Landscape menu option.
+    /// The filter options are in TileType order.
+    IDM_VIEW_REPORT_FILTER_LANDSCAPE,
+
+    /// View>Report Filter>Buildings menu option
+    IDM_VIEW_REPORT_FILTER_BUILDING,
+
+    /// View>Report Filter>Gardens menu option
+    IDM_VIEW_REPORT_FILTER_GARDEN,
+
+    /// View>Report Filter>Water menu option
+    IDM_VIEW_REPORT_FILTER_WATER,
+
+    /// View>Report Filter>Starship Pads menu option
+    IDM_VIEW_REPORT_FILTER_STARSHIPPAD,
+
+    /// View>Report Grouping>Tiles menu option
+    IDM_VIEW_REPORT_GROUP_TILES,
+
+    /// View>Report Grouping>By Type menu option
+    IDM_VIEW_REPORT_GROUP_TYPE,
+
+    /// View>Report Grouping>By Building menu option
+    IDM_VIEW_REPORT_GROUP_BUILDING,
+
+    /// View>Report Grouping>By Region menu option
+    IDM_VIEW_REPORT_GROUP_REGION,
+
+    /// View>Report Grouping>Service Coverage menu option
+    IDM_VIEW_REPORT_GROUP_COVERAGE,
+
+    /// View>Report Grouping>Land Value menu option
+    IDM_VIEW_REPORT_GROUP_LANDVALUE,
+
+    /// View>Report Grouping>Economy menu option
+    IDM_VIEW_REPORT_GROUP_ECONOMY,
+
+    /// File>Export Report menu option
+    IDM_FILE_EXPORTREPORT,
+
+    /// View>Coverage>None menu option
+    IDM_VIEW_COVERAGE_NONE,
+
+    /// View>Coverage>Fire Stations menu option.
+    /// The coverage options are in ServiceCoverage::Service order.
+    IDM_VIEW_COVERAGE_FIRESTATION,
+
+    /// View>Coverage>Hospitals menu option
+    IDM_VIEW_COVERAGE_HOSPITAL,
+
+    /// View>Land Value menu option
+    IDM_VIEW_LANDVALUE,
+
+    /// View>Traffic menu option
+    IDM_VIEW_TRAFFIC,
+
+    /// View>Zoom In menu option
+    IDM_VIEW_ZOOMIN,
+
+    /// View>Zoom Out menu option
+    IDM_VIEW_ZOOMOUT,
+
+    /// View>Renderer>wxDC menu option
+    IDM_VIEW_RENDERER_DC,
+
+    /// View>Renderer>Software Scalar menu option.
+    /// The software options are in BlendKernels::Kernel order.
+    IDM_VIEW_RENDERER_SCALAR,
+
+    /// View>Renderer>Software SSE2 menu option
+    IDM_VIEW_RENDERER_SSE2,
+
+    /// View>Renderer>Software AVX2 menu option
+    IDM_VIEW_RENDERER_AVX2,
+
+    /// View>Hide Covered Sprites menu option
+    IDM_VIEW_CULLING
 };
 
 #endif //CITY_IDS_H
@@ -0,0 +1,70 @@
+/**
+ * @file CityPack.cpp
+ * @author timan
+ *
+ * Command line tool that decodes the images used by the
+ * city into an asset pack, so they need not be decoded
+ * when the program starts.
+ *
+ * Usage: CityPack images-directory [output.pack]
+ */
+
+#include "pch.h"
+
+#include <algorithm>
+#include <iostream>
+#include <wx/dir.h>
+
+#include "AssetPack.h"
+
+/**
+ * Main entry point for the pack tool
+ * @param argc Number of command line arguments
+ * @param argv Command line arguments
+ * @return 0 if successful
+ */
+int main(int argc, char *argv[])
+{
+    wxInitializer initializer;
+    if (!initializer.IsOk())
+    {
+        std::cerr << "Unable to initialize wxWidgets" << std::endl;
+        return 1;
+    }
+
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "Usage: CityPack images-directory [output.pack]" << std::endl;
+        return 1;
+    }
+
+    wxInitAllImageHandlers();
+
+    std::wstring directory = wxString(argv[1]).ToStdWstring();
+    std::wstring output = argc > 2 ? wxString(argv[2]).ToStdWstring() : directory + L"/" + AssetPack::PackFile;
+
+    // Every PNG file in the directory is packed
+    std::vector<std::wstring> files;
+    wxDir dir(directory);
+    wxString file;
+    for (bool found = dir.IsOpened() && dir.GetFirst(&file, L"*.png", wxDIR_FILES); found; found = dir.GetNext(&file))
+    {
+        files.push_back(file.ToStdWstring());
+    }
+
+    std::sort(files.begin(), files.end());
+    if (files.empty())
+    {
+        std::cerr << "No images found in " << argv[1] << std::endl;
+        return 1;
+    }
+
+    if (!AssetPack::Build(directory, files, output))
+    {
+        std::cerr << "Unable to build " << wxString(output).ToStdString() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Packed " << files.size() << " images into " << wxString(output).ToStdString() << std::endl;
+    return 0;
+}